@@ -0,0 +1,91 @@
+#ifndef SRC_ASYNC_IO_H_
+#define SRC_ASYNC_IO_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+namespace hhullen {
+
+/**
+ * @brief Statistics of one finished file operation
+ *
+ */
+struct IoStats {
+  size_t bytes = 0;
+  double seconds = 0;
+
+  double bandwidth() const {
+    return seconds > 0 ? static_cast<double>(bytes) / seconds : 0;
+  }
+};
+
+using IoCallback = std::function<void(const IoStats&)>;
+
+/**
+ * @brief Background thread executing file jobs in submission order. At most
+ * "capacity" jobs are waiting besides the running one (double buffering with
+ * default capacity 1), Submit blocks until there is a free slot
+ *
+ */
+class IoWorker {
+ public:
+  explicit IoWorker(size_t capacity = 1)
+      : capacity_(capacity), thread_([this] { Run(); }) {}
+  IoWorker(const IoWorker&) = delete;
+  IoWorker& operator=(const IoWorker&) = delete;
+
+  ~IoWorker() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    has_job_.notify_all();
+    thread_.join();
+  }
+
+  void Submit(std::function<void()> job) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    has_slot_.wait(lock, [this] { return jobs_.size() < capacity_; });
+    jobs_.push_back(std::move(job));
+    has_job_.notify_one();
+  }
+
+  static IoWorker& Shared() {
+    static IoWorker worker;
+    return worker;
+  }
+
+ private:
+  size_t capacity_;
+  bool stopped_ = false;
+  std::deque<std::function<void()>> jobs_;
+  std::mutex mutex_;
+  std::condition_variable has_job_;
+  std::condition_variable has_slot_;
+  std::thread thread_;
+
+  void Run() {
+    while (true) {
+      std::function<void()> job;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        has_job_.wait(lock, [this] { return stopped_ || !jobs_.empty(); });
+        if (jobs_.empty()) {
+          return;
+        }
+        job = std::move(jobs_.front());
+        jobs_.pop_front();
+      }
+      has_slot_.notify_one();
+      job();
+    }
+  }
+};
+
+}  // namespace hhullen
+
+#endif  // SRC_ASYNC_IO_H_
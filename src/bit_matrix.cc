@@ -0,0 +1,296 @@
+#include "bit_matrix.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+
+#include "parallel.h"
+
+namespace hhullen {
+
+/**
+ * @brief Construct a new empty BitMatrix object
+ *
+ */
+BitMatrix::BitMatrix() {}
+
+/**
+ * @brief Construct a new BitMatrix object filled with false
+ *
+ * @param rows int type
+ * @param cols int type
+ */
+BitMatrix::BitMatrix(int rows, int cols)
+    : rows_(rows),
+      cols_(cols),
+      words_per_row_((static_cast<size_t>(std::max(cols, 0)) + kWordBits - 1) /
+                     kWordBits) {
+  if (rows < 1 || cols < 1) {
+    throw std::invalid_argument("Creation matrix with less than 1x1 size");
+  }
+  words_.resize(static_cast<size_t>(rows) * words_per_row_);
+}
+
+int BitMatrix::rows() const {
+  return rows_;
+}
+
+int BitMatrix::cols() const {
+  return cols_;
+}
+
+size_t BitMatrix::words_per_row() const {
+  return words_per_row_;
+}
+
+/**
+ * @brief Returns element, index is checked
+ *
+ * @param i int type row index
+ * @param j int type column index
+ * @return bool
+ */
+bool BitMatrix::get(int i, int j) const {
+  CheckIndex(i, j);
+  const size_t col = static_cast<size_t>(j);
+  return (row(i)[col / kWordBits] >> (col % kWordBits)) & 1;
+}
+
+/**
+ * @brief Sets element, index is checked
+ *
+ * @param i int type row index
+ * @param j int type column index
+ * @param value bool type
+ */
+void BitMatrix::set(int i, int j, bool value) {
+  CheckIndex(i, j);
+  const size_t col = static_cast<size_t>(j);
+  const Word bit = Word(1) << (col % kWordBits);
+  Word& word = row(i)[col / kWordBits];
+  word = value ? word | bit : word & ~bit;
+}
+
+/**
+ * @brief Returns words of row "i", element "j" is bit "j % 64" of word
+ * "j / 64". Unused bits of the last word must stay zero
+ *
+ * @param i int type row index
+ * @return std::span<Word>
+ */
+std::span<BitMatrix::Word> BitMatrix::row(int i) {
+  return {words_.data() + static_cast<size_t>(i) * words_per_row_,
+          words_per_row_};
+}
+
+std::span<const BitMatrix::Word> BitMatrix::row(int i) const {
+  return {words_.data() + static_cast<size_t>(i) * words_per_row_,
+          words_per_row_};
+}
+
+/**
+ * @brief Returns amount of true elements
+ *
+ * @return size_t
+ */
+size_t BitMatrix::Count() const {
+  size_t returnable = 0;
+  for (Word word : words_) {
+    returnable += static_cast<size_t>(std::popcount(word));
+  }
+
+  return returnable;
+}
+
+/**
+ * @brief Returns amount of true elements of every row
+ *
+ * @return std::vector<int> of rows size
+ */
+std::vector<int> BitMatrix::RowCounts() const {
+  std::vector<int> returnable(static_cast<size_t>(rows_));
+  for (int i = 0; i < rows_; ++i) {
+    for (Word word : row(i)) {
+      returnable[static_cast<size_t>(i)] += std::popcount(word);
+    }
+  }
+
+  return returnable;
+}
+
+/**
+ * @brief Returns amount of true elements of every column. Rows are taken by
+ * blocks of kWordBits: each word column of a block is transposed, so a
+ * column becomes one word counted by popcount
+ *
+ * @return std::vector<int> of cols size
+ */
+std::vector<int> BitMatrix::ColCounts() const {
+  std::vector<int> returnable(words_per_row_ * kWordBits);
+  std::array<Word, kWordBits> block;
+  for (int first = 0; first < rows_; first += kWordBits) {
+    const int last = std::min(rows_, first + kWordBits);
+    for (size_t w = 0; w < words_per_row_; ++w) {
+      block.fill(0);
+      for (int i = first; i < last; ++i) {
+        block[static_cast<size_t>(i - first)] = row(i)[w];
+      }
+      TransposeBlock(block.data());
+      for (size_t j = 0; j < block.size(); ++j) {
+        returnable[w * kWordBits + j] += std::popcount(block[j]);
+      }
+    }
+  }
+  returnable.resize(static_cast<size_t>(cols_));
+
+  return returnable;
+}
+
+bool BitMatrix::operator==(const BitMatrix& other) const {
+  return rows_ == other.rows_ && cols_ == other.cols_ &&
+         words_ == other.words_;
+}
+
+bool BitMatrix::operator!=(const BitMatrix& other) const {
+  return !(*this == other);
+}
+
+BitMatrix& BitMatrix::operator&=(const BitMatrix& other) {
+  CheckSize(other);
+  std::transform(words_.begin(), words_.end(), other.words_.begin(),
+                 words_.begin(), [](Word left, Word right) {
+                   return left & right;
+                 });
+  return *this;
+}
+
+BitMatrix& BitMatrix::operator|=(const BitMatrix& other) {
+  CheckSize(other);
+  std::transform(words_.begin(), words_.end(), other.words_.begin(),
+                 words_.begin(), [](Word left, Word right) {
+                   return left | right;
+                 });
+  return *this;
+}
+
+BitMatrix& BitMatrix::operator^=(const BitMatrix& other) {
+  CheckSize(other);
+  std::transform(words_.begin(), words_.end(), other.words_.begin(),
+                 words_.begin(), [](Word left, Word right) {
+                   return left ^ right;
+                 });
+  return *this;
+}
+
+BitMatrix BitMatrix::operator&(const BitMatrix& other) const {
+  BitMatrix returnable(*this);
+  return returnable &= other;
+}
+
+BitMatrix BitMatrix::operator|(const BitMatrix& other) const {
+  BitMatrix returnable(*this);
+  return returnable |= other;
+}
+
+BitMatrix BitMatrix::operator^(const BitMatrix& other) const {
+  BitMatrix returnable(*this);
+  return returnable ^= other;
+}
+
+/**
+ * @brief Elementwise negation, unused bits are kept zero
+ *
+ * @return BitMatrix
+ */
+BitMatrix BitMatrix::operator~() const {
+  BitMatrix returnable(*this);
+  const Word tail = TailMask();
+  for (int i = 0; i < rows_; ++i) {
+    std::span<Word> words = returnable.row(i);
+    for (Word& word : words) {
+      word = ~word;
+    }
+    words.back() &= tail;
+  }
+
+  return returnable;
+}
+
+/**
+ * @brief Boolean product: element (i, j) is true if row "i" of this and
+ * column "j" of "other" have common true element. Row "k" of "other" is
+ * ORed word by word into result row for every true element (i, k), rows of
+ * result are split between threads for large matrices
+ *
+ * @param other const BitMatrix& type
+ * @return BitMatrix of rows * other.cols size
+ */
+BitMatrix BitMatrix::operator*(const BitMatrix& other) const {
+  if (cols_ != other.rows_) {
+    throw std::invalid_argument(
+        "Multiplication matrix with different cols and rows");
+  }
+  BitMatrix returnable(rows_, other.cols_);
+  const size_t width = other.words_per_row_;
+
+  auto multiply_rows = [&](int first, int last) {
+    for (int i = first; i < last; ++i) {
+      Word* target = returnable.row(i).data();
+      std::span<const Word> words = row(i);
+      for (size_t w = 0; w < words.size(); ++w) {
+        for (Word word = words[w]; word != 0; word &= word - 1) {
+          const size_t k =
+              w * kWordBits + static_cast<size_t>(std::countr_zero(word));
+          const Word* source = other.words_.data() + k * width;
+          for (size_t j = 0; j < width; ++j) {
+            target[j] |= source[j];
+          }
+        }
+      }
+    }
+  };
+  if (static_cast<size_t>(rows_) * words_per_row_ * width >= kParallelWords) {
+    ParallelFor(0, rows_, 0, multiply_rows);
+  } else {
+    multiply_rows(0, rows_);
+  }
+
+  return returnable;
+}
+
+BitMatrix::Word BitMatrix::TailMask() const {
+  const size_t used = static_cast<size_t>(cols_) % kWordBits;
+  return used == 0 ? ~Word(0) : (Word(1) << used) - 1;
+}
+
+/**
+ * @brief Transposes kWordBits x kWordBits block of bits in place by swapping
+ * off-diagonal quadrants of halving size, bit j of word i is element (i, j)
+ *
+ * @param block Word* type kWordBits words
+ */
+void BitMatrix::TransposeBlock(Word* block) {
+  Word mask = 0x00000000FFFFFFFFull;
+  for (size_t half = kWordBits / 2; half != 0;
+       half >>= 1, mask ^= mask << half) {
+    for (size_t k = 0; k < kWordBits; k = ((k | half) + 1) & ~half) {
+      const Word swapped = ((block[k] >> half) ^ block[k | half]) & mask;
+      block[k] ^= swapped << half;
+      block[k | half] ^= swapped;
+    }
+  }
+}
+
+void BitMatrix::CheckIndex(int i, int j) const {
+  if (i < 0 || j < 0 || i >= rows_ || j >= cols_) {
+    throw std::out_of_range("Index that is out of matrix range");
+  }
+}
+
+void BitMatrix::CheckSize(const BitMatrix& other) const {
+  if (rows_ != other.rows_ || cols_ != other.cols_) {
+    throw std::invalid_argument("Operation on matrices of different size");
+  }
+}
+
+}  // namespace hhullen
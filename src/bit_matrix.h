@@ -0,0 +1,110 @@
+#ifndef SRC_BIT_MATRIX_H_
+#define SRC_BIT_MATRIX_H_
+
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "matrix.h"
+
+namespace hhullen {
+
+/**
+ * @brief Boolean matrix packed 64 elements per word. Every row starts at a
+ * word boundary, unused bits of the last word of a row are always zero, so
+ * logical operations and counts work on whole words
+ *
+ */
+class BitMatrix {
+ public:
+  using Word = uint64_t;
+  static constexpr int kWordBits = 64;
+
+  BitMatrix();
+  BitMatrix(int rows, int cols);
+
+  template <arithmetic Type>
+  static BitMatrix FromMatrix(const Matrix<Type>& other);
+  template <arithmetic Type>
+  Matrix<Type> ToMatrix() const;
+
+  int rows() const;
+  int cols() const;
+  size_t words_per_row() const;
+  bool get(int i, int j) const;
+  void set(int i, int j, bool value);
+  std::span<Word> row(int i);
+  std::span<const Word> row(int i) const;
+
+  size_t Count() const;
+  std::vector<int> RowCounts() const;
+  std::vector<int> ColCounts() const;
+
+  bool operator==(const BitMatrix& other) const;
+  bool operator!=(const BitMatrix& other) const;
+  BitMatrix& operator&=(const BitMatrix& other);
+  BitMatrix& operator|=(const BitMatrix& other);
+  BitMatrix& operator^=(const BitMatrix& other);
+  BitMatrix operator&(const BitMatrix& other) const;
+  BitMatrix operator|(const BitMatrix& other) const;
+  BitMatrix operator^(const BitMatrix& other) const;
+  BitMatrix operator~() const;
+  BitMatrix operator*(const BitMatrix& other) const;
+
+ private:
+  int rows_ = 0, cols_ = 0;
+  size_t words_per_row_ = 0;
+  std::vector<Word> words_;
+
+  static constexpr size_t kParallelWords = 1 << 12;
+
+  Word TailMask() const;
+  static void TransposeBlock(Word* block);
+  void CheckIndex(int i, int j) const;
+  void CheckSize(const BitMatrix& other) const;
+};
+
+/**
+ * @brief Packs matrix, nonzero elements become true
+ *
+ * @param other const Matrix& type
+ * @return BitMatrix of "other" size
+ */
+template <arithmetic Type>
+BitMatrix BitMatrix::FromMatrix(const Matrix<Type>& other) {
+  BitMatrix returnable(other.rows(), other.cols());
+  for (int i = 0; i < other.rows(); ++i) {
+    std::span<const Type> source = other.row(i);
+    std::span<Word> target = returnable.row(i);
+    for (size_t j = 0; j < source.size(); ++j) {
+      target[j / kWordBits] |= Word(source[j] != Type(0)) << (j % kWordBits);
+    }
+  }
+
+  return returnable;
+}
+
+/**
+ * @brief Unpacks matrix to ones and zeros of "Type"
+ *
+ * @return Matrix of the same size
+ */
+template <arithmetic Type>
+Matrix<Type> BitMatrix::ToMatrix() const {
+  Matrix<Type> returnable(rows_, cols_);
+  for (int i = 0; i < rows_; ++i) {
+    std::span<const Word> source = row(i);
+    std::span<Type> target = returnable.row(i);
+    for (size_t j = 0; j < target.size(); ++j) {
+      target[j] = static_cast<Type>((source[j / kWordBits] >> (j % kWordBits)) &
+                                    1);
+    }
+  }
+
+  return returnable;
+}
+
+}  // namespace hhullen
+
+#endif  // SRC_BIT_MATRIX_H_
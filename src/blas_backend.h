@@ -0,0 +1,226 @@
+#ifndef SRC_BLAS_BACKEND_H_
+#define SRC_BLAS_BACKEND_H_
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#ifdef MATRIX_WITH_CBLAS
+#include <cblas.h>
+
+extern "C" {
+void sgetrf_(const int* m, const int* n, float* a, const int* lda, int* ipiv,
+             int* info);
+void dgetrf_(const int* m, const int* n, double* a, const int* lda, int* ipiv,
+             int* info);
+}
+#endif
+
+namespace hhullen {
+
+/**
+ * @brief Returns flag of dispatching to system CBLAS/LAPACK. Enabled by
+ * default when built with MATRIX_WITH_CBLAS
+ *
+ * @return std::atomic<bool>&
+ */
+inline std::atomic<bool>& BlasBackendFlag() {
+#ifdef MATRIX_WITH_CBLAS
+  static std::atomic<bool> is_enabled(true);
+#else
+  static std::atomic<bool> is_enabled(false);
+#endif
+  return is_enabled;
+}
+
+/**
+ * @brief Enables or disables system CBLAS/LAPACK backend. Has no effect when
+ * built without MATRIX_WITH_CBLAS
+ *
+ * @param is_enabled bool type
+ */
+inline void SetBlasBackend([[maybe_unused]] bool is_enabled) {
+#ifdef MATRIX_WITH_CBLAS
+  BlasBackendFlag() = is_enabled;
+#endif
+}
+
+/**
+ * @brief Checks whether operations on "Type" are dispatched to system
+ * CBLAS/LAPACK. Backend supports only float and double, other types always
+ * use native kernels
+ *
+ * @return bool
+ */
+template <class Type>
+bool IsBlasBackendActive() {
+  return (std::is_same_v<Type, float> || std::is_same_v<Type, double>) &&
+         BlasBackendFlag();
+}
+
+#ifdef MATRIX_WITH_CBLAS
+namespace cblas {
+
+inline CBLAS_TRANSPOSE Trans(bool is_transposed) {
+  return is_transposed ? CblasTrans : CblasNoTrans;
+}
+
+inline void Gemm(bool trans_a, bool trans_b, int m, int n, int k, float alpha,
+                 const float* a, int lda, const float* b, int ldb, float beta,
+                 float* c) {
+  cblas_sgemm(CblasRowMajor, Trans(trans_a), Trans(trans_b), m, n, k, alpha,
+              a, lda, b, ldb, beta, c, n);
+}
+
+inline void Gemm(bool trans_a, bool trans_b, int m, int n, int k,
+                 double alpha, const double* a, int lda, const double* b,
+                 int ldb, double beta, double* c) {
+  cblas_dgemm(CblasRowMajor, Trans(trans_a), Trans(trans_b), m, n, k, alpha,
+              a, lda, b, ldb, beta, c, n);
+}
+
+inline void Gemv(bool trans_a, int m, int n, float alpha, const float* a,
+                 const float* x, float beta, float* y) {
+  cblas_sgemv(CblasRowMajor, Trans(trans_a), m, n, alpha, a, n, x, 1, beta, y,
+              1);
+}
+
+inline void Gemv(bool trans_a, int m, int n, double alpha, const double* a,
+                 const double* x, double beta, double* y) {
+  cblas_dgemv(CblasRowMajor, Trans(trans_a), m, n, alpha, a, n, x, 1, beta, y,
+              1);
+}
+
+inline void Trsm(bool is_lower, int n, int nrhs, const float* a, float* b) {
+  cblas_strsm(CblasRowMajor, CblasLeft, is_lower ? CblasLower : CblasUpper,
+              CblasNoTrans, is_lower ? CblasUnit : CblasNonUnit, n, nrhs, 1,
+              a, n, b, nrhs);
+}
+
+inline void Trsm(bool is_lower, int n, int nrhs, const double* a, double* b) {
+  cblas_dtrsm(CblasRowMajor, CblasLeft, is_lower ? CblasLower : CblasUpper,
+              CblasNoTrans, is_lower ? CblasUnit : CblasNonUnit, n, nrhs, 1,
+              a, n, b, nrhs);
+}
+
+inline void Getrf(int n, float* a, int* pivots, int* info) {
+  sgetrf_(&n, &n, a, &n, pivots, info);
+}
+
+inline void Getrf(int n, double* a, int* pivots, int* info) {
+  dgetrf_(&n, &n, a, &n, pivots, info);
+}
+
+}  // namespace cblas
+#endif
+
+/**
+ * @brief Row-major c = alpha * op(a) * op(b) + beta * c through CBLAS, "a" is
+ * m*k (k*m if transposed), "b" is k*n (n*k if transposed)
+ *
+ * @return true if operation was done by backend
+ */
+template <class Type>
+bool BlasGemm([[maybe_unused]] Type alpha, [[maybe_unused]] const Type* a,
+              [[maybe_unused]] bool trans_a, [[maybe_unused]] const Type* b,
+              [[maybe_unused]] bool trans_b, [[maybe_unused]] Type beta,
+              [[maybe_unused]] Type* c, [[maybe_unused]] size_t m,
+              [[maybe_unused]] size_t n, [[maybe_unused]] size_t k) {
+#ifdef MATRIX_WITH_CBLAS
+  if constexpr (std::is_same_v<Type, float> || std::is_same_v<Type, double>) {
+    if (IsBlasBackendActive<Type>()) {
+      cblas::Gemm(trans_a, trans_b, static_cast<int>(m), static_cast<int>(n),
+                  static_cast<int>(k), alpha, a,
+                  static_cast<int>(trans_a ? m : k), b,
+                  static_cast<int>(trans_b ? k : n), beta, c);
+      return true;
+    }
+  }
+#endif
+  return false;
+}
+
+/**
+ * @brief Row-major y = alpha * op(a) * x + beta * y through CBLAS, "a" is m*n
+ *
+ * @return true if operation was done by backend
+ */
+template <class Type>
+bool BlasGemv([[maybe_unused]] Type alpha, [[maybe_unused]] const Type* a,
+              [[maybe_unused]] bool trans_a, [[maybe_unused]] const Type* x,
+              [[maybe_unused]] Type beta, [[maybe_unused]] Type* y,
+              [[maybe_unused]] size_t m, [[maybe_unused]] size_t n) {
+#ifdef MATRIX_WITH_CBLAS
+  if constexpr (std::is_same_v<Type, float> || std::is_same_v<Type, double>) {
+    if (IsBlasBackendActive<Type>()) {
+      cblas::Gemv(trans_a, static_cast<int>(m), static_cast<int>(n), alpha, a,
+                  x, beta, y);
+      return true;
+    }
+  }
+#endif
+  return false;
+}
+
+/**
+ * @brief LU factorization with partial pivoting of row-major n*n "a" in place
+ * through LAPACK. Result has the same layout as the native one: unit lower
+ * and upper triangles in "a", "pivots[i]" is 0-based row swapped with i
+ *
+ * @param info int* type set to nonzero for singular matrix
+ * @return true if operation was done by backend
+ */
+template <class Type>
+bool LapackLuFactor([[maybe_unused]] Type* a, [[maybe_unused]] size_t n,
+                    [[maybe_unused]] int* pivots,
+                    [[maybe_unused]] int* info) {
+#ifdef MATRIX_WITH_CBLAS
+  if constexpr (std::is_same_v<Type, float> || std::is_same_v<Type, double>) {
+    if (IsBlasBackendActive<Type>()) {
+      std::vector<Type> column_major(n * n);
+      for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+          column_major[j * n + i] = a[i * n + j];
+        }
+      }
+      cblas::Getrf(static_cast<int>(n), column_major.data(), pivots, info);
+      for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < n; ++j) {
+          a[i * n + j] = column_major[j * n + i];
+        }
+        pivots[i] -= 1;
+      }
+      return true;
+    }
+  }
+#endif
+  return false;
+}
+
+/**
+ * @brief Solves row-major triangular system a * x = b in place of n*nrhs "b"
+ * through CBLAS. Lower triangle of "a" is unit, upper is not
+ *
+ * @return true if operation was done by backend
+ */
+template <class Type>
+bool BlasTriangularSolve([[maybe_unused]] bool is_lower,
+                         [[maybe_unused]] const Type* a,
+                         [[maybe_unused]] Type* b, [[maybe_unused]] size_t n,
+                         [[maybe_unused]] size_t nrhs) {
+#ifdef MATRIX_WITH_CBLAS
+  if constexpr (std::is_same_v<Type, float> || std::is_same_v<Type, double>) {
+    if (IsBlasBackendActive<Type>()) {
+      cblas::Trsm(is_lower, static_cast<int>(n), static_cast<int>(nrhs), a,
+                  b);
+      return true;
+    }
+  }
+#endif
+  return false;
+}
+
+}  // namespace hhullen
+
+#endif  // SRC_BLAS_BACKEND_H_
@@ -0,0 +1,399 @@
+#include "chunked_storage.h"
+
+namespace hhullen {
+
+namespace chunked {
+
+constexpr char kMagic[4] = {'M', 'T', 'X', 'C'};
+constexpr uint32_t kVersion = 1;
+constexpr uint8_t kShuffleFlag = 1, kCompressFlag = 2;
+constexpr size_t kHeaderBytes = 36;
+
+template <class Value>
+void Put(std::string* out, Value value) {
+  out->append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <class Value>
+Value Get(const char* in) {
+  Value value;
+  memcpy(&value, in, sizeof(value));
+  return value;
+}
+
+/**
+ * @brief Header layout: magic, version, kind, element size, flags,
+ * reserved byte, rows, cols, chunk rows, chunk cols and index offset, all
+ * in byte order of the host
+ *
+ */
+inline std::string EncodeHeader(const ChunkedHeader& header) {
+  std::string returnable(kMagic, sizeof(kMagic));
+  Put(&returnable, kVersion);
+  Put(&returnable, static_cast<uint8_t>(header.kind));
+  Put(&returnable, static_cast<uint8_t>(header.element_size));
+  Put(&returnable, static_cast<uint8_t>((header.shuffle ? kShuffleFlag : 0) |
+                                        (header.compress ? kCompressFlag : 0)));
+  Put(&returnable, uint8_t{0});
+  for (int value : {header.rows, header.cols, header.chunk_rows,
+                    header.chunk_cols}) {
+    Put(&returnable, static_cast<uint32_t>(value));
+  }
+  Put(&returnable, header.index_offset);
+
+  return returnable;
+}
+
+template <class Type>
+char Kind() {
+  return std::is_floating_point_v<Type> ? 'f'
+         : std::is_signed_v<Type>       ? 'i'
+                                        : 'u';
+}
+
+/**
+ * @brief Returns chunk position and size, chunks are numbered row by row
+ *
+ */
+inline void ChunkBounds(const ChunkedHeader& header, int chunk, int* row,
+                        int* col, int* rows, int* cols) {
+  *row = chunk / header.grid_cols() * header.chunk_rows;
+  *col = chunk % header.grid_cols() * header.chunk_cols;
+  *rows = std::min(header.chunk_rows, header.rows - *row);
+  *cols = std::min(header.chunk_cols, header.cols - *col);
+}
+
+/**
+ * @brief Stores byte "b" of all elements together, so similar exponent and
+ * high mantissa bytes form long runs for the compressor
+ *
+ */
+inline void Shuffle(const char* source, char* target, size_t count,
+                    size_t size) {
+  for (size_t b = 0; b < size; ++b) {
+    for (size_t i = 0; i < count; ++i) {
+      target[b * count + i] = source[i * size + b];
+    }
+  }
+}
+
+inline void Unshuffle(const char* source, char* target, size_t count,
+                      size_t size) {
+  for (size_t b = 0; b < size; ++b) {
+    for (size_t i = 0; i < count; ++i) {
+      target[i * size + b] = source[b * count + i];
+    }
+  }
+}
+
+/**
+ * @brief Reads index of chunks and checks that every chunk lies between
+ * header and index
+ *
+ */
+inline std::vector<IndexEntry> ReadIndex(const std::string& path,
+                                         const ChunkedHeader& header) {
+  const size_t count = static_cast<size_t>(header.grid_rows()) *
+                       static_cast<size_t>(header.grid_cols());
+  std::ifstream file(path, std::ios::binary);
+  std::string raw(count * 2 * sizeof(uint64_t), '\0');
+  file.seekg(static_cast<std::streamoff>(header.index_offset));
+  if (!file.read(raw.data(), static_cast<std::streamsize>(raw.size()))) {
+    throw invalid_argument("Chunked file is corrupted");
+  }
+  std::vector<IndexEntry> returnable(count);
+  for (size_t i = 0; i < count; ++i) {
+    returnable[i].offset = Get<uint64_t>(raw.data() + 16 * i);
+    returnable[i].size = Get<uint64_t>(raw.data() + 16 * i + 8);
+    if (returnable[i].offset < kHeaderBytes ||
+        returnable[i].offset > header.index_offset ||
+        returnable[i].size > header.index_offset - returnable[i].offset) {
+      throw invalid_argument("Chunked file is corrupted");
+    }
+  }
+
+  return returnable;
+}
+
+/**
+ * @brief Copies chunk of matrix row by row, shuffles and compresses it
+ *
+ */
+template <class Type>
+std::string EncodeChunk(const Matrix<Type>& matrix,
+                        const ChunkedHeader& header, int chunk, int level) {
+  int row = 0, col = 0, rows = 0, cols = 0;
+  ChunkBounds(header, chunk, &row, &col, &rows, &cols);
+  const size_t row_bytes = static_cast<size_t>(cols) * sizeof(Type);
+  std::string raw(static_cast<size_t>(rows) * row_bytes, '\0');
+  for (int i = 0; i < rows; ++i) {
+    memcpy(raw.data() + static_cast<size_t>(i) * row_bytes,
+           matrix.row(row + i).data() + col, row_bytes);
+  }
+  if (header.shuffle) {
+    std::string shuffled(raw.size(), '\0');
+    Shuffle(raw.data(), shuffled.data(), raw.size() / sizeof(Type),
+            sizeof(Type));
+    raw.swap(shuffled);
+  }
+  if (!header.compress) {
+    return raw;
+  }
+#ifdef MATRIX_WITH_ZLIB
+  uLongf size = compressBound(static_cast<uLong>(raw.size()));
+  std::string returnable(size, '\0');
+  if (compress2(reinterpret_cast<Bytef*>(returnable.data()), &size,
+                reinterpret_cast<const Bytef*>(raw.data()),
+                static_cast<uLong>(raw.size()), level) != Z_OK) {
+    throw std::runtime_error("Chunk could not be compressed");
+  }
+  returnable.resize(size);
+  return returnable;
+#else
+  static_cast<void>(level);
+  throw invalid_argument("Compressed saving requires MATRIX_WITH_ZLIB");
+#endif
+}
+
+/**
+ * @brief Decompresses and unshuffles stored chunk of "count" elements
+ *
+ */
+template <class Type>
+void DecodeChunk(const std::string& stored, const ChunkedHeader& header,
+                 size_t count, Type* target) {
+  const size_t bytes = count * sizeof(Type);
+  std::string raw;
+  if (header.compress) {
+#ifdef MATRIX_WITH_ZLIB
+    raw.resize(bytes);
+    uLongf size = static_cast<uLongf>(bytes);
+    if (uncompress(reinterpret_cast<Bytef*>(raw.data()), &size,
+                   reinterpret_cast<const Bytef*>(stored.data()),
+                   static_cast<uLong>(stored.size())) != Z_OK ||
+        size != bytes) {
+      throw invalid_argument("Chunked file is corrupted");
+    }
+#else
+    throw invalid_argument("Compressed loading requires MATRIX_WITH_ZLIB");
+#endif
+  } else if (stored.size() == bytes) {
+    raw = stored;
+  } else {
+    throw invalid_argument("Chunked file is corrupted");
+  }
+  if (header.shuffle) {
+    Unshuffle(raw.data(), reinterpret_cast<char*>(target), count,
+              sizeof(Type));
+  } else {
+    memcpy(target, raw.data(), bytes);
+  }
+}
+
+}  // namespace chunked
+
+/**
+ * @brief Reads and checks header of chunked file
+ *
+ * @param path const std::string& type
+ * @return ChunkedHeader
+ */
+inline ChunkedHeader ReadChunkedHeader(const std::string& path) {
+  std::ifstream file(path, std::ios::binary | std::ios::ate);
+  if (!file) {
+    throw invalid_argument("File could not be opened.");
+  }
+  const uint64_t file_size = static_cast<uint64_t>(file.tellg());
+  std::string raw(chunked::kHeaderBytes, '\0');
+  file.seekg(0);
+  if (!file.read(raw.data(), static_cast<std::streamsize>(raw.size())) ||
+      raw.compare(0, sizeof(chunked::kMagic), chunked::kMagic,
+                  sizeof(chunked::kMagic)) != 0 ||
+      chunked::Get<uint32_t>(raw.data() + 4) != chunked::kVersion) {
+    throw invalid_argument("File is not a chunked matrix");
+  }
+  ChunkedHeader header;
+  header.kind = static_cast<char>(raw[8]);
+  header.element_size = static_cast<uint8_t>(raw[9]);
+  header.shuffle = (raw[10] & chunked::kShuffleFlag) != 0;
+  header.compress = (raw[10] & chunked::kCompressFlag) != 0;
+  int* sizes[] = {&header.rows, &header.cols, &header.chunk_rows,
+                  &header.chunk_cols};
+  for (size_t i = 0; i < 4; ++i) {
+    const uint32_t value = chunked::Get<uint32_t>(raw.data() + 12 + 4 * i);
+    if (value < 1 || value > std::numeric_limits<int>::max()) {
+      throw invalid_argument("Chunked file is corrupted");
+    }
+    *sizes[i] = static_cast<int>(value);
+  }
+  header.index_offset = chunked::Get<uint64_t>(raw.data() + 28);
+  const uint64_t index_bytes = static_cast<uint64_t>(header.grid_rows()) *
+                               static_cast<uint64_t>(header.grid_cols()) * 16;
+  if (header.index_offset < chunked::kHeaderBytes ||
+      header.index_offset > file_size ||
+      file_size - header.index_offset != index_bytes) {
+    throw invalid_argument("Chunked file is corrupted");
+  }
+
+  return header;
+}
+
+/**
+ * @brief Saves matrix as chunks of "options.chunk_rows"*"chunk_cols", each
+ * shuffled and compressed separately, followed by index of chunks. Batches
+ * of chunks are encoded in parallel and written in order
+ *
+ * @param matrix const Matrix& type
+ * @param path const std::string& type
+ * @param options const ChunkedOptions& type
+ */
+template <arithmetic Type>
+void SaveChunked(const Matrix<Type>& matrix, const std::string& path,
+                 const ChunkedOptions& options) {
+  if (options.chunk_rows < 1 || options.chunk_cols < 1) {
+    throw invalid_argument("Chunk with less than 1x1 size");
+  }
+  if (options.level < 0 || options.level > 9) {
+    throw invalid_argument("Compression level out of 0-9 range");
+  }
+#ifndef MATRIX_WITH_ZLIB
+  if (options.compress) {
+    throw invalid_argument("Compressed saving requires MATRIX_WITH_ZLIB");
+  }
+#endif
+  ChunkedHeader header;
+  header.rows = matrix.rows();
+  header.cols = matrix.cols();
+  header.chunk_rows = std::min(options.chunk_rows, header.rows);
+  header.chunk_cols = std::min(options.chunk_cols, header.cols);
+  header.kind = chunked::Kind<Type>();
+  header.element_size = static_cast<int>(sizeof(Type));
+  header.shuffle = options.shuffle;
+  header.compress = options.compress;
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    throw invalid_argument("File could not be opened.");
+  }
+  file << chunked::EncodeHeader(header);
+
+  const int count = header.grid_rows() * header.grid_cols();
+  const int threads =
+      options.threads > 0 ? options.threads : HardwareThreads();
+  std::vector<std::string> encoded(static_cast<size_t>(threads) * 4);
+  std::string index;
+  uint64_t offset = chunked::kHeaderBytes;
+  for (int first = 0; first < count;
+       first += static_cast<int>(encoded.size())) {
+    const int amount =
+        std::min(count - first, static_cast<int>(encoded.size()));
+    ParallelFor(0, amount, threads, [&](int begin, int end) {
+      for (int i = begin; i < end; ++i) {
+        encoded[static_cast<size_t>(i)] = chunked::EncodeChunk(
+            matrix, header, first + i, options.level);
+      }
+    });
+    for (int i = 0; i < amount; ++i) {
+      std::string& chunk = encoded[static_cast<size_t>(i)];
+      file << chunk;
+      chunked::Put(&index, offset);
+      chunked::Put(&index, static_cast<uint64_t>(chunk.size()));
+      offset += chunk.size();
+      std::string().swap(chunk);
+    }
+  }
+  file << index;
+  header.index_offset = offset;
+  file.seekp(0);
+  file << chunked::EncodeHeader(header);
+  if (!file) {
+    throw std::runtime_error("File could not be written.");
+  }
+}
+
+/**
+ * @brief Loads whole chunked matrix, chunks are read and decompressed by
+ * "threads" threads (0 for all hardware threads)
+ *
+ * @param path const std::string& type
+ * @param threads int type
+ * @return Matrix
+ */
+template <arithmetic Type>
+Matrix<Type> LoadChunked(const std::string& path, int threads) {
+  const ChunkedHeader header = ReadChunkedHeader(path);
+  return LoadChunked<Type>(path, 0, 0, header.rows, header.cols, threads);
+}
+
+/**
+ * @brief Loads submatrix of "rows"*"cols" starting at ("row", "col"). Only
+ * chunks intersecting it are read and decompressed, in parallel, each
+ * thread reads file through its own stream
+ *
+ * @return Matrix
+ */
+template <arithmetic Type>
+Matrix<Type> LoadChunked(const std::string& path, int row, int col, int rows,
+                         int cols, int threads) {
+  const ChunkedHeader header = ReadChunkedHeader(path);
+  if (header.kind != chunked::Kind<Type>() ||
+      header.element_size != static_cast<int>(sizeof(Type))) {
+    throw invalid_argument("Chunked file of different element type");
+  }
+  Matrix<Type> returnable(rows, cols);
+  if (row < 0 || col < 0 || row > header.rows - rows ||
+      col > header.cols - cols) {
+    throw out_of_range("Submatrix that is out of matrix range");
+  }
+  const std::vector<chunked::IndexEntry> index =
+      chunked::ReadIndex(path, header);
+  const int first_row = row / header.chunk_rows;
+  const int first_col = col / header.chunk_cols;
+  const int grid_rows = (row + rows - 1) / header.chunk_rows - first_row + 1;
+  const int grid_cols = (col + cols - 1) / header.chunk_cols - first_col + 1;
+  Type* target = returnable.data();
+
+  ParallelFor(0, grid_rows * grid_cols, threads, [&](int first, int last) {
+    std::ifstream file(path, std::ios::binary);
+    std::string stored;
+    std::vector<Type> values;
+    for (int i = first; i < last; ++i) {
+      const int chunk = (first_row + i / grid_cols) * header.grid_cols() +
+                        first_col + i % grid_cols;
+      const chunked::IndexEntry& entry = index[static_cast<size_t>(chunk)];
+      stored.resize(entry.size);
+      file.seekg(static_cast<std::streamoff>(entry.offset));
+      if (!file.read(stored.data(),
+                     static_cast<std::streamsize>(stored.size()))) {
+        throw invalid_argument("Chunked file is corrupted");
+      }
+      int chunk_row = 0, chunk_col = 0, chunk_rows = 0, chunk_cols = 0;
+      chunked::ChunkBounds(header, chunk, &chunk_row, &chunk_col, &chunk_rows,
+                           &chunk_cols);
+      values.resize(static_cast<size_t>(chunk_rows) *
+                    static_cast<size_t>(chunk_cols));
+      chunked::DecodeChunk(stored, header, values.size(), values.data());
+
+      const int begin_i = std::max(row, chunk_row);
+      const int end_i = std::min(row + rows, chunk_row + chunk_rows);
+      const int begin_j = std::max(col, chunk_col);
+      const int end_j = std::min(col + cols, chunk_col + chunk_cols);
+      for (int r = begin_i; r < end_i; ++r) {
+        const Type* source =
+            values.data() +
+            static_cast<size_t>(r - chunk_row) *
+                static_cast<size_t>(chunk_cols) +
+            (begin_j - chunk_col);
+        std::copy(source, source + (end_j - begin_j),
+                  target +
+                      static_cast<size_t>(r - row) *
+                          static_cast<size_t>(cols) +
+                      (begin_j - col));
+      }
+    }
+  });
+
+  return returnable;
+}
+
+}  // namespace hhullen
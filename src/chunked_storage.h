@@ -0,0 +1,82 @@
+#ifndef SRC_CHUNKED_STORAGE_H_
+#define SRC_CHUNKED_STORAGE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "matrix.h"
+
+namespace hhullen {
+
+/**
+ * @brief Options of chunked saving: chunk size, per-chunk deflate
+ * compression of "level" (requires building with MATRIX_WITH_ZLIB), byte
+ * shuffle of elements before compression and amount of threads (0 for all
+ * hardware threads)
+ *
+ */
+struct ChunkedOptions {
+  int chunk_rows = 256;
+  int chunk_cols = 256;
+  bool compress = true;
+  bool shuffle = true;
+  int level = 6;
+  int threads = 0;
+};
+
+/**
+ * @brief Header of chunked file. "kind" is 'f', 'i' or 'u' for floating,
+ * signed and unsigned elements of "element_size" bytes
+ *
+ */
+struct ChunkedHeader {
+  int rows = 0, cols = 0;
+  int chunk_rows = 0, chunk_cols = 0;
+  char kind = 'f';
+  int element_size = 0;
+  bool shuffle = false, compress = false;
+  uint64_t index_offset = 0;
+
+  int grid_rows() const { return (rows + chunk_rows - 1) / chunk_rows; }
+  int grid_cols() const { return (cols + chunk_cols - 1) / chunk_cols; }
+};
+
+inline ChunkedHeader ReadChunkedHeader(const std::string& path);
+template <arithmetic Type>
+void SaveChunked(const Matrix<Type>& matrix, const std::string& path,
+                 const ChunkedOptions& options = ChunkedOptions());
+template <arithmetic Type>
+Matrix<Type> LoadChunked(const std::string& path, int threads = 0);
+template <arithmetic Type>
+Matrix<Type> LoadChunked(const std::string& path, int row, int col, int rows,
+                         int cols, int threads = 0);
+
+namespace chunked {
+
+/**
+ * @brief Location of stored chunk in file
+ *
+ */
+struct IndexEntry {
+  uint64_t offset = 0;
+  uint64_t size = 0;
+};
+
+template <class Type>
+char Kind();
+inline std::vector<IndexEntry> ReadIndex(const std::string& path,
+                                         const ChunkedHeader& header);
+template <class Type>
+std::string EncodeChunk(const Matrix<Type>& matrix,
+                        const ChunkedHeader& header, int chunk, int level);
+template <class Type>
+void DecodeChunk(const std::string& stored, const ChunkedHeader& header,
+                 size_t count, Type* target);
+
+}  // namespace chunked
+
+}  // namespace hhullen
+
+#endif  // SRC_CHUNKED_STORAGE_H_
@@ -0,0 +1,901 @@
+#include "decompositions.h"
+
+#include <numeric>
+#include <random>
+
+namespace hhullen {
+
+/**
+ * @brief Factors "a", by blocked Householder reflections for single row
+ * block or by TSQR for several
+ *
+ * @param a const Matrix& type m*n matrix, m >= n
+ * @param row_blocks int type amount of row blocks factored in parallel, 0
+ * to choose by matrix size and hardware threads, 1 for plain blocked QR.
+ * Reduced so that every block has at least n rows
+ */
+template <std::floating_point Type>
+QrDecomposition<Type>::QrDecomposition(const Matrix<Type>& a, int row_blocks)
+    : rows_(a.rows()), cols_(a.cols()) {
+  if (rows_ < cols_) {
+    throw invalid_argument("QR decomposition of wide matrix");
+  }
+  if (row_blocks <= 0) {
+    row_blocks = std::min(HardwareThreads(), rows_ / kRowsPerThread);
+  }
+  row_blocks = std::max(1, std::min(row_blocks, rows_ / std::max(cols_, 1)));
+
+  leaves_.resize(static_cast<size_t>(row_blocks));
+  for (int i = 0; i <= row_blocks; ++i) {
+    first_rows_.push_back(static_cast<int>(static_cast<long>(rows_) * i /
+                                           row_blocks));
+  }
+  if (row_blocks == 1) {
+    Matrix<Type> factors = a.Clone();
+    leaves_[0] = decompositions::HouseholderQr(&factors, kBlock);
+    r_ = decompositions::UpperTriangle(factors);
+    return;
+  }
+
+  Matrix<Type> stacked(row_blocks * cols_, cols_);
+  ParallelFor(0, row_blocks, 0, [&](int first, int last) {
+    for (int i = first; i < last; ++i) {
+      const size_t index = static_cast<size_t>(i);
+      const int begin = first_rows_[index];
+      Matrix<Type> factors(first_rows_[index + 1] - begin, cols_);
+      std::span<const Type> source = a.row(begin);
+      std::copy(source.data(), source.data() + factors.size(),
+                factors.begin());
+      leaves_[index] = decompositions::HouseholderQr(&factors, kBlock);
+      for (int row = 0; row < cols_; ++row) {
+        std::span<const Type> values = std::as_const(factors).row(row);
+        std::copy(values.begin() + row, values.end(),
+                  stacked.row(i * cols_ + row).begin() + row);
+      }
+    }
+  });
+  root_ = decompositions::HouseholderQr(&stacked, kBlock);
+  r_ = decompositions::UpperTriangle(stacked);
+}
+
+/**
+ * @brief Thin product q^T * b without forming "q"
+ *
+ * @param b const Matrix& type m*k matrix
+ * @return Matrix n*k first rows of q^T * b
+ */
+template <std::floating_point Type>
+Matrix<Type> QrDecomposition<Type>::ApplyQt(const Matrix<Type>& b) const {
+  if (b.rows() != rows_) {
+    throw invalid_argument("Applying QR factor to matrix of other size");
+  }
+  const size_t blocks = leaves_.size();
+  Matrix<Type> stacked(static_cast<int>(blocks) * cols_, b.cols());
+  ParallelFor(0, static_cast<int>(blocks), 0, [&](int first, int last) {
+    for (int i = first; i < last; ++i) {
+      const size_t index = static_cast<size_t>(i);
+      const int begin = first_rows_[index];
+      Matrix<Type> local(first_rows_[index + 1] - begin, b.cols());
+      std::span<const Type> source = b.row(begin);
+      std::copy(source.data(), source.data() + local.size(), local.begin());
+      decompositions::ApplyHouseholder(leaves_[index], true, &local);
+      std::copy(local.begin(), local.begin() + cols_ * b.cols(),
+                stacked.row(i * cols_).begin());
+    }
+  });
+  if (blocks > 1) {
+    decompositions::ApplyHouseholder(root_, true, &stacked);
+  }
+
+  Matrix<Type> returnable(cols_, b.cols());
+  std::copy(stacked.begin(), stacked.begin() + returnable.size(),
+            returnable.begin());
+  return returnable;
+}
+
+/**
+ * @brief Thin product q * c without forming "q"
+ *
+ * @param c const Matrix& type n*k matrix
+ * @return Matrix m*k product of first n columns of q and "c"
+ */
+template <std::floating_point Type>
+Matrix<Type> QrDecomposition<Type>::ApplyQ(const Matrix<Type>& c) const {
+  if (c.rows() != cols_) {
+    throw invalid_argument("Applying QR factor to matrix of other size");
+  }
+  const size_t blocks = leaves_.size();
+  Matrix<Type> stacked(static_cast<int>(blocks) * cols_, c.cols());
+  std::copy(c.begin(), c.end(), stacked.begin());
+  if (blocks > 1) {
+    decompositions::ApplyHouseholder(root_, false, &stacked);
+  }
+
+  Matrix<Type> returnable(rows_, c.cols());
+  ParallelFor(0, static_cast<int>(blocks), 0, [&](int first, int last) {
+    for (int i = first; i < last; ++i) {
+      const size_t index = static_cast<size_t>(i);
+      const int begin = first_rows_[index];
+      Matrix<Type> local(first_rows_[index + 1] - begin, c.cols());
+      std::span<const Type> top = std::as_const(stacked).row(i * cols_);
+      std::copy(top.data(), top.data() + cols_ * c.cols(), local.begin());
+      decompositions::ApplyHouseholder(leaves_[index], false, &local);
+      std::copy(local.begin(), local.end(), returnable.row(begin).begin());
+    }
+  });
+  return returnable;
+}
+
+/**
+ * @brief Solves least-squares problem min ||a * x - b|| by back
+ * substitution r * x = q^T * b
+ *
+ * @param b const Matrix& type m*k right side, one column per problem
+ * @return Matrix n*k solution
+ */
+template <std::floating_point Type>
+Matrix<Type> QrDecomposition<Type>::LeastSquares(const Matrix<Type>& b) const {
+  Matrix<Type> returnable = ApplyQt(b);
+  const size_t n = static_cast<size_t>(cols_);
+  const size_t nrhs = static_cast<size_t>(b.cols());
+  const Type* factors = r_.data();
+  for (size_t i = 0; i < n; ++i) {
+    if (factors[i * n + i] == 0) {
+      throw invalid_argument("Least squares with rank deficient matrix");
+    }
+  }
+
+  Type* values = returnable.data();
+  if (!BlasTriangularSolve(false, factors, values, n, nrhs)) {
+    for (size_t i = n; i-- > 0;) {
+      for (size_t p = i + 1; p < n; ++p) {
+        for (size_t j = 0; j < nrhs; ++j) {
+          values[i * nrhs + j] -= factors[i * n + p] * values[p * nrhs + j];
+        }
+      }
+      for (size_t j = 0; j < nrhs; ++j) {
+        values[i * nrhs + j] /= factors[i * n + i];
+      }
+    }
+  }
+  return returnable;
+}
+
+/**
+ * @brief Solves least-squares problem min ||a * x - b|| by QR decomposition
+ *
+ * @param a const Matrix& type m*n matrix, m >= n
+ * @param b const Matrix& type m*k right side
+ * @return Matrix n*k solution
+ */
+template <std::floating_point Type>
+Matrix<Type> LeastSquares(const Matrix<Type>& a, const Matrix<Type>& b) {
+  return QrDecomposition<Type>(a).LeastSquares(b);
+}
+
+/**
+ * @brief Eigenvalues and eigenvectors of symmetric matrix by Householder
+ * tridiagonalization. All components are found by implicit QL iterations,
+ * for k < n QL computes eigenvalues only and the k eigenvectors are found
+ * by inverse iteration. Eigenvectors are transformed back by blocks of
+ * reflections applied with Gemm
+ *
+ * @param a const Matrix& type symmetric matrix, only its values are used
+ * @param k int type amount of largest eigenvalues to return, 0 for all
+ * @return EigenDecomposition: "values" is k*1 in descending order, column
+ * "i" of n*k "vectors" is normalized eigenvector of "values(i, 0)"
+ */
+template <std::floating_point Type>
+EigenDecomposition<Type> SymmetricEigen(const Matrix<Type>& a, int k) {
+  if (a.rows() != a.cols()) {
+    throw invalid_argument("Eigen decomposition of not square matrix");
+  }
+  const int n = a.rows();
+  if (k <= 0 || k > n) {
+    k = n;
+  }
+  Matrix<Type> reduced = a.Clone();
+  std::vector<Type> diagonal, off_diagonal;
+  const std::vector<decompositions::HouseholderBlock<Type>> reflections =
+      decompositions::Tridiagonalize(&reduced, &diagonal, &off_diagonal);
+  std::vector<Type> values = diagonal, rest = off_diagonal;
+
+  EigenDecomposition<Type> returnable{Matrix<Type>(k, 1), Matrix<Type>()};
+  if (k == n) {
+    Matrix<Type> tridiagonal_vectors(n, n);
+    for (int i = 0; i < n; ++i) {
+      tridiagonal_vectors(i, i) = 1;
+    }
+    decompositions::TridiagonalQl(&values, &rest, &tridiagonal_vectors);
+
+    std::vector<int> order(static_cast<size_t>(n));
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&values](int i, int j) {
+      return values[static_cast<size_t>(i)] > values[static_cast<size_t>(j)];
+    });
+    Matrix<Type> selected(n, n);
+    for (int i = 0; i < n; ++i) {
+      const int source = order[static_cast<size_t>(i)];
+      returnable.values(i, 0) = values[static_cast<size_t>(source)];
+      std::span<const Type> row =
+          std::as_const(tridiagonal_vectors).row(source);
+      std::copy(row.begin(), row.end(), selected.row(i).begin());
+    }
+    returnable.vectors = selected.Transpose();
+  } else {
+    decompositions::TridiagonalQl<Type>(&values, &rest, nullptr);
+    std::sort(values.begin(), values.end(), std::greater<Type>());
+    values.resize(static_cast<size_t>(k));
+    std::copy(values.begin(), values.end(), returnable.values.begin());
+    returnable.vectors = decompositions::TridiagonalInverseIteration(
+        diagonal, off_diagonal, values);
+  }
+  decompositions::ApplyHouseholder(reflections, false, &returnable.vectors);
+
+  return returnable;
+}
+
+/**
+ * @brief Thin singular value decomposition a = u * diag(s) * vt. Tall
+ * matrix is reduced by QR decomposition to n*n "r", whose singular vectors
+ * are found by one-sided Jacobi rotations, so small singular values keep
+ * relative accuracy. Wide matrix is decomposed through its transpose
+ *
+ * @param a const Matrix& type m*n matrix
+ * @param k int type amount of largest singular values to return, 0 for
+ * min(m, n)
+ * @return SingularDecomposition: m*k "u", k*1 "s" in descending order, k*n
+ * "vt"
+ */
+template <std::floating_point Type>
+SingularDecomposition<Type> ThinSvd(const Matrix<Type>& a, int k) {
+  if (a.rows() < a.cols()) {
+    const SingularDecomposition<Type> transposed = ThinSvd(a.Transpose(), k);
+    return {transposed.vt.Transpose(), transposed.s,
+            transposed.u.Transpose()};
+  }
+  const int n = a.cols();
+  if (k <= 0 || k > n) {
+    k = n;
+  }
+  const QrDecomposition<Type> qr(a);
+  Matrix<Type> columns = qr.r().Transpose();
+  Matrix<Type> rotations(n, n);
+  for (int i = 0; i < n; ++i) {
+    rotations(i, i) = 1;
+  }
+  decompositions::OneSidedJacobi(&columns, &rotations);
+
+  std::vector<Type> norms(static_cast<size_t>(n));
+  for (int i = 0; i < n; ++i) {
+    std::span<const Type> row = std::as_const(columns).row(i);
+    norms[static_cast<size_t>(i)] =
+        std::sqrt(std::inner_product(row.begin(), row.end(), row.begin(),
+                                     Type(0)));
+  }
+  std::vector<int> order(static_cast<size_t>(n));
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&norms](int i, int j) {
+    return norms[static_cast<size_t>(i)] > norms[static_cast<size_t>(j)];
+  });
+
+  Matrix<Type> s(k, 1), left(k, n), vt(k, n);
+  for (int i = 0; i < k; ++i) {
+    const int source = order[static_cast<size_t>(i)];
+    const Type value = norms[static_cast<size_t>(source)];
+    s(i, 0) = value;
+    std::span<const Type> column = std::as_const(columns).row(source);
+    std::transform(column.begin(), column.end(), left.row(i).begin(),
+                   [value](Type x) { return value > 0 ? x / value : 0; });
+    std::span<const Type> rotation = std::as_const(rotations).row(source);
+    std::copy(rotation.begin(), rotation.end(), vt.row(i).begin());
+  }
+
+  return {qr.ApplyQ(left.Transpose()), s, vt};
+}
+
+namespace decompositions {
+
+constexpr size_t kReflectionBlock = 32;
+constexpr int kInverseIterations = 3;
+constexpr int kMaxSweeps = 30;
+
+/**
+ * @brief Reduces symmetric matrix to tridiagonal form a = q * t * q^T by
+ * Householder reflections. Rank-2 updates are split between threads
+ *
+ * @param a Matrix* type symmetric matrix, destroyed
+ * @param diagonal std::vector* type output diagonal of t
+ * @param off_diagonal std::vector* type output subdiagonal of t,
+ * "off_diagonal[i]" is t(i, i - 1), "off_diagonal[0]" is 0
+ * @return std::vector of reflection blocks, "q" is their product in order
+ */
+template <std::floating_point Type>
+std::vector<HouseholderBlock<Type>> Tridiagonalize(
+    Matrix<Type>* a, std::vector<Type>* diagonal,
+    std::vector<Type>* off_diagonal) {
+  const size_t n = static_cast<size_t>(a->rows());
+  const size_t amount = n < 2 ? 0 : n - 2;
+  Type* values = a->MutableData();
+  Matrix<Type> reflectors(a->rows(), a->rows());
+  Type* vectors = reflectors.data();
+  std::vector<Type> p(n), q(n), tau(amount);
+  off_diagonal->assign(n, 0);
+
+  for (size_t k = 0; k + 2 < n; ++k) {
+    Type norm = 0;
+    for (size_t i = k + 1; i < n; ++i) {
+      norm += values[i * n + k] * values[i * n + k];
+    }
+    norm = std::sqrt(norm);
+    Type* v = vectors + k * n;
+    const Type head = values[(k + 1) * n + k];
+    const Type alpha = head > 0 ? -norm : norm;
+    (*off_diagonal)[k + 1] = alpha;
+    if (norm == 0) {
+      continue;
+    }
+
+    Type v_norm = 0;
+    for (size_t i = k + 1; i < n; ++i) {
+      v[i] = values[i * n + k] - (i == k + 1 ? alpha : 0);
+      v_norm += v[i] * v[i];
+    }
+    v_norm = std::sqrt(v_norm);
+    if (v_norm == 0) {
+      v[k + 1] = 0;
+      continue;
+    }
+    for (size_t i = k + 1; i < n; ++i) {
+      v[i] /= v_norm;
+    }
+    tau[k] = 2;
+
+    const int rest = static_cast<int>(n - k - 1);
+    const size_t work = (n - k) * (n - k);
+    ForEachPart(rest, work, [&](int first, int last) {
+      for (size_t i = k + 1 + static_cast<size_t>(first);
+           i < k + 1 + static_cast<size_t>(last); ++i) {
+        Type sum = 0;
+        for (size_t j = k + 1; j < n; ++j) {
+          sum += values[i * n + j] * v[j];
+        }
+        p[i] = sum;
+      }
+    });
+    Type product = 0;
+    for (size_t i = k + 1; i < n; ++i) {
+      product += v[i] * p[i];
+    }
+    for (size_t i = k + 1; i < n; ++i) {
+      q[i] = 2 * p[i] - 2 * product * v[i];
+    }
+    ForEachPart(rest, work, [&](int first, int last) {
+      for (size_t i = k + 1 + static_cast<size_t>(first);
+           i < k + 1 + static_cast<size_t>(last); ++i) {
+        for (size_t j = k + 1; j < n; ++j) {
+          values[i * n + j] -= v[i] * q[j] + q[i] * v[j];
+        }
+      }
+    });
+  }
+  if (n >= 2) {
+    (*off_diagonal)[n - 1] = values[(n - 1) * n + n - 2];
+  }
+  diagonal->resize(n);
+  for (size_t i = 0; i < n; ++i) {
+    (*diagonal)[i] = values[i * n + i];
+  }
+
+  std::vector<HouseholderBlock<Type>> returnable;
+  for (size_t first = 0; first < amount; first += kReflectionBlock) {
+    const size_t last = std::min(amount, first + kReflectionBlock);
+    const size_t width = last - first;
+    const size_t height = n - first - 1;
+    HouseholderBlock<Type> reflections{
+        static_cast<int>(first + 1),
+        Matrix<Type>(static_cast<int>(height), static_cast<int>(width)),
+        Matrix<Type>()};
+    Type* v = reflections.v.data();
+    for (size_t i = 0; i < height; ++i) {
+      for (size_t j = 0; j < width && j <= i; ++j) {
+        v[i * width + j] = vectors[(first + j) * n + first + 1 + i];
+      }
+    }
+    reflections.t = TriangularFactor(
+        reflections.v, std::span<const Type>(tau).subspan(first, width));
+    returnable.push_back(std::move(reflections));
+  }
+
+  return returnable;
+}
+
+/**
+ * @brief Eigenvalues and eigenvectors of symmetric tridiagonal matrix by
+ * implicit QL iterations with Wilkinson shifts
+ *
+ * @param diagonal std::vector* type diagonal, replaced by eigenvalues
+ * @param off_diagonal std::vector* type subdiagonal as returned by
+ * Tridiagonalize, destroyed
+ * @param vectors Matrix* type n*n identity, row "i" is replaced by
+ * eigenvector of "diagonal[i]", or nullptr to find eigenvalues only
+ */
+template <std::floating_point Type>
+void TridiagonalQl(std::vector<Type>* diagonal, std::vector<Type>* off_diagonal,
+                   Matrix<Type>* vectors) {
+  std::vector<Type>& d = *diagonal;
+  std::vector<Type>& e = *off_diagonal;
+  const size_t n = d.size();
+  const size_t cols =
+      vectors == nullptr ? 0 : static_cast<size_t>(vectors->cols());
+  Type* z = vectors == nullptr ? nullptr : vectors->MutableData();
+  const Type eps = std::numeric_limits<Type>::epsilon();
+  const int max_iterations = 30 * static_cast<int>(std::max<size_t>(n, 1));
+
+  for (size_t i = 1; i < n; ++i) {
+    e[i - 1] = e[i];
+  }
+  if (n > 0) {
+    e[n - 1] = 0;
+  }
+
+  Type shift = 0, tst1 = 0;
+  for (size_t l = 0; l < n; ++l) {
+    tst1 = std::max(tst1, std::abs(d[l]) + std::abs(e[l]));
+    size_t m = l;
+    while (m < n - 1 && std::abs(e[m]) > eps * tst1) {
+      ++m;
+    }
+
+    int iterations = 0;
+    while (m > l && std::abs(e[l]) > eps * tst1) {
+      if (++iterations > max_iterations) {
+        throw std::runtime_error("Eigen decomposition did not converge");
+      }
+      Type g = d[l];
+      Type p = (d[l + 1] - g) / (2 * e[l]);
+      Type r = std::hypot(p, Type(1));
+      if (p < 0) {
+        r = -r;
+      }
+      d[l] = e[l] / (p + r);
+      d[l + 1] = e[l] * (p + r);
+      const Type dl1 = d[l + 1];
+      Type h = g - d[l];
+      for (size_t i = l + 2; i < n; ++i) {
+        d[i] -= h;
+      }
+      shift += h;
+
+      p = d[m];
+      Type c = 1, c2 = 1, c3 = 1, s = 0, s2 = 0;
+      const Type el1 = e[l + 1];
+      for (size_t i = m; i-- > l;) {
+        c3 = c2;
+        c2 = c;
+        s2 = s;
+        g = c * e[i];
+        h = c * p;
+        r = std::hypot(p, e[i]);
+        e[i + 1] = s * r;
+        s = e[i] / r;
+        c = p / r;
+        p = c * d[i] - s * g;
+        d[i + 1] = h + s * (c * g + s * d[i]);
+
+        Type* row_i = z + i * cols;
+        Type* row_next = z + (i + 1) * cols;
+        for (size_t j = 0; j < cols; ++j) {
+          const Type next = row_next[j];
+          row_next[j] = s * row_i[j] + c * next;
+          row_i[j] = c * row_i[j] - s * next;
+        }
+      }
+      p = -s * s2 * c3 * el1 * e[l] / dl1;
+      e[l] = s * p;
+      d[l] = c * p;
+    }
+    d[l] += shift;
+    e[l] = 0;
+  }
+}
+
+/**
+ * @brief Eigenvectors of symmetric tridiagonal matrix for given eigenvalues
+ * by inverse iteration with shifted tridiagonal LU. Eigenvalues closer
+ * than kClusterGap of matrix norm form a cluster: shifts of its members
+ * are separated and their vectors are orthogonalized to each other.
+ * Clusters are split between threads
+ *
+ * @param diagonal const std::vector& type diagonal as returned by
+ * Tridiagonalize
+ * @param off_diagonal const std::vector& type subdiagonal as returned by
+ * Tridiagonalize
+ * @param values const std::vector& type eigenvalues in descending order
+ * @return Matrix n*k, column "j" is normalized eigenvector of "values[j]"
+ */
+template <std::floating_point Type>
+Matrix<Type> TridiagonalInverseIteration(const std::vector<Type>& diagonal,
+                                         const std::vector<Type>& off_diagonal,
+                                         const std::vector<Type>& values) {
+  constexpr Type kClusterGap = Type(1e-3);
+  const size_t n = diagonal.size(), k = values.size();
+  const Type eps = std::numeric_limits<Type>::epsilon();
+  Type norm = 0;
+  for (size_t i = 0; i < n; ++i) {
+    const Type next = i + 1 < n ? std::abs(off_diagonal[i + 1]) : 0;
+    norm = std::max(norm, std::abs(diagonal[i]) +
+                              std::abs(off_diagonal[i]) + next);
+  }
+  if (norm == 0) {
+    norm = 1;
+  }
+  std::vector<size_t> clusters = {0};
+  for (size_t j = 1; j < k; ++j) {
+    if (values[j - 1] - values[j] > kClusterGap * norm) {
+      clusters.push_back(j);
+    }
+  }
+  clusters.push_back(k);
+
+  Matrix<Type> vectors(static_cast<int>(k), static_cast<int>(n));
+  Type* rows = vectors.data();
+  auto find_clusters = [&](int first, int last) {
+    TridiagonalLu<Type> lu;
+    for (size_t c = static_cast<size_t>(first);
+         c < static_cast<size_t>(last); ++c) {
+      Type shift = 0;
+      for (size_t j = clusters[c]; j < clusters[c + 1]; ++j) {
+        shift = j == clusters[c]
+                    ? values[j]
+                    : std::min(values[j], shift - 10 * eps * norm);
+        FactorShifted(diagonal, off_diagonal, shift, eps * norm, &lu);
+        Type* x = rows + j * n;
+        std::minstd_rand generator(static_cast<unsigned>(j + 1));
+        std::uniform_real_distribution<Type> uniform(-1, 1);
+        std::generate(x, x + n, [&] { return uniform(generator); });
+        for (int iteration = 0; iteration < kInverseIterations; ++iteration) {
+          SolveFactored(lu, x);
+          for (size_t other = clusters[c]; other < j; ++other) {
+            const Type* y = rows + other * n;
+            const Type product = std::inner_product(x, x + n, y, Type(0));
+            for (size_t i = 0; i < n; ++i) {
+              x[i] -= product * y[i];
+            }
+          }
+          const Type length =
+              std::sqrt(std::inner_product(x, x + n, x, Type(0)));
+          std::transform(x, x + n, x, [length](Type v) { return v / length; });
+        }
+      }
+    }
+  };
+  const int amount_clusters = static_cast<int>(clusters.size() - 1);
+  ForEachPart(amount_clusters, n * k, find_clusters);
+
+  return vectors.Transpose();
+}
+
+/**
+ * @brief LU factorization with partial pivoting of tridiagonal matrix
+ * t - shift * I. Zero pivots are replaced by "tiny"
+ *
+ */
+template <std::floating_point Type>
+void FactorShifted(const std::vector<Type>& diagonal,
+                   const std::vector<Type>& off_diagonal, Type shift,
+                   Type tiny, TridiagonalLu<Type>* lu) {
+  const size_t n = diagonal.size();
+  lu->u0.assign(n, 0);
+  lu->u1.assign(n, 0);
+  lu->u2.assign(n, 0);
+  lu->l.assign(n, 0);
+  lu->swapped.assign(n, false);
+  if (n == 0) {
+    return;
+  }
+  Type a = diagonal[0] - shift, b = n > 1 ? off_diagonal[1] : 0;
+  for (size_t i = 0; i + 1 < n; ++i) {
+    const Type sub = off_diagonal[i + 1];
+    const Type next = diagonal[i + 1] - shift;
+    const Type super = i + 2 < n ? off_diagonal[i + 2] : 0;
+    if (std::abs(a) >= std::abs(sub)) {
+      a = a == 0 ? tiny : a;
+      lu->u0[i] = a;
+      lu->u1[i] = b;
+      lu->l[i] = sub / a;
+      a = next - lu->l[i] * b;
+      b = super;
+    } else {
+      lu->swapped[i] = true;
+      lu->u0[i] = sub;
+      lu->u1[i] = next;
+      lu->u2[i] = super;
+      lu->l[i] = a / sub;
+      a = b - lu->l[i] * next;
+      b = -lu->l[i] * super;
+    }
+  }
+  lu->u0[n - 1] = a == 0 ? tiny : a;
+}
+
+/**
+ * @brief Solves factored tridiagonal system in place
+ *
+ */
+template <std::floating_point Type>
+void SolveFactored(const TridiagonalLu<Type>& lu, Type* x) {
+  const size_t n = lu.u0.size();
+  for (size_t i = 0; i + 1 < n; ++i) {
+    if (lu.swapped[i]) {
+      std::swap(x[i], x[i + 1]);
+    }
+    x[i + 1] -= lu.l[i] * x[i];
+  }
+  for (size_t i = n; i-- > 0;) {
+    Type sum = x[i];
+    if (i + 1 < n) {
+      sum -= lu.u1[i] * x[i + 1];
+    }
+    if (i + 2 < n) {
+      sum -= lu.u2[i] * x[i + 2];
+    }
+    x[i] = sum / lu.u0[i];
+  }
+}
+
+/**
+ * @brief Blocked Householder QR of m*n "a", m >= n, in place. Reflections
+ * of every "block" columns are accumulated to compact WY form and applied
+ * to trailing columns by multiplications
+ *
+ * @param a Matrix* type, upper triangle is replaced by "r"
+ * @param block int type amount of columns in one block
+ * @return std::vector of reflection blocks, q is their product in order
+ */
+template <std::floating_point Type>
+std::vector<HouseholderBlock<Type>> HouseholderQr(Matrix<Type>* a,
+                                                  int block) {
+  const size_t m = static_cast<size_t>(a->rows());
+  const size_t n = static_cast<size_t>(a->cols());
+  Type* values = a->MutableData();
+  std::vector<HouseholderBlock<Type>> returnable;
+  std::vector<Type> w(n);
+
+  for (size_t first = 0; first < n; first += static_cast<size_t>(block)) {
+    const size_t last = std::min(n, first + static_cast<size_t>(block));
+    const size_t width = last - first;
+    const size_t height = m - first;
+    std::vector<Type> tau(width);
+
+    for (size_t col = first; col < last; ++col) {
+      Type norm = 0;
+      for (size_t i = col + 1; i < m; ++i) {
+        norm += values[i * n + col] * values[i * n + col];
+      }
+      const Type alpha = values[col * n + col];
+      if (norm == 0) {
+        continue;
+      }
+      const Type length = std::sqrt(alpha * alpha + norm);
+      const Type beta = alpha > 0 ? -length : length;
+      tau[col - first] = (beta - alpha) / beta;
+      for (size_t i = col + 1; i < m; ++i) {
+        values[i * n + col] /= alpha - beta;
+      }
+      values[col * n + col] = beta;
+
+      std::fill(w.begin(), w.end(), Type(0));
+      for (size_t i = col; i < m; ++i) {
+        const Type v = i == col ? 1 : values[i * n + col];
+        for (size_t j = col + 1; j < last; ++j) {
+          w[j] += v * values[i * n + j];
+        }
+      }
+      for (size_t i = col; i < m; ++i) {
+        const Type v = (i == col ? 1 : values[i * n + col]) * tau[col - first];
+        for (size_t j = col + 1; j < last; ++j) {
+          values[i * n + j] -= v * w[j];
+        }
+      }
+    }
+
+    HouseholderBlock<Type> reflections{
+        static_cast<int>(first),
+        Matrix<Type>(static_cast<int>(height), static_cast<int>(width)),
+        Matrix<Type>()};
+    Type* v = reflections.v.data();
+    for (size_t i = 0; i < height; ++i) {
+      for (size_t j = 0; j < width && j <= i; ++j) {
+        v[i * width + j] = i == j ? 1 : values[(first + i) * n + first + j];
+      }
+    }
+    reflections.t = TriangularFactor(reflections.v, std::span<const Type>(tau));
+
+    if (last < n) {
+      Matrix<Type> trailing(static_cast<int>(height),
+                            static_cast<int>(n - last));
+      Type* target = trailing.data();
+      for (size_t i = 0; i < height; ++i) {
+        const Type* source = values + (first + i) * n + last;
+        std::copy(source, source + n - last, target + i * (n - last));
+      }
+      ApplyBlock(reflections, true, &trailing);
+      for (size_t i = 0; i < height; ++i) {
+        std::copy(target + i * (n - last), target + (i + 1) * (n - last),
+                  values + (first + i) * n + last);
+      }
+    }
+    returnable.push_back(std::move(reflections));
+  }
+
+  return returnable;
+}
+
+/**
+ * @brief Triangular factor of compact WY form I - v * t * v^T of product of
+ * reflections I - tau[j] * v_j * v_j^T, where v_j is column "j" of lower
+ * trapezoidal "v"
+ *
+ * @return Matrix upper triangular width*width "t"
+ */
+template <std::floating_point Type>
+Matrix<Type> TriangularFactor(const Matrix<Type>& v,
+                              std::span<const Type> tau) {
+  const size_t height = static_cast<size_t>(v.rows());
+  const size_t width = static_cast<size_t>(v.cols());
+  const Type* values = v.data();
+  Matrix<Type> returnable(v.cols(), v.cols());
+  Type* t = returnable.data();
+  std::vector<Type> w(width);
+
+  for (size_t j = 0; j < width; ++j) {
+    std::fill(w.begin(), w.end(), Type(0));
+    for (size_t i = j; i < height; ++i) {
+      for (size_t p = 0; p < j; ++p) {
+        w[p] += values[i * width + p] * values[i * width + j];
+      }
+    }
+    for (size_t p = 0; p < j; ++p) {
+      Type sum = 0;
+      for (size_t q = p; q < j; ++q) {
+        sum += t[p * width + q] * w[q];
+      }
+      t[p * width + j] = -tau[j] * sum;
+    }
+    t[j * width + j] = tau[j];
+  }
+
+  return returnable;
+}
+
+/**
+ * @brief Applies one block of reflections c = (I - v * op(t) * v^T) * c by
+ * two multiplications, rows of "c" correspond to rows of "v"
+ *
+ * @param transpose bool type apply transposed block
+ */
+template <std::floating_point Type>
+void ApplyBlock(const HouseholderBlock<Type>& block, bool transpose,
+                Matrix<Type>* c) {
+  Matrix<Type> projection(block.v.cols(), c->cols());
+  Matrix<Type> scaled(block.v.cols(), c->cols());
+  Matrix<Type>::Gemm(1, block.v, true, *c, false, 0, &projection);
+  Matrix<Type>::Gemm(1, block.t, transpose, projection, false, 0, &scaled);
+  Matrix<Type>::Gemm(-1, block.v, false, scaled, false, 1, c);
+}
+
+/**
+ * @brief Applies product of reflection blocks b = q * b or b = q^T * b
+ *
+ * @param blocks const std::vector& type result of HouseholderQr
+ * @param transpose bool type apply q^T
+ * @param b Matrix* type matrix of factored matrix rows
+ */
+template <std::floating_point Type>
+void ApplyHouseholder(const std::vector<HouseholderBlock<Type>>& blocks,
+                      bool transpose, Matrix<Type>* b) {
+  const size_t cols = static_cast<size_t>(b->cols());
+  for (size_t index = 0; index < blocks.size(); ++index) {
+    const HouseholderBlock<Type>& block =
+        blocks[transpose ? index : blocks.size() - 1 - index];
+    if (block.offset == 0) {
+      ApplyBlock(block, transpose, b);
+      continue;
+    }
+    Type* values = b->MutableData() + static_cast<size_t>(block.offset) * cols;
+    Matrix<Type> rows(block.v.rows(), b->cols());
+    std::copy(values, values + rows.size(), rows.begin());
+    ApplyBlock(block, transpose, &rows);
+    std::copy(rows.begin(), rows.end(), values);
+  }
+}
+
+/**
+ * @brief One-sided Jacobi rotations of pairs of rows of "w" until all rows
+ * are orthogonal, the same rotations are applied to rows of "v". Pairs of
+ * a sweep are visited in round-robin order, disjoint pairs of one round
+ * are split between threads
+ *
+ * @param w Matrix* type n*m, rows become orthogonal, their norms are
+ * singular values
+ * @param v Matrix* type n*n, rotations are accumulated in its rows
+ */
+template <std::floating_point Type>
+void OneSidedJacobi(Matrix<Type>* w, Matrix<Type>* v) {
+  const size_t n = static_cast<size_t>(w->rows());
+  const size_t m = static_cast<size_t>(w->cols());
+  Type* rows = w->MutableData();
+  Type* rotations = v->MutableData();
+  const Type tolerance = std::sqrt(static_cast<Type>(m)) *
+                         std::numeric_limits<Type>::epsilon();
+  const size_t players = n + n % 2;
+  std::vector<size_t> circle(players);
+  std::iota(circle.begin(), circle.end(), 0);
+  auto rotate = [](Type* x, Type* y, size_t size, Type c, Type s) {
+    for (size_t i = 0; i < size; ++i) {
+      const Type first = x[i];
+      x[i] = c * first - s * y[i];
+      y[i] = s * first + c * y[i];
+    }
+  };
+
+  for (int sweep = 0; sweep < kMaxSweeps; ++sweep) {
+    std::atomic<bool> is_rotated = false;
+    auto rotate_pairs = [&](int first, int last) {
+      for (size_t pair = static_cast<size_t>(first);
+           pair < static_cast<size_t>(last); ++pair) {
+        const size_t p = std::min(circle[pair], circle[players - 1 - pair]);
+        const size_t q = std::max(circle[pair], circle[players - 1 - pair]);
+        if (q >= n) {
+          continue;
+        }
+        Type* x = rows + p * m;
+        Type* y = rows + q * m;
+        Type alpha = 0, beta = 0, gamma = 0;
+        for (size_t i = 0; i < m; ++i) {
+          alpha += x[i] * x[i];
+          beta += y[i] * y[i];
+          gamma += x[i] * y[i];
+        }
+        if (std::abs(gamma) <= tolerance * std::sqrt(alpha * beta)) {
+          continue;
+        }
+        is_rotated.store(true, std::memory_order_relaxed);
+        const Type zeta = (beta - alpha) / (2 * gamma);
+        const Type t = std::copysign(Type(1), zeta) /
+                       (std::abs(zeta) + std::hypot(Type(1), zeta));
+        const Type c = 1 / std::sqrt(1 + t * t);
+        rotate(x, y, m, c, c * t);
+        rotate(rotations + p * n, rotations + q * n, n, c, c * t);
+      }
+    };
+    for (size_t round = 0; round + 1 < players; ++round) {
+      const int pairs = static_cast<int>(players / 2);
+      ForEachPart(pairs, n * m, rotate_pairs);
+      std::rotate(circle.begin() + 1, circle.end() - 1, circle.end());
+    }
+    if (!is_rotated) {
+      return;
+    }
+  }
+  throw std::runtime_error("Singular value decomposition did not converge");
+}
+
+/**
+ * @brief Returns upper n*n triangle of m*n matrix
+ *
+ */
+template <std::floating_point Type>
+Matrix<Type> UpperTriangle(const Matrix<Type>& a) {
+  Matrix<Type> returnable(a.cols(), a.cols());
+  for (int i = 0; i < a.cols(); ++i) {
+    std::span<const Type> row = a.row(i);
+    std::copy(row.begin() + i, row.end(), returnable.row(i).begin() + i);
+  }
+  return returnable;
+}
+
+}  // namespace decompositions
+
+}  // namespace hhullen
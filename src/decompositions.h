@@ -0,0 +1,129 @@
+#ifndef SRC_DECOMPOSITIONS_H_
+#define SRC_DECOMPOSITIONS_H_
+
+#include <concepts>
+#include <vector>
+
+#include "matrix.h"
+
+namespace hhullen {
+
+template <std::floating_point Type>
+struct EigenDecomposition {
+  Matrix<Type> values;
+  Matrix<Type> vectors;
+};
+
+template <std::floating_point Type>
+struct SingularDecomposition {
+  Matrix<Type> u;
+  Matrix<Type> s;
+  Matrix<Type> vt;
+};
+
+namespace decompositions {
+
+/**
+ * @brief Block of Householder reflections H(0) * ... * H(nb - 1) =
+ * I - v * t * v^T in compact WY form acting on rows from "offset"
+ *
+ */
+template <std::floating_point Type>
+struct HouseholderBlock {
+  int offset;
+  Matrix<Type> v;
+  Matrix<Type> t;
+};
+
+/**
+ * @brief Tridiagonal LU with partial pivoting: "u0", "u1", "u2" are
+ * diagonals of "u", "l" are multipliers, "swapped" marks interchanged rows
+ *
+ */
+template <std::floating_point Type>
+struct TridiagonalLu {
+  std::vector<Type> u0, u1, u2, l;
+  std::vector<bool> swapped;
+};
+
+}  // namespace decompositions
+
+/**
+ * @brief Householder QR decomposition a = q * r of m*n matrix with m >= n.
+ * "q" is kept as blocks of reflections and is never formed. Tall-skinny
+ * matrices are split into row blocks factored in parallel (TSQR), their
+ * stacked "r" factors are factored once more
+ *
+ */
+template <std::floating_point Type>
+class QrDecomposition {
+ public:
+  explicit QrDecomposition(const Matrix<Type>& a, int row_blocks = 0);
+
+  const Matrix<Type>& r() const { return r_; }
+  int row_blocks() const { return static_cast<int>(leaves_.size()); }
+
+  Matrix<Type> ApplyQt(const Matrix<Type>& b) const;
+  Matrix<Type> ApplyQ(const Matrix<Type>& c) const;
+  Matrix<Type> LeastSquares(const Matrix<Type>& b) const;
+
+ private:
+  using Blocks = std::vector<decompositions::HouseholderBlock<Type>>;
+
+  int rows_, cols_;
+  std::vector<int> first_rows_;
+  std::vector<Blocks> leaves_;
+  Blocks root_;
+  Matrix<Type> r_;
+
+  static constexpr int kBlock = 32;
+  static constexpr int kRowsPerThread = 4096;
+};
+
+template <std::floating_point Type>
+EigenDecomposition<Type> SymmetricEigen(const Matrix<Type>& a, int k = 0);
+template <std::floating_point Type>
+SingularDecomposition<Type> ThinSvd(const Matrix<Type>& a, int k = 0);
+template <std::floating_point Type>
+Matrix<Type> LeastSquares(const Matrix<Type>& a, const Matrix<Type>& b);
+
+namespace decompositions {
+
+template <std::floating_point Type>
+std::vector<HouseholderBlock<Type>> Tridiagonalize(
+    Matrix<Type>* a, std::vector<Type>* diagonal,
+    std::vector<Type>* off_diagonal);
+template <std::floating_point Type>
+void TridiagonalQl(std::vector<Type>* diagonal, std::vector<Type>* off_diagonal,
+                   Matrix<Type>* vectors);
+template <std::floating_point Type>
+Matrix<Type> TridiagonalInverseIteration(const std::vector<Type>& diagonal,
+                                         const std::vector<Type>& off_diagonal,
+                                         const std::vector<Type>& values);
+template <std::floating_point Type>
+void FactorShifted(const std::vector<Type>& diagonal,
+                   const std::vector<Type>& off_diagonal, Type shift,
+                   Type tiny, TridiagonalLu<Type>* lu);
+template <std::floating_point Type>
+void SolveFactored(const TridiagonalLu<Type>& lu, Type* x);
+template <std::floating_point Type>
+std::vector<HouseholderBlock<Type>> HouseholderQr(Matrix<Type>* a, int block);
+template <std::floating_point Type>
+Matrix<Type> TriangularFactor(const Matrix<Type>& v,
+                              std::span<const Type> tau);
+template <std::floating_point Type>
+void ApplyBlock(const HouseholderBlock<Type>& block, bool transpose,
+                Matrix<Type>* c);
+template <std::floating_point Type>
+void ApplyHouseholder(const std::vector<HouseholderBlock<Type>>& blocks,
+                      bool transpose, Matrix<Type>* b);
+template <std::floating_point Type>
+void OneSidedJacobi(Matrix<Type>* w, Matrix<Type>* v);
+template <std::floating_point Type>
+Matrix<Type> UpperTriangle(const Matrix<Type>& a);
+
+}  // namespace decompositions
+
+}  // namespace hhullen
+
+#endif  // SRC_DECOMPOSITIONS_H_
@@ -0,0 +1,739 @@
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <future>
+#include <thread>
+
+#include "distributed.h"
+
+namespace hhullen {
+
+/**
+ * @brief Construct a new Communicator object over connected sockets,
+ * "sockets[peer]" is connected to process "peer" and -1 for "rank" itself.
+ * Communicator owns sockets
+ *
+ * @param rank int type rank of this process
+ * @param sockets std::vector<int> type
+ */
+inline Communicator::Communicator(int rank, std::vector<int> sockets)
+    : rank_(rank),
+      size_(static_cast<int>(sockets.size())),
+      sockets_(std::move(sockets)) {
+  if (rank < 0 || rank >= size_) {
+    throw invalid_argument("Rank that is out of communicator size");
+  }
+}
+
+#ifdef MATRIX_WITH_MPI
+/**
+ * @brief Construct a new Communicator object over MPI communicator, which
+ * stays owned by caller
+ *
+ * @param comm MPI_Comm type
+ */
+inline Communicator::Communicator(MPI_Comm comm) : mpi_(comm) {
+  MPI_Comm_rank(comm, &rank_);
+  MPI_Comm_size(comm, &size_);
+}
+#endif
+
+inline Communicator::~Communicator() { Close(); }
+
+inline int Communicator::rank() const { return rank_; }
+
+inline int Communicator::size() const { return size_; }
+
+/**
+ * @brief Sends and receives all buffers and returns when all are done.
+ * Messages to different peers and directions proceed concurrently, so
+ * processes may exchange in any order without deadlock. Messages to one
+ * peer are delivered in order. After a failure communicator is shut down,
+ * so that peers fail as well instead of waiting
+ *
+ * @param sends const std::vector<SendBuffer>& type
+ * @param receives const std::vector<ReceiveBuffer>& type
+ */
+inline void Communicator::Exchange(
+    const std::vector<SendBuffer>& sends,
+    const std::vector<ReceiveBuffer>& receives) const {
+  for (const SendBuffer& send : sends) {
+    CheckPeer(send.peer);
+  }
+  for (const ReceiveBuffer& receive : receives) {
+    CheckPeer(receive.peer);
+  }
+#ifdef MATRIX_WITH_MPI
+  if (mpi_ != MPI_COMM_NULL) {
+    std::vector<MPI_Request> requests;
+    auto post = [&](auto* data, size_t bytes, int peer, auto operation) {
+      for (size_t offset = 0; offset < bytes; offset += kMpiMessageBytes) {
+        requests.emplace_back();
+        operation(data + offset,
+                  static_cast<int>(std::min(kMpiMessageBytes, bytes - offset)),
+                  MPI_BYTE, peer, 0, mpi_, &requests.back());
+      }
+    };
+    for (const ReceiveBuffer& receive : receives) {
+      post(static_cast<char*>(receive.data), receive.bytes, receive.peer,
+           MPI_Irecv);
+    }
+    for (const SendBuffer& send : sends) {
+      post(static_cast<const char*>(send.data), send.bytes, send.peer,
+           MPI_Isend);
+    }
+    MPI_Waitall(static_cast<int>(requests.size()), requests.data(),
+                MPI_STATUSES_IGNORE);
+    return;
+  }
+#endif
+  std::vector<std::function<void()>> streams;
+  for (int peer = 0; peer < size_; ++peer) {
+    const int socket = sockets_[static_cast<size_t>(peer)];
+    if (std::any_of(sends.begin(), sends.end(),
+                    [peer](const SendBuffer& send) {
+                      return send.peer == peer;
+                    })) {
+      streams.push_back([&sends, peer, socket] {
+        for (const SendBuffer& send : sends) {
+          if (send.peer == peer) {
+            SendAll(socket, static_cast<const char*>(send.data), send.bytes);
+          }
+        }
+      });
+    }
+    if (std::any_of(receives.begin(), receives.end(),
+                    [peer](const ReceiveBuffer& receive) {
+                      return receive.peer == peer;
+                    })) {
+      streams.push_back([&receives, peer, socket] {
+        for (const ReceiveBuffer& receive : receives) {
+          if (receive.peer == peer) {
+            ReceiveAll(socket, static_cast<char*>(receive.data),
+                       receive.bytes);
+          }
+        }
+      });
+    }
+  }
+
+  std::vector<std::exception_ptr> errors(streams.size());
+  auto run = [this, &streams, &errors](size_t i) {
+    try {
+      streams[i]();
+    } catch (...) {
+      errors[i] = std::current_exception();
+      Shutdown();
+    }
+  };
+  if (streams.size() == 1) {
+    run(0);
+  } else {
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < streams.size(); ++i) {
+      workers.emplace_back(run, i);
+    }
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
+  }
+  for (const std::exception_ptr& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+/**
+ * @brief Returns when all processes have called Barrier
+ *
+ */
+inline void Communicator::Barrier() const {
+#ifdef MATRIX_WITH_MPI
+  if (mpi_ != MPI_COMM_NULL) {
+    MPI_Barrier(mpi_);
+    return;
+  }
+#endif
+  const char token = 0;
+  std::vector<char> tokens(static_cast<size_t>(size_));
+  std::vector<SendBuffer> sends;
+  std::vector<ReceiveBuffer> receives;
+  for (int peer = 0; peer < size_; ++peer) {
+    if (peer != rank_) {
+      sends.push_back({peer, &token, 1});
+      receives.push_back({peer, &tokens[static_cast<size_t>(peer)], 1});
+    }
+  }
+  Exchange(sends, receives);
+}
+
+/**
+ * @brief Closes sockets, peers waiting for messages from this process fail
+ *
+ */
+inline void Communicator::Close() {
+  for (int& socket : sockets_) {
+    if (socket >= 0) {
+      close(socket);
+      socket = -1;
+    }
+  }
+}
+
+inline void Communicator::CheckPeer(int peer) const {
+  if (peer < 0 || peer >= size_ || peer == rank_) {
+    throw invalid_argument("Message to process that is not a peer");
+  }
+}
+
+inline void Communicator::Shutdown() const {
+  for (int socket : sockets_) {
+    if (socket >= 0) {
+      shutdown(socket, SHUT_RDWR);
+    }
+  }
+}
+
+inline void Communicator::SendAll(int socket, const char* data,
+                                  size_t bytes) {
+#ifdef MSG_NOSIGNAL
+  const int flags = MSG_NOSIGNAL;
+#else
+  const int flags = 0;
+#endif
+  while (bytes > 0) {
+    const ssize_t sent = send(socket, data, bytes, flags);
+    if (sent < 0 && errno == EINTR) {
+      continue;
+    }
+    if (sent <= 0) {
+      throw std::runtime_error("Message could not be sent");
+    }
+    data += sent;
+    bytes -= static_cast<size_t>(sent);
+  }
+}
+
+inline void Communicator::ReceiveAll(int socket, char* data, size_t bytes) {
+  while (bytes > 0) {
+    const ssize_t received = recv(socket, data, bytes, 0);
+    if (received < 0 && errno == EINTR) {
+      continue;
+    }
+    if (received <= 0) {
+      throw std::runtime_error("Peer process closed connection");
+    }
+    data += received;
+    bytes -= static_cast<size_t>(received);
+  }
+}
+
+/**
+ * @brief Runs "body" in "count" processes connected by Unix sockets: rank 0
+ * in calling process, others in forked children. Returns when all have
+ * finished. Exception of rank 0 is rethrown, failure of any child throws
+ * std::runtime_error
+ *
+ * @param count int type amount of processes
+ * @param body const std::function<void(Communicator&)>& type
+ */
+inline void RunProcesses(int count,
+                         const std::function<void(Communicator&)>& body) {
+  if (count < 1) {
+    throw invalid_argument("Running less than 1 process");
+  }
+  const size_t size = static_cast<size_t>(count);
+  std::vector<std::vector<int>> sockets(size, std::vector<int>(size, -1));
+  auto close_except = [&sockets, size](size_t rank) {
+    for (size_t i = 0; i < size; ++i) {
+      for (size_t j = 0; j < size; ++j) {
+        if (i != rank && sockets[i][j] >= 0) {
+          close(sockets[i][j]);
+        }
+      }
+    }
+  };
+  for (size_t i = 0; i < size; ++i) {
+    for (size_t j = i + 1; j < size; ++j) {
+      int pair[2];
+      if (socketpair(AF_UNIX, SOCK_STREAM, 0, pair) != 0) {
+        close_except(size);
+        throw std::runtime_error("Sockets could not be created");
+      }
+#ifdef SO_NOSIGPIPE
+      const int enable = 1;
+      setsockopt(pair[0], SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+      setsockopt(pair[1], SOL_SOCKET, SO_NOSIGPIPE, &enable, sizeof(enable));
+#endif
+      sockets[i][j] = pair[0];
+      sockets[j][i] = pair[1];
+    }
+  }
+
+  std::vector<pid_t> children;
+  bool is_forked = true;
+  for (size_t rank = 1; rank < size && is_forked; ++rank) {
+    const pid_t child = fork();
+    if (child == 0) {
+      close_except(rank);
+      int status = 0;
+      try {
+        Communicator comm(static_cast<int>(rank), sockets[rank]);
+        body(comm);
+      } catch (...) {
+        status = 1;
+      }
+      _exit(status);
+    }
+    is_forked = child > 0;
+    if (is_forked) {
+      children.push_back(child);
+    }
+  }
+
+  close_except(0);
+  std::exception_ptr error;
+  {
+    Communicator comm(0, sockets[0]);
+    if (!is_forked) {
+      error = std::make_exception_ptr(
+          std::runtime_error("Process could not be started"));
+    } else {
+      try {
+        body(comm);
+      } catch (...) {
+        error = std::current_exception();
+      }
+    }
+  }
+  bool is_failed = false;
+  for (pid_t child : children) {
+    int status = 0;
+    while (waitpid(child, &status, 0) < 0 && errno == EINTR) {
+    }
+    is_failed = is_failed || !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+  if (is_failed) {
+    throw std::runtime_error("Distributed process failed");
+  }
+}
+
+/**
+ * @brief Construct a new DistributedMatrix object filled with zeros. Process
+ * grid is the closest to square one for size of communicator
+ *
+ * @param comm const Communicator& type
+ * @param rows int type
+ * @param cols int type
+ * @param block int type size of square distribution block
+ */
+template <arithmetic Type>
+DistributedMatrix<Type>::DistributedMatrix(const Communicator& comm, int rows,
+                                           int cols, int block)
+    : comm_(&comm), rows_(rows), cols_(cols), block_(block) {
+  if (rows < 1 || cols < 1) {
+    throw invalid_argument("Creation matrix with less than 1x1 size");
+  }
+  if (block < 1) {
+    throw invalid_argument("Distribution block with less than 1x1 size");
+  }
+  ProcessGrid(comm.size(), &grid_rows_, &grid_cols_);
+  grid_row_ = comm.rank() / grid_cols_;
+  grid_col_ = comm.rank() % grid_cols_;
+  local_rows_ = LocalExtent(rows, block, grid_rows_, grid_row_);
+  local_cols_ = LocalExtent(cols, block, grid_cols_, grid_col_);
+  if (local_rows_ > 0 && local_cols_ > 0) {
+    local_ = Matrix<Type>(local_rows_, local_cols_);
+  }
+}
+
+/**
+ * @brief Construct a new DistributedMatrix object, each process computes
+ * its own elements by element(global_row, global_col)
+ *
+ * @param element const std::function<Type(int, int)>& type
+ */
+template <arithmetic Type>
+DistributedMatrix<Type>::DistributedMatrix(
+    const Communicator& comm, int rows, int cols, int block,
+    const std::function<Type(int, int)>& element)
+    : DistributedMatrix(comm, rows, cols, block) {
+  for (int i = 0; i < local_rows_; ++i) {
+    Type* target = local_.row(i).data();
+    for (int j = 0; j < local_cols_; ++j) {
+      target[j] = element(GlobalRow(i), GlobalCol(j));
+    }
+  }
+}
+
+/**
+ * @brief Construct a new DistributedMatrix object from matrix available in
+ * every process, each process keeps only its blocks
+ *
+ * @param global const Matrix& type
+ */
+template <arithmetic Type>
+DistributedMatrix<Type>::DistributedMatrix(const Communicator& comm,
+                                           const Matrix<Type>& global,
+                                           int block)
+    : DistributedMatrix(comm, global.rows(), global.cols(), block) {
+  for (int i = 0; i < local_rows_; ++i) {
+    const Type* source = global.row(GlobalRow(i)).data();
+    for (int j = 0; j < local_cols_; j += block_) {
+      std::copy(source + GlobalCol(j),
+                source + GlobalCol(j) + std::min(block_, local_cols_ - j),
+                local_.row(i).data() + j);
+    }
+  }
+}
+
+/**
+ * @brief Collects whole matrix in process "root", other processes get
+ * default matrix
+ *
+ * @param root int type
+ * @return Matrix
+ */
+template <arithmetic Type>
+Matrix<Type> DistributedMatrix<Type>::Gather(int root) const {
+  if (comm_->rank() != root) {
+    std::vector<SendBuffer> sends;
+    if (local_rows_ > 0 && local_cols_ > 0) {
+      sends.push_back({root, local_.data(),
+                       local_.size() * sizeof(Type)});
+    }
+    comm_->Exchange(sends, {});
+    return Matrix<Type>();
+  }
+
+  std::vector<DistributedMatrix> parts;
+  std::vector<ReceiveBuffer> receives;
+  parts.reserve(static_cast<size_t>(comm_->size()));
+  for (int rank = 0; rank < comm_->size(); ++rank) {
+    parts.emplace_back(*this);
+    DistributedMatrix& part = parts.back();
+    part.grid_row_ = rank / grid_cols_;
+    part.grid_col_ = rank % grid_cols_;
+    part.local_rows_ = LocalExtent(rows_, block_, grid_rows_, part.grid_row_);
+    part.local_cols_ = LocalExtent(cols_, block_, grid_cols_, part.grid_col_);
+    if (rank != root && part.local_rows_ > 0 && part.local_cols_ > 0) {
+      part.local_ = Matrix<Type>(part.local_rows_, part.local_cols_);
+      receives.push_back(
+          {rank, part.local_.data(), part.local_.size() * sizeof(Type)});
+    }
+  }
+  comm_->Exchange({}, receives);
+
+  Matrix<Type> returnable(rows_, cols_);
+  for (const DistributedMatrix& part : parts) {
+    for (int i = 0; i < part.local_rows_; ++i) {
+      const Type* source = part.local_.row(i).data();
+      Type* target = returnable.row(part.GlobalRow(i)).data();
+      for (int j = 0; j < part.local_cols_; j += block_) {
+        std::copy(source + j,
+                  source + j + std::min(block_, part.local_cols_ - j),
+                  target + part.GlobalCol(j));
+      }
+    }
+  }
+
+  return returnable;
+}
+
+template <arithmetic Type>
+int DistributedMatrix<Type>::rows() const {
+  return rows_;
+}
+
+template <arithmetic Type>
+int DistributedMatrix<Type>::cols() const {
+  return cols_;
+}
+
+template <arithmetic Type>
+int DistributedMatrix<Type>::block() const {
+  return block_;
+}
+
+template <arithmetic Type>
+int DistributedMatrix<Type>::grid_rows() const {
+  return grid_rows_;
+}
+
+template <arithmetic Type>
+int DistributedMatrix<Type>::grid_cols() const {
+  return grid_cols_;
+}
+
+template <arithmetic Type>
+int DistributedMatrix<Type>::local_rows() const {
+  return local_rows_;
+}
+
+template <arithmetic Type>
+int DistributedMatrix<Type>::local_cols() const {
+  return local_cols_;
+}
+
+/**
+ * @brief Returns local blocks of this process as one row-major matrix, it
+ * is meaningful only when local_rows() and local_cols() are positive
+ *
+ * @return const Matrix&
+ */
+template <arithmetic Type>
+const Matrix<Type>& DistributedMatrix<Type>::local() const {
+  return local_;
+}
+
+/**
+ * @brief Returns global index of local row
+ *
+ * @param local_row int type
+ * @return int
+ */
+template <arithmetic Type>
+int DistributedMatrix<Type>::GlobalRow(int local_row) const {
+  return (local_row / block_ * grid_rows_ + grid_row_) * block_ +
+         local_row % block_;
+}
+
+template <arithmetic Type>
+int DistributedMatrix<Type>::GlobalCol(int local_col) const {
+  return (local_col / block_ * grid_cols_ + grid_col_) * block_ +
+         local_col % block_;
+}
+
+/**
+ * @brief SUMMA multiplication. On step k block column k of this matrix is
+ * broadcast along process rows and block row k of "other" along process
+ * columns, then each process adds their product to its local result by
+ * Matrix::Gemm. Panels of step k+1 are transferred while step k is
+ * multiplied
+ *
+ * @param other const DistributedMatrix& type
+ * @return DistributedMatrix
+ */
+template <arithmetic Type>
+DistributedMatrix<Type> DistributedMatrix<Type>::operator*(
+    const DistributedMatrix& other) const {
+  if (cols_ != other.rows_) {
+    throw invalid_argument(
+        "Multiplication matrix with different cols and rows");
+  }
+  if (comm_ != other.comm_ || block_ != other.block_) {
+    throw invalid_argument(
+        "Multiplication of matrices with different distribution");
+  }
+  DistributedMatrix returnable(*comm_, rows_, other.cols_, block_);
+  const int steps = (cols_ + block_ - 1) / block_;
+  const bool has_result =
+      returnable.local_rows_ > 0 && returnable.local_cols_ > 0;
+
+  std::future<Panels> next = std::async(std::launch::async, [&] {
+    return FetchPanels(other, 0);
+  });
+  for (int step = 0; step < steps; ++step) {
+    const Panels panels = next.get();
+    if (step + 1 < steps) {
+      next = std::async(std::launch::async, [&, step] {
+        return FetchPanels(other, step + 1);
+      });
+    }
+    if (has_result) {
+      Matrix<Type>::Gemm(1, panels.first, false, panels.second, false, 1,
+                         &returnable.local_);
+    }
+  }
+
+  return returnable;
+}
+
+/**
+ * @brief Distributed transpose. Each process transposes its blocks and
+ * sends every block to the owner of its transposed position, all blocks
+ * for one peer in one message
+ *
+ * @return DistributedMatrix
+ */
+template <arithmetic Type>
+DistributedMatrix<Type> DistributedMatrix<Type>::Transpose() const {
+  DistributedMatrix returnable(*comm_, cols_, rows_, block_);
+  const int rank = comm_->rank();
+  const size_t size = static_cast<size_t>(comm_->size());
+  std::vector<std::vector<Type>> outgoing(size), incoming(size);
+  const int block_rows = (rows_ + block_ - 1) / block_;
+  const int block_cols = (cols_ + block_ - 1) / block_;
+
+  auto for_each_block = [&](auto body) {
+    for (int bi = 0; bi < block_rows; ++bi) {
+      for (int bj = 0; bj < block_cols; ++bj) {
+        body(bi, bj, std::min(block_, rows_ - bi * block_),
+             std::min(block_, cols_ - bj * block_), Owner(bi, bj),
+             returnable.Owner(bj, bi));
+      }
+    }
+  };
+  auto target_of = [&](int bi, int bj) {
+    return returnable.local_.row(bj / grid_rows_ * block_).data() +
+           bi / grid_cols_ * block_;
+  };
+
+  for_each_block([&](int bi, int bj, int h, int w, int source, int target) {
+    if (source != rank) {
+      if (target == rank) {
+        incoming[static_cast<size_t>(source)].resize(
+            incoming[static_cast<size_t>(source)].size() +
+            static_cast<size_t>(h) * static_cast<size_t>(w));
+      }
+      return;
+    }
+    const size_t stride = static_cast<size_t>(local_cols_);
+    const Type* block =
+        local_.row(bi / grid_rows_ * block_).data() + bj / grid_cols_ * block_;
+    std::vector<Type>& packed = outgoing[static_cast<size_t>(target)];
+    const size_t first = packed.size();
+    packed.resize(first + static_cast<size_t>(h) * static_cast<size_t>(w));
+    for (size_t c = 0; c < static_cast<size_t>(w); ++c) {
+      for (size_t r = 0; r < static_cast<size_t>(h); ++r) {
+        packed[first + c * static_cast<size_t>(h) + r] = block[r * stride + c];
+      }
+    }
+  });
+
+  std::vector<SendBuffer> sends;
+  std::vector<ReceiveBuffer> receives;
+  for (int peer = 0; peer < static_cast<int>(size); ++peer) {
+    const size_t index = static_cast<size_t>(peer);
+    if (peer != rank && !outgoing[index].empty()) {
+      sends.push_back({peer, outgoing[index].data(),
+                       outgoing[index].size() * sizeof(Type)});
+    }
+    if (peer != rank && !incoming[index].empty()) {
+      receives.push_back({peer, incoming[index].data(),
+                          incoming[index].size() * sizeof(Type)});
+    }
+  }
+  comm_->Exchange(sends, receives);
+
+  incoming[static_cast<size_t>(rank)].swap(outgoing[static_cast<size_t>(rank)]);
+  std::vector<size_t> cursors(size);
+  const size_t stride = static_cast<size_t>(returnable.local_cols_);
+  for_each_block([&](int bi, int bj, int h, int w, int source, int target) {
+    if (target != rank) {
+      return;
+    }
+    const Type* packed = incoming[static_cast<size_t>(source)].data() +
+                         cursors[static_cast<size_t>(source)];
+    Type* block = target_of(bi, bj);
+    for (size_t c = 0; c < static_cast<size_t>(w); ++c) {
+      std::copy(packed + c * static_cast<size_t>(h),
+                packed + (c + 1) * static_cast<size_t>(h),
+                block + c * stride);
+    }
+    cursors[static_cast<size_t>(source)] +=
+        static_cast<size_t>(h) * static_cast<size_t>(w);
+  });
+
+  return returnable;
+}
+
+/**
+ * @brief Chooses process grid rows*cols == size with rows <= cols as close
+ * to square as possible
+ *
+ */
+template <arithmetic Type>
+void DistributedMatrix<Type>::ProcessGrid(int size, int* rows, int* cols) {
+  *rows = 1;
+  for (int divisor = 1; divisor * divisor <= size; ++divisor) {
+    if (size % divisor == 0) {
+      *rows = divisor;
+    }
+  }
+  *cols = size / *rows;
+}
+
+/**
+ * @brief Returns amount of elements of "global" extent kept by process
+ * "index" of "processes" along one dimension
+ *
+ */
+template <arithmetic Type>
+int DistributedMatrix<Type>::LocalExtent(int global, int block, int processes,
+                                         int index) {
+  int returnable = 0;
+  for (long start = static_cast<long>(index) * block; start < global;
+       start += static_cast<long>(processes) * block) {
+    returnable += std::min(block, global - static_cast<int>(start));
+  }
+  return returnable;
+}
+
+template <arithmetic Type>
+int DistributedMatrix<Type>::Owner(int block_row, int block_col) const {
+  return block_row % grid_rows_ * grid_cols_ + block_col % grid_cols_;
+}
+
+/**
+ * @brief Returns panels of SUMMA "step": local rows of block column "step"
+ * of this matrix and local cols of block row "step" of "other". Owners copy
+ * them from local blocks and send them, others receive
+ *
+ */
+template <arithmetic Type>
+typename DistributedMatrix<Type>::Panels DistributedMatrix<Type>::FetchPanels(
+    const DistributedMatrix& other, int step) const {
+  const int width = std::min(block_, cols_ - step * block_);
+  const int owner_col = step % grid_cols_, owner_row = step % grid_rows_;
+  const bool has_a = local_rows_ > 0, has_b = other.local_cols_ > 0;
+  Panels panels{Matrix<Type>(has_a ? local_rows_ : 1, width),
+                Matrix<Type>(width, has_b ? other.local_cols_ : 1)};
+  std::vector<SendBuffer> sends;
+  std::vector<ReceiveBuffer> receives;
+  const size_t a_bytes = panels.first.size() * sizeof(Type);
+  const size_t b_bytes = panels.second.size() * sizeof(Type);
+
+  if (has_a && grid_col_ == owner_col) {
+    const int first = step / grid_cols_ * block_;
+    for (int i = 0; i < local_rows_; ++i) {
+      const Type* source = local_.row(i).data() + first;
+      std::copy(source, source + width, panels.first.row(i).data());
+    }
+    for (int col = 0; col < grid_cols_; ++col) {
+      if (col != grid_col_) {
+        sends.push_back(
+            {grid_row_ * grid_cols_ + col, panels.first.data(), a_bytes});
+      }
+    }
+  } else if (has_a) {
+    receives.push_back(
+        {grid_row_ * grid_cols_ + owner_col, panels.first.data(), a_bytes});
+  }
+
+  if (has_b && grid_row_ == owner_row) {
+    const Type* source =
+        other.local_.row(step / grid_rows_ * block_).data();
+    std::copy(source, source + panels.second.size(), panels.second.data());
+    for (int row = 0; row < grid_rows_; ++row) {
+      if (row != grid_row_) {
+        sends.push_back(
+            {row * grid_cols_ + grid_col_, panels.second.data(), b_bytes});
+      }
+    }
+  } else if (has_b) {
+    receives.push_back(
+        {owner_row * grid_cols_ + grid_col_, panels.second.data(), b_bytes});
+  }
+  comm_->Exchange(sends, receives);
+
+  return panels;
+}
+
+}  // namespace hhullen
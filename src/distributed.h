@@ -0,0 +1,126 @@
+#ifndef SRC_DISTRIBUTED_H_
+#define SRC_DISTRIBUTED_H_
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#ifdef MATRIX_WITH_MPI
+#include <mpi.h>
+#endif
+
+#include "matrix.h"
+
+namespace hhullen {
+
+/**
+ * @brief Outgoing and incoming point-to-point messages of Exchange
+ *
+ */
+struct SendBuffer {
+  int peer = 0;
+  const void* data = nullptr;
+  size_t bytes = 0;
+};
+
+struct ReceiveBuffer {
+  int peer = 0;
+  void* data = nullptr;
+  size_t bytes = 0;
+};
+
+/**
+ * @brief Group of processes exchanging messages. Local transport is a full
+ * mesh of Unix sockets between processes started by RunProcesses, MPI
+ * transport (built with MATRIX_WITH_MPI) wraps MPI communicator initialized
+ * with at least MPI_THREAD_SERIALIZED. Messages between two processes are
+ * delivered in order of Exchange calls
+ *
+ */
+class Communicator {
+ public:
+  Communicator(int rank, std::vector<int> sockets);
+#ifdef MATRIX_WITH_MPI
+  explicit Communicator(MPI_Comm comm);
+#endif
+  Communicator(const Communicator& other) = delete;
+  Communicator& operator=(const Communicator& other) = delete;
+  ~Communicator();
+
+  int rank() const;
+  int size() const;
+  void Exchange(const std::vector<SendBuffer>& sends,
+                const std::vector<ReceiveBuffer>& receives) const;
+  void Barrier() const;
+  void Close();
+
+ private:
+  int rank_ = 0, size_ = 1;
+  std::vector<int> sockets_;
+#ifdef MATRIX_WITH_MPI
+  MPI_Comm mpi_ = MPI_COMM_NULL;
+  static constexpr size_t kMpiMessageBytes = 1 << 30;
+#endif
+
+  void CheckPeer(int peer) const;
+  void Shutdown() const;
+  static void SendAll(int socket, const char* data, size_t bytes);
+  static void ReceiveAll(int socket, char* data, size_t bytes);
+};
+
+inline void RunProcesses(int count,
+                         const std::function<void(Communicator&)>& body);
+
+/**
+ * @brief Matrix distributed 2D block-cyclically over a process grid: block
+ * (bi, bj) of "block"*"block" elements belongs to process of grid row
+ * bi % grid_rows and grid col bj % grid_cols. Each process keeps its blocks
+ * in one local row-major matrix. All processes of communicator have to
+ * call constructors and operations in the same order
+ *
+ */
+template <arithmetic Type>
+class DistributedMatrix {
+ public:
+  DistributedMatrix(const Communicator& comm, int rows, int cols,
+                    int block = 64);
+  DistributedMatrix(const Communicator& comm, int rows, int cols, int block,
+                    const std::function<Type(int, int)>& element);
+  DistributedMatrix(const Communicator& comm, const Matrix<Type>& global,
+                    int block = 64);
+
+  Matrix<Type> Gather(int root = 0) const;
+
+  int rows() const;
+  int cols() const;
+  int block() const;
+  int grid_rows() const;
+  int grid_cols() const;
+  int local_rows() const;
+  int local_cols() const;
+  const Matrix<Type>& local() const;
+  int GlobalRow(int local_row) const;
+  int GlobalCol(int local_col) const;
+
+  DistributedMatrix operator*(const DistributedMatrix& other) const;
+  DistributedMatrix Transpose() const;
+
+ private:
+  using Panels = std::pair<Matrix<Type>, Matrix<Type>>;
+
+  const Communicator* comm_;
+  int rows_ = 0, cols_ = 0, block_ = 0;
+  int grid_rows_ = 1, grid_cols_ = 1, grid_row_ = 0, grid_col_ = 0;
+  int local_rows_ = 0, local_cols_ = 0;
+  Matrix<Type> local_;
+
+  static void ProcessGrid(int size, int* rows, int* cols);
+  static int LocalExtent(int global, int block, int processes, int index);
+  int Owner(int block_row, int block_col) const;
+  Panels FetchPanels(const DistributedMatrix& other, int step) const;
+};
+
+}  // namespace hhullen
+
+#endif  // SRC_DISTRIBUTED_H_
@@ -0,0 +1,398 @@
+#include "iterative.h"
+
+namespace hhullen {
+
+/**
+ * @brief Construct a new MatrixOperator object, the matrix is shared by
+ * copy-on-write
+ *
+ * @param a const Matrix& type square matrix
+ */
+template <std::floating_point Type>
+MatrixOperator<Type>::MatrixOperator(const Matrix<Type>& a) : a_(a) {
+  if (a.rows() != a.cols()) {
+    throw invalid_argument("Linear operator of not square matrix");
+  }
+}
+
+template <std::floating_point Type>
+int MatrixOperator<Type>::rows() const {
+  return a_.rows();
+}
+
+template <std::floating_point Type>
+void MatrixOperator<Type>::Apply(std::span<const Type> x,
+                                 std::span<Type> y) const {
+  Matrix<Type>::Gemv(1, a_, false, x, 0, y);
+}
+
+template <std::floating_point Type>
+void IdentityPreconditioner<Type>::Apply(std::span<const Type> r,
+                                         std::span<Type> z) const {
+  std::copy(r.begin(), r.end(), z.begin());
+}
+
+/**
+ * @brief Construct a new JacobiPreconditioner object from diagonal of
+ * square matrix
+ *
+ * @param a const Matrix& type
+ */
+template <std::floating_point Type>
+JacobiPreconditioner<Type>::JacobiPreconditioner(const Matrix<Type>& a)
+    : JacobiPreconditioner(std::span<const Type>(Diagonal(a))) {}
+
+/**
+ * @brief Construct a new JacobiPreconditioner object from diagonal of
+ * matrix-free operator
+ *
+ * @param diagonal std::span<const Type> type
+ */
+template <std::floating_point Type>
+JacobiPreconditioner<Type>::JacobiPreconditioner(
+    std::span<const Type> diagonal) {
+  inverse_.resize(diagonal.size());
+  for (size_t i = 0; i < diagonal.size(); ++i) {
+    if (diagonal[i] == 0) {
+      throw invalid_argument("Jacobi preconditioner with zero diagonal");
+    }
+    inverse_[i] = 1 / diagonal[i];
+  }
+}
+
+template <std::floating_point Type>
+std::vector<Type> JacobiPreconditioner<Type>::Diagonal(
+    const Matrix<Type>& a) {
+  if (a.rows() != a.cols()) {
+    throw invalid_argument("Preconditioner of not square matrix");
+  }
+  std::vector<Type> returnable(static_cast<size_t>(a.rows()));
+  for (int i = 0; i < a.rows(); ++i) {
+    returnable[static_cast<size_t>(i)] = a(i, i);
+  }
+
+  return returnable;
+}
+
+template <std::floating_point Type>
+void JacobiPreconditioner<Type>::Apply(std::span<const Type> r,
+                                       std::span<Type> z) const {
+  for (size_t i = 0; i < r.size(); ++i) {
+    z[i] = r[i] * inverse_[i];
+  }
+}
+
+/**
+ * @brief Construct a new IluPreconditioner object. Nonzero elements of "a"
+ * are packed by rows and factored in place by IKJ variant of Gaussian
+ * elimination restricted to their positions
+ *
+ * @param a const Matrix& type square matrix with nonzero diagonal
+ */
+template <std::floating_point Type>
+IluPreconditioner<Type>::IluPreconditioner(const Matrix<Type>& a) {
+  if (a.rows() != a.cols()) {
+    throw invalid_argument("Preconditioner of not square matrix");
+  }
+  const size_t n = static_cast<size_t>(a.rows());
+  row_starts_.assign(1, 0);
+  for (int i = 0; i < a.rows(); ++i) {
+    std::span<const Type> row = a.row(i);
+    for (size_t j = 0; j < n; ++j) {
+      if (row[j] != 0 || j == static_cast<size_t>(i)) {
+        columns_.push_back(static_cast<int>(j));
+        values_.push_back(row[j]);
+      }
+    }
+    row_starts_.push_back(columns_.size());
+  }
+
+  diagonal_.resize(n);
+  std::vector<size_t> position(n, values_.size());
+  for (size_t i = 0; i < n; ++i) {
+    const size_t first = row_starts_[i], last = row_starts_[i + 1];
+    for (size_t p = first; p < last; ++p) {
+      position[static_cast<size_t>(columns_[p])] = p;
+    }
+    size_t p = first;
+    for (; static_cast<size_t>(columns_[p]) < i; ++p) {
+      const size_t k = static_cast<size_t>(columns_[p]);
+      values_[p] /= values_[diagonal_[k]];
+      for (size_t q = diagonal_[k] + 1; q < row_starts_[k + 1]; ++q) {
+        const size_t target = position[static_cast<size_t>(columns_[q])];
+        if (target != values_.size()) {
+          values_[target] -= values_[p] * values_[q];
+        }
+      }
+    }
+    if (values_[p] == 0) {
+      throw invalid_argument("ILU preconditioner with zero pivot");
+    }
+    diagonal_[i] = p;
+    for (size_t q = first; q < last; ++q) {
+      position[static_cast<size_t>(columns_[q])] = values_.size();
+    }
+  }
+}
+
+/**
+ * @brief Solves L * U * z = r by forward and backward substitution over
+ * stored elements
+ *
+ */
+template <std::floating_point Type>
+void IluPreconditioner<Type>::Apply(std::span<const Type> r,
+                                    std::span<Type> z) const {
+  const size_t n = diagonal_.size();
+  for (size_t i = 0; i < n; ++i) {
+    Type sum = r[i];
+    for (size_t p = row_starts_[i]; p < diagonal_[i]; ++p) {
+      sum -= values_[p] * z[static_cast<size_t>(columns_[p])];
+    }
+    z[i] = sum;
+  }
+  for (size_t i = n; i-- > 0;) {
+    Type sum = z[i];
+    for (size_t p = diagonal_[i] + 1; p < row_starts_[i + 1]; ++p) {
+      sum -= values_[p] * z[static_cast<size_t>(columns_[p])];
+    }
+    z[i] = sum / values_[diagonal_[i]];
+  }
+}
+
+/**
+ * @brief Preconditioned conjugate gradient method for symmetric positive
+ * definite operators. Work vectors are allocated before iterations, updates
+ * of solution and residual are fused with residual norm in one pass
+ *
+ * @param a const Operator& type
+ * @param b std::span<const Type> type right side
+ * @param x std::span<Type> type initial guess, replaced by solution
+ * @param options const SolverOptions& type
+ * @param preconditioner const Preconditioner& type symmetric positive
+ * definite
+ * @return SolverReport
+ */
+template <LinearOperator Operator, class Preconditioner>
+  requires PreconditionerFor<Preconditioner, typename Operator::value_type>
+SolverReport ConjugateGradient(
+    const Operator& a, std::span<const typename Operator::value_type> b,
+    std::span<typename Operator::value_type> x, const SolverOptions& options,
+    const Preconditioner& preconditioner) {
+  using Type = typename Operator::value_type;
+  const size_t n = static_cast<size_t>(a.rows());
+  if (b.size() != n || x.size() != n) {
+    throw invalid_argument("Iterative solving with vector of different size");
+  }
+  SolverReport report;
+  report.history.reserve(
+      static_cast<size_t>(std::max(0, options.max_iterations)));
+  std::vector<Type> r(n), z(n), p(n), q(n);
+  const double b_norm =
+      std::sqrt(static_cast<double>(iterative::Dot<Type>(b, b)));
+  if (b_norm == 0) {
+    std::fill(x.begin(), x.end(), Type(0));
+    report.converged = true;
+    return report;
+  }
+
+  a.Apply(x, r);
+  for (size_t i = 0; i < n; ++i) {
+    r[i] = b[i] - r[i];
+  }
+  preconditioner.Apply(r, z);
+  std::copy(z.begin(), z.end(), p.begin());
+  Type rz = iterative::Dot<Type>(r, z);
+  report.residual =
+      std::sqrt(static_cast<double>(iterative::Dot<Type>(r, r))) / b_norm;
+  report.converged = report.residual <= options.tolerance;
+
+  while (!report.converged && report.iterations < options.max_iterations) {
+    a.Apply(p, q);
+    const Type pq = iterative::Dot<Type>(p, q);
+    if (pq <= 0) {
+      break;
+    }
+    const Type alpha = rz / pq;
+    Type rr = 0;
+    for (size_t i = 0; i < n; ++i) {
+      x[i] += alpha * p[i];
+      r[i] -= alpha * q[i];
+      rr += r[i] * r[i];
+    }
+    if (iterative::Report(std::sqrt(static_cast<double>(rr)) / b_norm,
+                          options, &report)) {
+      break;
+    }
+    preconditioner.Apply(r, z);
+    const Type rz_next = iterative::Dot<Type>(r, z);
+    const Type beta = rz_next / rz;
+    rz = rz_next;
+    for (size_t i = 0; i < n; ++i) {
+      p[i] = z[i] + beta * p[i];
+    }
+  }
+
+  return report;
+}
+
+/**
+ * @brief Restarted GMRES(m) with right preconditioning for general
+ * nonsingular operators, so the reported residual is the true one. Krylov
+ * basis is orthogonalized by modified Gram-Schmidt, Hessenberg matrix is
+ * reduced by Givens rotations as it grows. Basis and work vectors of
+ * "options.restart" size are allocated before iterations
+ *
+ * @param a const Operator& type
+ * @param b std::span<const Type> type right side
+ * @param x std::span<Type> type initial guess, replaced by solution
+ * @param options const SolverOptions& type
+ * @param preconditioner const Preconditioner& type
+ * @return SolverReport
+ */
+template <LinearOperator Operator, class Preconditioner>
+  requires PreconditionerFor<Preconditioner, typename Operator::value_type>
+SolverReport Gmres(const Operator& a,
+                   std::span<const typename Operator::value_type> b,
+                   std::span<typename Operator::value_type> x,
+                   const SolverOptions& options,
+                   const Preconditioner& preconditioner) {
+  using Type = typename Operator::value_type;
+  const size_t n = static_cast<size_t>(a.rows());
+  if (b.size() != n || x.size() != n) {
+    throw invalid_argument("Iterative solving with vector of different size");
+  }
+  if (options.restart < 1) {
+    throw invalid_argument("GMRES with restart less than 1");
+  }
+  const size_t m = static_cast<size_t>(options.restart);
+  SolverReport report;
+  report.history.reserve(
+      static_cast<size_t>(std::max(0, options.max_iterations)));
+  std::vector<Type> basis((m + 1) * n), hessenberg((m + 1) * m);
+  std::vector<Type> cosines(m), sines(m), g(m + 1), w(n), z(n);
+  const double b_norm =
+      std::sqrt(static_cast<double>(iterative::Dot<Type>(b, b)));
+  if (b_norm == 0) {
+    std::fill(x.begin(), x.end(), Type(0));
+    report.converged = true;
+    return report;
+  }
+  auto v = [&](size_t k) { return std::span<Type>(basis).subspan(k * n, n); };
+  auto h = [&](size_t i, size_t j) -> Type& { return hessenberg[i * m + j]; };
+
+  while (true) {
+    std::span<Type> r = v(0);
+    a.Apply(x, r);
+    Type beta = 0;
+    for (size_t i = 0; i < n; ++i) {
+      r[i] = b[i] - r[i];
+      beta += r[i] * r[i];
+    }
+    beta = std::sqrt(beta);
+    report.residual = static_cast<double>(beta) / b_norm;
+    report.converged = report.residual <= options.tolerance;
+    if (report.converged || report.iterations >= options.max_iterations) {
+      break;
+    }
+    for (Type& value : r) {
+      value /= beta;
+    }
+    std::fill(g.begin(), g.end(), Type(0));
+    g[0] = beta;
+
+    size_t size = 0;
+    bool stop = false;
+    while (size < m && !stop) {
+      const size_t j = size++;
+      preconditioner.Apply(v(j), z);
+      a.Apply(z, w);
+      for (size_t i = 0; i <= j; ++i) {
+        std::span<const Type> basis_i = v(i);
+        const Type projection = iterative::Dot<Type>(w, basis_i);
+        h(i, j) = projection;
+        for (size_t k = 0; k < n; ++k) {
+          w[k] -= projection * basis_i[k];
+        }
+      }
+      const Type norm = std::sqrt(iterative::Dot<Type>(w, w));
+      std::span<Type> next = v(j + 1);
+      for (size_t k = 0; k < n; ++k) {
+        next[k] = norm == 0 ? Type(0) : w[k] / norm;
+      }
+
+      for (size_t i = 0; i < j; ++i) {
+        const Type upper = h(i, j), lower = h(i + 1, j);
+        h(i, j) = cosines[i] * upper + sines[i] * lower;
+        h(i + 1, j) = cosines[i] * lower - sines[i] * upper;
+      }
+      const Type radius = std::hypot(h(j, j), norm);
+      cosines[j] = radius == 0 ? Type(1) : h(j, j) / radius;
+      sines[j] = radius == 0 ? Type(0) : norm / radius;
+      h(j, j) = radius;
+      g[j + 1] = -sines[j] * g[j];
+      g[j] = cosines[j] * g[j];
+
+      const double residual = static_cast<double>(std::abs(g[j + 1])) / b_norm;
+      stop = iterative::Report(residual, options, &report) || norm == 0;
+    }
+
+    for (size_t i = size; i-- > 0;) {
+      Type sum = g[i];
+      for (size_t k = i + 1; k < size; ++k) {
+        sum -= h(i, k) * g[k];
+      }
+      g[i] = h(i, i) == 0 ? Type(0) : sum / h(i, i);
+    }
+    std::fill(w.begin(), w.end(), Type(0));
+    for (size_t i = 0; i < size; ++i) {
+      std::span<const Type> basis_i = v(i);
+      for (size_t k = 0; k < n; ++k) {
+        w[k] += g[i] * basis_i[k];
+      }
+    }
+    preconditioner.Apply(w, z);
+    for (size_t k = 0; k < n; ++k) {
+      x[k] += z[k];
+    }
+  }
+
+  return report;
+}
+
+namespace iterative {
+
+template <class Type>
+Type Dot(std::span<const Type> x, std::span<const Type> y) {
+  Type returnable = 0;
+  for (size_t i = 0; i < x.size(); ++i) {
+    returnable += x[i] * y[i];
+  }
+
+  return returnable;
+}
+
+/**
+ * @brief Records residual of finished iteration and calls telemetry
+ * callback
+ *
+ * @return true if solver should stop
+ */
+inline bool Report(double residual, const SolverOptions& options,
+                   SolverReport* report) {
+  ++report->iterations;
+  report->residual = residual;
+  report->converged = residual <= options.tolerance;
+  if (report->history.size() < report->history.capacity()) {
+    report->history.push_back(residual);
+  }
+  if (options.on_iteration) {
+    options.on_iteration(report->iterations, residual);
+  }
+
+  return report->converged || report->iterations >= options.max_iterations;
+}
+
+}  // namespace iterative
+
+}  // namespace hhullen
@@ -0,0 +1,154 @@
+#ifndef SRC_ITERATIVE_H_
+#define SRC_ITERATIVE_H_
+
+#include <concepts>
+#include <functional>
+#include <span>
+#include <vector>
+
+#include "matrix.h"
+
+namespace hhullen {
+
+/**
+ * @brief Square linear operator y = a * x, dense or matrix-free
+ *
+ */
+template <class Operator>
+concept LinearOperator =
+    std::floating_point<typename Operator::value_type> &&
+    requires(const Operator& a,
+             std::span<const typename Operator::value_type> x,
+             std::span<typename Operator::value_type> y) {
+      { a.rows() } -> std::convertible_to<int>;
+      a.Apply(x, y);
+    };
+
+/**
+ * @brief Preconditioner z = m^-1 * r
+ *
+ */
+template <class Preconditioner, class Type>
+concept PreconditionerFor = requires(const Preconditioner& m,
+                                     std::span<const Type> r,
+                                     std::span<Type> z) { m.Apply(r, z); };
+
+/**
+ * @brief Stopping criteria and telemetry of iterative solvers. Solver stops
+ * when residual norm relative to norm of the right side is below
+ * "tolerance". "on_iteration" is called after every iteration with its
+ * number and relative residual
+ *
+ */
+struct SolverOptions {
+  double tolerance = 1e-10;
+  int max_iterations = 1000;
+  int restart = 30;
+  std::function<void(int, double)> on_iteration = nullptr;
+};
+
+/**
+ * @brief Result of iterative solver, "history" holds relative residual of
+ * every iteration
+ *
+ */
+struct SolverReport {
+  int iterations = 0;
+  double residual = 0;
+  bool converged = false;
+  std::vector<double> history;
+};
+
+/**
+ * @brief Dense matrix as linear operator, applied by Matrix::Gemv
+ *
+ */
+template <std::floating_point Type>
+class MatrixOperator {
+ public:
+  using value_type = Type;
+
+  explicit MatrixOperator(const Matrix<Type>& a);
+
+  int rows() const;
+  void Apply(std::span<const Type> x, std::span<Type> y) const;
+
+ private:
+  Matrix<Type> a_;
+};
+
+template <std::floating_point Type>
+class IdentityPreconditioner {
+ public:
+  void Apply(std::span<const Type> r, std::span<Type> z) const;
+};
+
+/**
+ * @brief Diagonal (Jacobi) preconditioner
+ *
+ */
+template <std::floating_point Type>
+class JacobiPreconditioner {
+ public:
+  explicit JacobiPreconditioner(const Matrix<Type>& a);
+  explicit JacobiPreconditioner(std::span<const Type> diagonal);
+
+  void Apply(std::span<const Type> r, std::span<Type> z) const;
+
+ private:
+  std::vector<Type> inverse_;
+
+  static std::vector<Type> Diagonal(const Matrix<Type>& a);
+};
+
+/**
+ * @brief Incomplete LU factorization without fill-in (ILU(0)): factors keep
+ * sparsity pattern of nonzero elements of the matrix and are stored by rows
+ * in compressed form, so application costs O(nonzeros)
+ *
+ */
+template <std::floating_point Type>
+class IluPreconditioner {
+ public:
+  explicit IluPreconditioner(const Matrix<Type>& a);
+
+  void Apply(std::span<const Type> r, std::span<Type> z) const;
+
+ private:
+  std::vector<size_t> row_starts_;
+  std::vector<size_t> diagonal_;
+  std::vector<int> columns_;
+  std::vector<Type> values_;
+};
+
+template <LinearOperator Operator,
+          class Preconditioner =
+              IdentityPreconditioner<typename Operator::value_type>>
+  requires PreconditionerFor<Preconditioner, typename Operator::value_type>
+SolverReport ConjugateGradient(
+    const Operator& a, std::span<const typename Operator::value_type> b,
+    std::span<typename Operator::value_type> x,
+    const SolverOptions& options = SolverOptions(),
+    const Preconditioner& preconditioner = Preconditioner());
+template <LinearOperator Operator,
+          class Preconditioner =
+              IdentityPreconditioner<typename Operator::value_type>>
+  requires PreconditionerFor<Preconditioner, typename Operator::value_type>
+SolverReport Gmres(const Operator& a,
+                   std::span<const typename Operator::value_type> b,
+                   std::span<typename Operator::value_type> x,
+                   const SolverOptions& options = SolverOptions(),
+                   const Preconditioner& preconditioner = Preconditioner());
+
+namespace iterative {
+
+template <class Type>
+Type Dot(std::span<const Type> x, std::span<const Type> y);
+inline bool Report(double residual, const SolverOptions& options,
+                   SolverReport* report);
+
+}  // namespace iterative
+
+}  // namespace hhullen
+
+#endif  // SRC_ITERATIVE_H_
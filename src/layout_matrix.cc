@@ -0,0 +1,452 @@
+#include "layout_matrix.h"
+
+namespace hhullen {
+
+/**
+ * @brief Construct a new empty LayoutMatrix object
+ *
+ */
+template <arithmetic Type, class Layout>
+LayoutMatrix<Type, Layout>::LayoutMatrix() {}
+
+/**
+ * @brief Construct a new LayoutMatrix object filled with zeros, padding of
+ * the layout is zero as well
+ *
+ * @param rows int type
+ * @param cols int type
+ */
+template <arithmetic Type, class Layout>
+LayoutMatrix<Type, Layout>::LayoutMatrix(int rows, int cols)
+    : rows_(rows), cols_(cols) {
+  if (rows < 1 || cols < 1) {
+    throw invalid_argument("Creation matrix with less than 1x1 size");
+  }
+  values_.resize(Layout::Size(rows, cols));
+}
+
+/**
+ * @brief Converts row-major matrix, source is read in storage order of the
+ * layout
+ *
+ * @param other const Matrix& type
+ */
+template <arithmetic Type, class Layout>
+LayoutMatrix<Type, Layout>::LayoutMatrix(const Matrix<Type>& other)
+    : LayoutMatrix(other.rows(), other.cols()) {
+  const Type* source = other.data();
+  const size_t cols = static_cast<size_t>(cols_);
+  Type* target = values_.data();
+  Layout::Visit(rows_, cols_, [&](int i, int j, size_t offset) {
+    target[offset] =
+        source[static_cast<size_t>(i) * cols + static_cast<size_t>(j)];
+  });
+}
+
+/**
+ * @brief Converts matrix of another layout, source is read in its storage
+ * order
+ *
+ * @param other const LayoutMatrix<Type, OtherLayout>& type
+ */
+template <arithmetic Type, class Layout>
+template <class OtherLayout>
+LayoutMatrix<Type, Layout>::LayoutMatrix(
+    const LayoutMatrix<Type, OtherLayout>& other)
+    : LayoutMatrix(other.rows(), other.cols()) {
+  const Type* source = other.data();
+  Type* target = values_.data();
+  OtherLayout::Visit(rows_, cols_, [&](int i, int j, size_t offset) {
+    target[Layout::Offset(i, j, rows_, cols_)] = source[offset];
+  });
+}
+
+/**
+ * @brief Converts to row-major matrix, data is read in storage order
+ *
+ * @return Matrix
+ */
+template <arithmetic Type, class Layout>
+Matrix<Type> LayoutMatrix<Type, Layout>::ToMatrix() const {
+  Matrix<Type> returnable(rows_, cols_);
+  Type* target = returnable.data();
+  const Type* source = values_.data();
+  const size_t cols = static_cast<size_t>(cols_);
+  Layout::Visit(rows_, cols_, [&](int i, int j, size_t offset) {
+    target[static_cast<size_t>(i) * cols + static_cast<size_t>(j)] =
+        source[offset];
+  });
+
+  return returnable;
+}
+
+template <arithmetic Type, class Layout>
+int LayoutMatrix<Type, Layout>::rows() const {
+  return rows_;
+}
+
+template <arithmetic Type, class Layout>
+int LayoutMatrix<Type, Layout>::cols() const {
+  return cols_;
+}
+
+/**
+ * @brief Returns amount of stored elements including padding of the layout
+ *
+ * @return size_t
+ */
+template <arithmetic Type, class Layout>
+size_t LayoutMatrix<Type, Layout>::storage_size() const {
+  return values_.size();
+}
+
+template <arithmetic Type, class Layout>
+Type* LayoutMatrix<Type, Layout>::data() {
+  return values_.data();
+}
+
+template <arithmetic Type, class Layout>
+const Type* LayoutMatrix<Type, Layout>::data() const {
+  return values_.data();
+}
+
+/**
+ * @brief Calls body(i, j, value) for every element in storage order
+ *
+ * @param body callable type
+ */
+template <arithmetic Type, class Layout>
+template <class Body>
+void LayoutMatrix<Type, Layout>::ForEach(Body body) {
+  Type* values = values_.data();
+  Layout::Visit(rows_, cols_, [&](int i, int j, size_t offset) {
+    body(i, j, values[offset]);
+  });
+}
+
+template <arithmetic Type, class Layout>
+template <class Body>
+void LayoutMatrix<Type, Layout>::ForEach(Body body) const {
+  const Type* values = values_.data();
+  Layout::Visit(rows_, cols_, [&](int i, int j, size_t offset) {
+    body(i, j, values[offset]);
+  });
+}
+
+/**
+ * @brief Returns transposed matrix. Source is read in storage order, with
+ * tiled layouts writes stay inside one transposed tile
+ *
+ * @return LayoutMatrix
+ */
+template <arithmetic Type, class Layout>
+LayoutMatrix<Type, Layout> LayoutMatrix<Type, Layout>::Transpose() const {
+  LayoutMatrix returnable(cols_, rows_);
+  Type* target = returnable.values_.data();
+  const Type* source = values_.data();
+  Layout::Visit(rows_, cols_, [&](int i, int j, size_t offset) {
+    target[Layout::Offset(j, i, cols_, rows_)] = source[offset];
+  });
+
+  return returnable;
+}
+
+/**
+ * @brief Hadamard product, row or column vector "other" is broadcast
+ *
+ * @param other const LayoutMatrix& type
+ */
+template <arithmetic Type, class Layout>
+void LayoutMatrix<Type, Layout>::HadamardProduct(const LayoutMatrix& other) {
+  if (!IsBroadcastable(other)) {
+    throw invalid_argument(
+        "Hadamard product with matrix of not broadcastable size");
+  }
+  ApplyElementwise(other, [](Type left, Type right) { return left * right; });
+}
+
+/**
+ * @brief Hadamard division, row or column vector "other" is broadcast.
+ * Padding of the layout is not divided, so it stays zero
+ *
+ * @param other const LayoutMatrix& type
+ */
+template <arithmetic Type, class Layout>
+void LayoutMatrix<Type, Layout>::HadamardDivision(const LayoutMatrix& other) {
+  if (!IsBroadcastable(other)) {
+    throw invalid_argument(
+        "Hadamard division by matrix of not broadcastable size");
+  }
+  ApplyElementwise(other, [](Type left, Type right) { return left / right; });
+}
+
+/**
+ * @brief Compares storages directly, padding is always zero
+ *
+ */
+template <arithmetic Type, class Layout>
+bool LayoutMatrix<Type, Layout>::operator==(const LayoutMatrix& other) const {
+  if (rows_ != other.rows_ || cols_ != other.cols_) {
+    return false;
+  }
+  for (size_t i = 0; i < values_.size(); ++i) {
+    if (std::abs(static_cast<double>(values_[i]) -
+                 static_cast<double>(other.values_[i])) > kAccuracy) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+template <arithmetic Type, class Layout>
+bool LayoutMatrix<Type, Layout>::operator!=(const LayoutMatrix& other) const {
+  return !(*this == other);
+}
+
+template <arithmetic Type, class Layout>
+LayoutMatrix<Type, Layout> LayoutMatrix<Type, Layout>::operator+(
+    const LayoutMatrix& other) const {
+  LayoutMatrix returnable(*this);
+  return returnable += other;
+}
+
+template <arithmetic Type, class Layout>
+LayoutMatrix<Type, Layout> LayoutMatrix<Type, Layout>::operator-(
+    const LayoutMatrix& other) const {
+  LayoutMatrix returnable(*this);
+  return returnable -= other;
+}
+
+template <arithmetic Type, class Layout>
+LayoutMatrix<Type, Layout> LayoutMatrix<Type, Layout>::operator*(
+    const LayoutMatrix& other) const {
+  LayoutMatrix returnable(*this);
+  return returnable *= other;
+}
+
+template <arithmetic Type, class Layout>
+template <arithmetic Val>
+LayoutMatrix<Type, Layout> LayoutMatrix<Type, Layout>::operator+(
+    const Val value) const {
+  LayoutMatrix returnable(*this);
+  return returnable += value;
+}
+
+template <arithmetic Type, class Layout>
+template <arithmetic Val>
+LayoutMatrix<Type, Layout> LayoutMatrix<Type, Layout>::operator-(
+    const Val value) const {
+  LayoutMatrix returnable(*this);
+  return returnable -= value;
+}
+
+template <arithmetic Type, class Layout>
+template <arithmetic Val>
+LayoutMatrix<Type, Layout> LayoutMatrix<Type, Layout>::operator*(
+    const Val value) const {
+  LayoutMatrix returnable(*this);
+  return returnable *= value;
+}
+
+template <arithmetic Type, class Layout>
+template <arithmetic Val>
+LayoutMatrix<Type, Layout> LayoutMatrix<Type, Layout>::operator/(
+    const Val value) const {
+  LayoutMatrix returnable(*this);
+  return returnable /= value;
+}
+
+/**
+ * @brief Sum, row or column vector "other" is broadcast
+ *
+ * @param other const LayoutMatrix& type
+ */
+template <arithmetic Type, class Layout>
+LayoutMatrix<Type, Layout>& LayoutMatrix<Type, Layout>::operator+=(
+    const LayoutMatrix& other) {
+  if (!IsBroadcastable(other)) {
+    throw invalid_argument("Sum with matrix of not broadcastable size");
+  }
+  ApplyElementwise(other, [](Type left, Type right) { return left + right; });
+
+  return *this;
+}
+
+/**
+ * @brief Difference, row or column vector "other" is broadcast
+ *
+ * @param other const LayoutMatrix& type
+ */
+template <arithmetic Type, class Layout>
+LayoutMatrix<Type, Layout>& LayoutMatrix<Type, Layout>::operator-=(
+    const LayoutMatrix& other) {
+  if (!IsBroadcastable(other)) {
+    throw invalid_argument("Difference with matrix of not broadcastable size");
+  }
+  ApplyElementwise(other, [](Type left, Type right) { return left - right; });
+
+  return *this;
+}
+
+/**
+ * @brief Multiplication by converting operands to row-major storage and
+ * Matrix::Gemm
+ *
+ * @param other const LayoutMatrix& type
+ */
+template <arithmetic Type, class Layout>
+LayoutMatrix<Type, Layout>& LayoutMatrix<Type, Layout>::operator*=(
+    const LayoutMatrix& other) {
+  if (cols_ != other.rows_) {
+    throw invalid_argument(
+        "Multiplication matrix with different cols and rows");
+  }
+  Matrix<Type> product(rows_, other.cols_);
+  Matrix<Type>::Gemm(1, ToMatrix(), false, other.ToMatrix(), false, 0,
+                     &product);
+  *this = LayoutMatrix(product);
+
+  return *this;
+}
+
+/**
+ * @brief Adds scalar to elements, padding of the layout stays zero
+ *
+ */
+template <arithmetic Type, class Layout>
+template <arithmetic Val>
+LayoutMatrix<Type, Layout>& LayoutMatrix<Type, Layout>::operator+=(
+    const Val value) {
+  ApplyEach([value](Type val) { return static_cast<Type>(val + value); });
+
+  return *this;
+}
+
+template <arithmetic Type, class Layout>
+template <arithmetic Val>
+LayoutMatrix<Type, Layout>& LayoutMatrix<Type, Layout>::operator-=(
+    const Val value) {
+  ApplyEach([value](Type val) { return static_cast<Type>(val - value); });
+
+  return *this;
+}
+
+template <arithmetic Type, class Layout>
+template <arithmetic Val>
+LayoutMatrix<Type, Layout>& LayoutMatrix<Type, Layout>::operator*=(
+    const Val value) {
+  ApplyEach([value](Type val) { return static_cast<Type>(val * value); });
+
+  return *this;
+}
+
+template <arithmetic Type, class Layout>
+template <arithmetic Val>
+LayoutMatrix<Type, Layout>& LayoutMatrix<Type, Layout>::operator/=(
+    const Val value) {
+  ApplyEach([value](Type val) { return static_cast<Type>(val / value); });
+
+  return *this;
+}
+
+/**
+ * @brief Element access. Index is checked in debug builds only
+ *
+ * @param i int type row index
+ * @param j int type column index
+ * @return Type&
+ */
+template <arithmetic Type, class Layout>
+Type& LayoutMatrix<Type, Layout>::operator()(int i, int j) {
+#ifndef NDEBUG
+  CheckIndex(i, j);
+#endif
+  return values_[Layout::Offset(i, j, rows_, cols_)];
+}
+
+template <arithmetic Type, class Layout>
+Type LayoutMatrix<Type, Layout>::operator()(int i, int j) const {
+#ifndef NDEBUG
+  CheckIndex(i, j);
+#endif
+  return values_[Layout::Offset(i, j, rows_, cols_)];
+}
+
+/**
+ * @brief Element access with index checked in all builds
+ *
+ * @param i int type row index
+ * @param j int type column index
+ * @return Type&
+ */
+template <arithmetic Type, class Layout>
+Type& LayoutMatrix<Type, Layout>::at(int i, int j) {
+  CheckIndex(i, j);
+  return values_[Layout::Offset(i, j, rows_, cols_)];
+}
+
+template <arithmetic Type, class Layout>
+Type LayoutMatrix<Type, Layout>::at(int i, int j) const {
+  CheckIndex(i, j);
+  return values_[Layout::Offset(i, j, rows_, cols_)];
+}
+
+template <arithmetic Type, class Layout>
+void LayoutMatrix<Type, Layout>::CheckIndex(int i, int j) const {
+  if (i < 0 || j < 0 || i >= rows_ || j >= cols_) {
+    throw out_of_range("Index that is out of matrix range");
+  }
+}
+
+template <arithmetic Type, class Layout>
+bool LayoutMatrix<Type, Layout>::IsBroadcastable(
+    const LayoutMatrix& other) const {
+  return (other.rows_ == rows_ || other.rows_ == 1) &&
+         (other.cols_ == cols_ || other.cols_ == 1) &&
+         (other.rows_ == rows_ || other.cols_ == cols_);
+}
+
+/**
+ * @brief Replaces every element by operation(element, other element) in
+ * storage order. Row or column vector "other" is converted to contiguous
+ * values once and broadcast
+ *
+ */
+template <arithmetic Type, class Layout>
+template <class Operation>
+void LayoutMatrix<Type, Layout>::ApplyElementwise(const LayoutMatrix& other,
+                                                  Operation operation) {
+  Type* target = values_.data();
+  if (other.rows_ == rows_ && other.cols_ == cols_) {
+    const Type* source = other.values_.data();
+    Layout::Visit(rows_, cols_, [&](int, int, size_t offset) {
+      target[offset] =
+          static_cast<Type>(operation(target[offset], source[offset]));
+    });
+    return;
+  }
+  const Matrix<Type> vector = other.ToMatrix();
+  const Type* source = vector.data();
+  const bool is_row = other.cols_ == cols_;
+  Layout::Visit(rows_, cols_, [&](int i, int j, size_t offset) {
+    const Type value = source[static_cast<size_t>(is_row ? j : i)];
+    target[offset] = static_cast<Type>(operation(target[offset], value));
+  });
+}
+
+/**
+ * @brief Replaces every element by operation(element) in storage order,
+ * padding of the layout is not visited
+ *
+ */
+template <arithmetic Type, class Layout>
+template <class Operation>
+void LayoutMatrix<Type, Layout>::ApplyEach(Operation operation) {
+  Type* values = values_.data();
+  Layout::Visit(rows_, cols_, [&](int, int, size_t offset) {
+    values[offset] = operation(values[offset]);
+  });
+}
+
+}  // namespace hhullen
@@ -0,0 +1,284 @@
+#ifndef SRC_LAYOUT_MATRIX_H_
+#define SRC_LAYOUT_MATRIX_H_
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "matrix.h"
+
+namespace hhullen {
+
+/**
+ * @brief Storage layout policies. Offset maps index to position in storage
+ * of Size elements, Visit calls body(i, j, offset) for all indices in
+ * storage order, computing offsets incrementally
+ *
+ */
+struct RowMajorLayout {
+  static size_t Size(int rows, int cols) {
+    return static_cast<size_t>(rows) * static_cast<size_t>(cols);
+  }
+  static size_t Offset(int i, int j, int rows, int cols) {
+    static_cast<void>(rows);
+    return static_cast<size_t>(i) * static_cast<size_t>(cols) +
+           static_cast<size_t>(j);
+  }
+  template <class Body>
+  static void Visit(int rows, int cols, Body body) {
+    size_t offset = 0;
+    for (int i = 0; i < rows; ++i) {
+      for (int j = 0; j < cols; ++j) {
+        body(i, j, offset++);
+      }
+    }
+  }
+};
+
+struct ColMajorLayout {
+  static size_t Size(int rows, int cols) {
+    return static_cast<size_t>(rows) * static_cast<size_t>(cols);
+  }
+  static size_t Offset(int i, int j, int rows, int cols) {
+    static_cast<void>(cols);
+    return static_cast<size_t>(j) * static_cast<size_t>(rows) +
+           static_cast<size_t>(i);
+  }
+  template <class Body>
+  static void Visit(int rows, int cols, Body body) {
+    size_t offset = 0;
+    for (int j = 0; j < cols; ++j) {
+      for (int i = 0; i < rows; ++i) {
+        body(i, j, offset++);
+      }
+    }
+  }
+};
+
+/**
+ * @brief Square "Tile"*"Tile" tiles stored one after another in row-major
+ * order of tiles, row-major inside a tile. Edge tiles are padded
+ *
+ */
+template <int Tile = 32>
+struct TiledLayout {
+  static_assert(Tile > 0 && (Tile & (Tile - 1)) == 0,
+                "Tile size must be a power of two");
+  static constexpr size_t kTileSize = static_cast<size_t>(Tile) * Tile;
+
+  static size_t TileCols(int cols) {
+    return (static_cast<size_t>(cols) + Tile - 1) / Tile;
+  }
+  static size_t Size(int rows, int cols) {
+    return TileCols(rows) * TileCols(cols) * kTileSize;
+  }
+  static size_t Offset(int i, int j, int rows, int cols) {
+    static_cast<void>(rows);
+    const size_t row = static_cast<size_t>(i), col = static_cast<size_t>(j);
+    return ((row / Tile) * TileCols(cols) + col / Tile) * kTileSize +
+           (row % Tile) * Tile + col % Tile;
+  }
+  template <class Body>
+  static void Visit(int rows, int cols, Body body) {
+    size_t base = 0;
+    for (int tile_i = 0; tile_i < rows; tile_i += Tile) {
+      for (int tile_j = 0; tile_j < cols; tile_j += Tile) {
+        VisitTile(tile_i, tile_j, rows, cols, base, body);
+        base += kTileSize;
+      }
+    }
+  }
+  template <class Body>
+  static void VisitTile(int tile_i, int tile_j, int rows, int cols,
+                        size_t base, Body& body) {
+    const int last_i = std::min(rows, tile_i + Tile);
+    const int last_j = std::min(cols, tile_j + Tile);
+    for (int i = tile_i; i < last_i; ++i) {
+      size_t offset = base + static_cast<size_t>(i - tile_i) * Tile;
+      for (int j = tile_j; j < last_j; ++j) {
+        body(i, j, offset++);
+      }
+    }
+  }
+};
+
+/**
+ * @brief Square "Tile"*"Tile" tiles stored in Z-order (Morton order) of tile
+ * coordinates, row-major inside a tile. Tiles are grouped to square blocks
+ * of the smaller dimension padded to power of two, blocks follow one
+ * another along the larger dimension. Storage is padded to the Morton index
+ * of the last tile, so it stays within a constant factor of rows*cols
+ *
+ */
+template <int Tile = 32>
+struct ZOrderLayout {
+  using Tiles = TiledLayout<Tile>;
+
+  static size_t Spread(size_t value) {
+    size_t bits = 0;
+    for (size_t shift = 0; (value >> shift) != 0; shift += 8) {
+      bits |= static_cast<size_t>(kSpreadByte[(value >> shift) & 0xFF])
+              << (2 * shift);
+    }
+    return bits;
+  }
+  static size_t Interleave(size_t row, size_t col) {
+    if ((row | col) < kSpreadByte.size()) {
+      return kSpreadByte[col] | static_cast<size_t>(kSpreadByte[row]) << 1;
+    }
+    return Spread(col) | (Spread(row) << 1);
+  }
+  static size_t Size(int rows, int cols) {
+    const size_t last_row = Tiles::TileCols(rows) - 1;
+    const size_t last_col = Tiles::TileCols(cols) - 1;
+    return TileIndex(last_row, last_col, rows, cols) * Tiles::kTileSize +
+           Tiles::kTileSize;
+  }
+  static size_t Offset(int i, int j, int rows, int cols) {
+    const size_t row = static_cast<size_t>(i), col = static_cast<size_t>(j);
+    return TileIndex(row / Tile, col / Tile, rows, cols) * Tiles::kTileSize +
+           (row % Tile) * Tile + col % Tile;
+  }
+  template <class Body>
+  static void Visit(int rows, int cols, Body body) {
+    const int size = static_cast<int>(BlockTiles(rows, cols)) * Tile;
+    for (int first = 0; first < std::max(rows, cols); first += size) {
+      if (rows >= cols) {
+        VisitQuadrant(first, 0, size, rows, cols, body);
+      } else {
+        VisitQuadrant(0, first, size, rows, cols, body);
+      }
+    }
+  }
+
+ private:
+  // Bits of a byte moved to even positions of 16 bits
+  static constexpr std::array<uint16_t, 256> kSpreadByte = [] {
+    std::array<uint16_t, 256> spread{};
+    for (size_t value = 0; value < spread.size(); ++value) {
+      for (size_t bit = 0; bit < 8; ++bit) {
+        spread[value] |=
+            static_cast<uint16_t>(((value >> bit) & 1) << (2 * bit));
+      }
+    }
+    return spread;
+  }();
+
+  static size_t BlockTiles(int rows, int cols) {
+    return std::bit_ceil(Tiles::TileCols(std::min(rows, cols)));
+  }
+  static size_t TileIndex(size_t tile_row, size_t tile_col, int rows,
+                          int cols) {
+    const int shift = static_cast<int>(
+        std::bit_width(Tiles::TileCols(std::min(rows, cols)) - 1));
+    const size_t side = size_t(1) << shift;
+    const size_t block = (rows >= cols ? tile_row : tile_col) >> shift;
+    return (block << (2 * shift)) +
+           Interleave(tile_row & (side - 1), tile_col & (side - 1));
+  }
+  template <class Body>
+  static void VisitQuadrant(int first_i, int first_j, int size, int rows,
+                            int cols, Body& body) {
+    if (first_i >= rows || first_j >= cols) {
+      return;
+    }
+    if (size == Tile) {
+      const size_t tile = TileIndex(static_cast<size_t>(first_i) / Tile,
+                                    static_cast<size_t>(first_j) / Tile,
+                                    rows, cols);
+      Tiles::VisitTile(first_i, first_j, rows, cols,
+                       tile * Tiles::kTileSize, body);
+      return;
+    }
+    const int half = size / 2;
+    VisitQuadrant(first_i, first_j, half, rows, cols, body);
+    VisitQuadrant(first_i, first_j + half, half, rows, cols, body);
+    VisitQuadrant(first_i + half, first_j, half, rows, cols, body);
+    VisitQuadrant(first_i + half, first_j + half, half, rows, cols, body);
+  }
+};
+
+/**
+ * @brief Dense matrix with storage layout selected by policy. Elementwise
+ * operators, conversions and Transpose walk indices in storage order of the
+ * layout, so 2D-local layouts keep both reads and writes inside a few
+ * tiles. Row and column vectors are broadcast as by Matrix. Multiplication
+ * is delegated to Matrix::Gemm through conversion, other Matrix operations
+ * are available through ToMatrix
+ *
+ */
+template <arithmetic Type, class Layout = RowMajorLayout>
+class LayoutMatrix {
+ public:
+  using value_type = Type;
+  using layout_type = Layout;
+
+  LayoutMatrix();
+  LayoutMatrix(int rows, int cols);
+  explicit LayoutMatrix(const Matrix<Type>& other);
+  template <class OtherLayout>
+  explicit LayoutMatrix(const LayoutMatrix<Type, OtherLayout>& other);
+
+  Matrix<Type> ToMatrix() const;
+
+  int rows() const;
+  int cols() const;
+  size_t storage_size() const;
+  Type* data();
+  const Type* data() const;
+  template <class Body>
+  void ForEach(Body body);
+  template <class Body>
+  void ForEach(Body body) const;
+
+  LayoutMatrix Transpose() const;
+  void HadamardProduct(const LayoutMatrix& other);
+  void HadamardDivision(const LayoutMatrix& other);
+
+  bool operator==(const LayoutMatrix& other) const;
+  bool operator!=(const LayoutMatrix& other) const;
+  LayoutMatrix operator+(const LayoutMatrix& other) const;
+  LayoutMatrix operator-(const LayoutMatrix& other) const;
+  LayoutMatrix operator*(const LayoutMatrix& other) const;
+  template <arithmetic Val>
+  LayoutMatrix operator+(const Val value) const;
+  template <arithmetic Val>
+  LayoutMatrix operator-(const Val value) const;
+  template <arithmetic Val>
+  LayoutMatrix operator*(const Val value) const;
+  template <arithmetic Val>
+  LayoutMatrix operator/(const Val value) const;
+  LayoutMatrix& operator+=(const LayoutMatrix& other);
+  LayoutMatrix& operator-=(const LayoutMatrix& other);
+  LayoutMatrix& operator*=(const LayoutMatrix& other);
+  template <arithmetic Val>
+  LayoutMatrix& operator+=(const Val value);
+  template <arithmetic Val>
+  LayoutMatrix& operator-=(const Val value);
+  template <arithmetic Val>
+  LayoutMatrix& operator*=(const Val value);
+  template <arithmetic Val>
+  LayoutMatrix& operator/=(const Val value);
+  Type& operator()(int i, int j);
+  Type operator()(int i, int j) const;
+  Type& at(int i, int j);
+  Type at(int i, int j) const;
+
+ private:
+  int rows_ = 0, cols_ = 0;
+  std::vector<Type> values_;
+  static constexpr double kAccuracy = 0.000001;
+
+  void CheckIndex(int i, int j) const;
+  bool IsBroadcastable(const LayoutMatrix& other) const;
+  template <class Operation>
+  void ApplyElementwise(const LayoutMatrix& other, Operation operation);
+  template <class Operation>
+  void ApplyEach(Operation operation);
+};
+
+}  // namespace hhullen
+
+#endif  // SRC_LAYOUT_MATRIX_H_
@@ -22,7 +22,7 @@ Matrix<Type>::Matrix() : rows_(1), cols_(1) {
  */
 template <arithmetic Type>
 Matrix<Type>::Matrix(int rows, int cols) {
-  if (rows < 1 && cols < 1) {
+  if (rows < 1 || cols < 1) {
     throw invalid_argument("Creation matrix with less than 1x1 size");
   }
 
@@ -32,17 +32,50 @@ Matrix<Type>::Matrix(int rows, int cols) {
 }
 
 /**
- * @brief Construct a new Matrix::Matrix object
+ * @brief Construct a new Matrix::Matrix object with memory placement policy.
+ * Interleaving requires building with MATRIX_WITH_NUMA and falls back to
+ * first-touch placement on systems without NUMA support
  *
- * @param other const Matrix& type
+ * @param rows int type
+ * @param cols int type
+ * @param policy MemoryPolicy type
  */
 template <arithmetic Type>
-Matrix<Type>::Matrix(const Matrix<Type>& other) {
-  if (other != *this) {
-    *this = other;
+Matrix<Type>::Matrix(int rows, int cols, MemoryPolicy policy)
+    : policy_(policy) {
+  if (rows < 1 || cols < 1) {
+    throw invalid_argument("Creation matrix with less than 1x1 size");
   }
+
+  rows_ = rows;
+  cols_ = cols;
+  InitMatrix(true);
+}
+
+/**
+ * @brief Construct a new Matrix::Matrix object with allocated but not
+ * initialized buffer, for results which are overwritten completely
+ *
+ */
+template <arithmetic Type>
+Matrix<Type>::Matrix(int rows, int cols, MemoryPolicy policy, Uninitialized)
+    : rows_(rows), cols_(cols), policy_(policy) {
+  InitMatrix();
 }
 
+/**
+ * @brief Construct a new Matrix::Matrix object sharing data with "other".
+ * Buffer is copied lazily on the first mutation of either matrix
+ *
+ * @param other const Matrix& type
+ */
+template <arithmetic Type>
+Matrix<Type>::Matrix(const Matrix<Type>& other)
+    : rows_(other.rows_),
+      cols_(other.cols_),
+      matrix_(other.matrix_),
+      policy_(other.policy_) {}
+
 /**
  * @brief Construct a new Matrix::Matrix object
  *
@@ -52,6 +85,7 @@ template <arithmetic Type>
 Matrix<Type>::Matrix(Matrix<Type>&& other) {
   rows_ = other.rows_;
   cols_ = other.cols_;
+  policy_ = other.policy_;
   matrix_.swap(other.matrix_);
 
   other.matrix_ = MatrixPtr(nullptr);
@@ -69,6 +103,28 @@ Matrix<Type>::~Matrix() {
   rows_ = 0;
 }
 
+/**
+ * @brief Returns deep copy of matrix that does not share data with this one
+ *
+ * @return Matrix
+ */
+template <arithmetic Type>
+Matrix<Type> Matrix<Type>::Clone() const {
+  Matrix<Type> returnable(*this);
+  returnable.CopyData(matrix_);
+  return returnable;
+}
+
+/**
+ * @brief Checks whether matrix data buffer is shared with another matrix
+ *
+ * @return true if buffer will be copied on next mutation
+ */
+template <arithmetic Type>
+bool Matrix<Type>::IsShared() const {
+  return matrix_.use_count() > 1;
+}
+
 /**
  * @brief Load matrix from file
  *
@@ -76,29 +132,148 @@ Matrix<Type>::~Matrix() {
  */
 template <arithmetic Type>
 void Matrix<Type>::Load(const Str& file_path) {
-  ifstream file(file_path);
+  ifstream file(file_path, std::ios::binary);
 
   IsInputFileOpened(file);
-  ReadMatrixSize(file);
-  ReadMatrix(file);
+  if (IsCompressedFile(file)) {
+    std::istringstream stream(ReadCompressedFile(file_path));
+    ReadMatrixSize(stream);
+    ReadMatrix(stream);
+  } else {
+    ReadMatrixSize(file);
+    ReadMatrix(file);
+  }
 
   file.close();
 }
 
 /**
- * @brief Save matrix to file
+ * @brief Save matrix to file with shortest round-trip number representation
  *
  * @param file_path const Str& type
  */
 template <arithmetic Type>
-void Matrix<Type>::Save(const Str& file_path) {
-  ofstream file(file_path);
+void Matrix<Type>::Save(const Str& file_path) const {
+  Save(file_path, SaveOptions());
+}
 
-  IsOutputFileOpened(file);
-  WriteMatrixSize(file);
-  WriteMatrix(file);
+/**
+ * @brief Save matrix to file. Row blocks are formatted in parallel into
+ * large buffers and written in order
+ *
+ * @param file_path const Str& type
+ * @param options const SaveOptions& type: "precision" is amount of digits
+ * after point for floating types (-1 for shortest round-trip), "threads" is
+ * amount of formatting threads (0 for all hardware threads), "compress"
+ * enables gzip output (requires building with MATRIX_WITH_ZLIB)
+ */
+template <arithmetic Type>
+void Matrix<Type>::Save(const Str& file_path,
+                        const SaveOptions& options) const {
+  if (options.precision > kMaxPrecision) {
+    throw invalid_argument("Saving with too large precision");
+  }
 
-  file.close();
+  if (options.compress) {
+#ifdef MATRIX_WITH_ZLIB
+    std::unique_ptr<gzFile_s, decltype(&gzclose)> file(
+        gzopen(file_path.c_str(), "wb"), &gzclose);
+    if (!file) {
+      throw invalid_argument("File could not be opened.");
+    }
+    WriteMatrix(
+        [&file](const Str& chunk) {
+          if (gzwrite(file.get(), chunk.data(),
+                      static_cast<unsigned>(chunk.size())) <= 0) {
+            throw std::runtime_error("File could not be written.");
+          }
+        },
+        options);
+#else
+    throw invalid_argument("Compressed saving requires MATRIX_WITH_ZLIB");
+#endif
+  } else {
+    ofstream file(file_path, std::ios::binary);
+    IsOutputFileOpened(file);
+    WriteMatrix(
+        [&file](const Str& chunk) {
+          file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        },
+        options);
+    file.close();
+  }
+}
+
+/**
+ * @brief Loads matrix from file in background I/O thread
+ *
+ * @param file_path const Str& type
+ * @param on_done IoCallback type called in I/O thread after loading
+ * @return std::future<Matrix> loaded matrix or loading exception
+ */
+template <arithmetic Type>
+std::future<Matrix<Type>> Matrix<Type>::LoadAsync(const Str& file_path,
+                                                  IoCallback on_done) {
+  auto promise = std::make_shared<std::promise<Matrix<Type>>>();
+  std::future<Matrix<Type>> returnable = promise->get_future();
+
+  IoWorker::Shared().Submit([promise, file_path, on_done] {
+    try {
+      auto start = std::chrono::steady_clock::now();
+      Matrix<Type> loaded;
+      loaded.Load(file_path);
+      IoStats stats{static_cast<size_t>(std::filesystem::file_size(file_path)),
+                    std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count()};
+      if (on_done) {
+        on_done(stats);
+      }
+      promise->set_value(std::move(loaded));
+    } catch (...) {
+      promise->set_exception(std::current_exception());
+    }
+  });
+
+  return returnable;
+}
+
+/**
+ * @brief Saves matrix to file in background I/O thread. Matrix snapshot
+ * shares data with this matrix, so the call costs no copy and this matrix
+ * may be changed right away. Blocks while two saves are already pending
+ *
+ * @param file_path const Str& type
+ * @param options const SaveOptions& type
+ * @param on_done IoCallback type called in I/O thread after saving
+ * @return std::future<IoStats> statistics or saving exception
+ */
+template <arithmetic Type>
+std::future<IoStats> Matrix<Type>::SaveAsync(const Str& file_path,
+                                             const SaveOptions& options,
+                                             IoCallback on_done) const {
+  auto promise = std::make_shared<std::promise<IoStats>>();
+  std::future<IoStats> returnable = promise->get_future();
+
+  IoWorker::Shared().Submit([promise, snapshot = *this, file_path, options,
+                             on_done] {
+    try {
+      auto start = std::chrono::steady_clock::now();
+      snapshot.Save(file_path, options);
+      IoStats stats{static_cast<size_t>(std::filesystem::file_size(file_path)),
+                    std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count()};
+      if (on_done) {
+        on_done(stats);
+      }
+      promise->set_value(stats);
+    } catch (...) {
+      promise->set_exception(std::current_exception());
+    }
+  });
+
+  return returnable;
 }
 
 /**
@@ -113,7 +288,8 @@ void Matrix<Type>::SwapRows(const int row_1, const int row_2) {
     throw out_of_range("The matrix rows indices that is out of matrix size");
   }
 
-  matrix_[row_1].swap(matrix_[row_2]);
+  Detach();
+  std::swap_ranges(row(row_1).begin(), row(row_1).end(), row(row_2).begin());
 }
 
 /**
@@ -131,9 +307,36 @@ void Matrix<Type>::ProcessRows(
     throw out_of_range("Matrix rows with indices that is out of matrix size");
   }
 
+  Detach();
+  Type* first = row(row_1).data();
+  Type* second = row(row_2).data();
   for (int col = 0; col < cols_; ++col) {
-    lambda(matrix_[row_1][col], matrix_[row_2][col]);
+    lambda(first[col], second[col]);
+  }
+}
+
+/**
+ * @brief Apply lambda function to values of two rows addressed through row
+ * permutation, so pending row swaps need not be applied to data first
+ *
+ * @param row_1 const int type index of first row in permuted order
+ * @param row_2 const int type index of secont row in permuted order
+ * @param lambda const std::function<void(Type&, Type&)> type lambda function
+ * @param order const Permutation& type
+ */
+template <arithmetic Type>
+void Matrix<Type>::ProcessRows(const int row_1, const int row_2,
+                               const std::function<void(Type&, Type&)>& lambda,
+                               const Permutation& order) {
+  if (order.size() != rows_) {
+    throw invalid_argument(
+        "Processing rows with permutation of different amount of rows");
+  }
+  if (row_1 < 0 || row_1 >= rows_ || row_2 < 0 || row_2 >= rows_) {
+    throw out_of_range("Matrix rows with indices that is out of matrix size");
   }
+
+  ProcessRows(order[row_1], order[row_2], lambda);
 }
 
 /**
@@ -149,8 +352,9 @@ void Matrix<Type>::ProcessRow(const int row,
     throw out_of_range("Matrix rows with indices that is out of matrix size");
   }
 
-  for (int col = 0; col < cols_; ++col) {
-    lambda(matrix_[row][col]);
+  Detach();
+  for (Type& value : this->row(row)) {
+    lambda(value);
   }
 }
 
@@ -161,29 +365,40 @@ void Matrix<Type>::ProcessRow(const int row,
  */
 template <arithmetic Type>
 void Matrix<Type>::ProcessEach(const std::function<void(Type&)>& lambda) {
-  for (int i = 0; i < rows_; ++i) {
-    for (int j = 0; j < cols_; ++j) {
-      lambda(matrix_[i][j]);
-    }
+  Detach();
+  for (Type& value : *this) {
+    lambda(value);
   }
 }
 
 /**
- * @brief Calculates elementwise product
+ * @brief Calculates elementwise product. "other" of 1*cols or rows*1 size
+ * is broadcast to every row or column without materialization
  *
  * @param other const Matrix& type
  */
 template <arithmetic Type>
 void Matrix<Type>::HadamardProduct(const Matrix<Type>& other) {
-  if (cols_ != other.cols_ || rows_ != other.rows_) {
-    throw invalid_argument("Hadamatd product with different cols or rows");
+  if (!IsBroadcastable(other)) {
+    throw invalid_argument(
+        "Hadamard product with matrix of not broadcastable size");
   }
+  ApplyElementwise(other, [](Type left, Type right) { return left * right; });
+}
 
-  for (int i = 0; i < rows_; ++i) {
-    for (int j = 0; j < cols_; ++j) {
-      matrix_[i][j] *= other.matrix_[i][j];
-    }
+/**
+ * @brief Calculates elementwise quotient, broadcasting "other" as
+ * HadamardProduct does
+ *
+ * @param other const Matrix& type
+ */
+template <arithmetic Type>
+void Matrix<Type>::HadamardDivision(const Matrix<Type>& other) {
+  if (!IsBroadcastable(other)) {
+    throw invalid_argument(
+        "Hadamard division by matrix of not broadcastable size");
   }
+  ApplyElementwise(other, [](Type left, Type right) { return left / right; });
 }
 
 /**
@@ -193,13 +408,9 @@ void Matrix<Type>::HadamardProduct(const Matrix<Type>& other) {
  */
 template <arithmetic Type>
 Matrix<Type> Matrix<Type>::Transpose() const {
-  Matrix<Type> returnable(cols_, rows_);
-
-  for (int i = 0; i < returnable.rows_; ++i) {
-    for (int j = 0; j < returnable.cols_; ++j) {
-      returnable.matrix_[i][j] = matrix_[j][i];
-    }
-  }
+  Matrix<Type> returnable(cols_, rows_, policy_, Uninitialized());
+  TransposeBuffer(data(), returnable.matrix_.get(), static_cast<size_t>(rows_),
+                  static_cast<size_t>(cols_), Tuning().Load());
 
   return returnable;
 }
@@ -217,7 +428,254 @@ void Matrix<Type>::set(int i, int j, Type value) {
     throw out_of_range("Setting element that is out of matrix range");
   }
 
-  matrix_[i][j] = value;
+  MutableData()[static_cast<size_t>(i) * static_cast<size_t>(cols_) +
+                static_cast<size_t>(j)] = value;
+}
+
+/**
+ * @brief Calculates c = alpha * op(a) * op(b) + beta * c in place, where
+ * op(x) is x or its transpose. No temporary matrices are created. When beta
+ * is 0 previous values of "c" are ignored
+ *
+ * @param alpha Type type
+ * @param a const Matrix& type
+ * @param trans_a bool type use transposed "a"
+ * @param b const Matrix& type
+ * @param trans_b bool type use transposed "b"
+ * @param beta Type type
+ * @param c Matrix* type output matrix of op(a) rows and op(b) cols
+ */
+template <arithmetic Type>
+void Matrix<Type>::Gemm(Type alpha, const Matrix<Type>& a, bool trans_a,
+                        const Matrix<Type>& b, bool trans_b, Type beta,
+                        Matrix<Type>* c) {
+  const int m = trans_a ? a.cols_ : a.rows_;
+  const int k = trans_a ? a.rows_ : a.cols_;
+  const int n = trans_b ? b.rows_ : b.cols_;
+  if ((trans_b ? b.cols_ : b.rows_) != k || c->rows_ != m || c->cols_ != n) {
+    throw invalid_argument(
+        "Multiplication matrix with different cols and rows");
+  }
+  if (c == &a || c == &b) {
+    throw invalid_argument("Multiplication output is also its operand");
+  }
+
+  if (beta == 0 && c->IsShared()) {
+    c->matrix_ = c->Allocate(c->size());
+  }
+  GemmKernel(alpha, a.data(), trans_a, b.data(), trans_b, beta,
+             c->MutableData(), static_cast<size_t>(m), static_cast<size_t>(n),
+             static_cast<size_t>(k));
+}
+
+/**
+ * @brief Calculates y = alpha * op(a) * x + beta * y in place, where op(a) is
+ * "a" or its transpose. When beta is 0 previous values of "y" are ignored
+ *
+ * @param alpha Type type
+ * @param a const Matrix& type
+ * @param trans_a bool type use transposed "a"
+ * @param x std::span<const Type> type vector of op(a) cols size
+ * @param beta Type type
+ * @param y std::span<Type> type vector of op(a) rows size
+ */
+template <arithmetic Type>
+void Matrix<Type>::Gemv(Type alpha, const Matrix<Type>& a, bool trans_a,
+                        std::span<const Type> x, Type beta,
+                        std::span<Type> y) {
+  const size_t m = static_cast<size_t>(a.rows_);
+  const size_t n = static_cast<size_t>(a.cols_);
+  if (x.size() != (trans_a ? m : n) || y.size() != (trans_a ? n : m)) {
+    throw invalid_argument("Multiplication by vector of different size");
+  }
+  const Type* values = a.data();
+  if (BlasGemv(alpha, values, trans_a, x.data(), beta, y.data(), m, n)) {
+    return;
+  }
+
+  if (!trans_a) {
+    for (size_t i = 0; i < m; ++i) {
+      Type sum = 0;
+      for (size_t j = 0; j < n; ++j) {
+        sum += values[i * n + j] * x[j];
+      }
+      y[i] = alpha * sum + (beta == 0 ? 0 : beta * y[i]);
+    }
+  } else {
+    for (Type& value : y) {
+      value = beta == 0 ? 0 : beta * value;
+    }
+    for (size_t i = 0; i < m; ++i) {
+      const Type factor = alpha * x[i];
+      for (size_t j = 0; j < n; ++j) {
+        y[j] += factor * values[i * n + j];
+      }
+    }
+  }
+}
+
+/**
+ * @brief Solves system of linear equations this * x = b by LU
+ * factorization with partial pivoting
+ *
+ * @param b const Matrix& type right side, one column per system
+ * @return Matrix solution of "b" size
+ */
+template <arithmetic Type>
+Matrix<Type> Matrix<Type>::Solve(const Matrix<Type>& b) const
+  requires std::floating_point<Type>
+{
+  if (rows_ != cols_ || b.rows_ != rows_) {
+    throw invalid_argument("Solving system with not square matrix");
+  }
+  Permutation order;
+  Matrix<Type> lu = Lu(&order);
+  Matrix<Type> returnable(b);
+
+  LuSolve(lu, order, &returnable);
+
+  return returnable;
+}
+
+/**
+ * @brief Raises square matrix to power "k" by binary exponentiation. Three
+ * buffers are allocated once, squares and products are written by Gemm to
+ * the spare one and buffers are swapped, so no allocation happens inside
+ * the loop
+ *
+ * @param k int type non-negative exponent
+ * @return Matrix
+ */
+template <arithmetic Type>
+Matrix<Type> Matrix<Type>::Power(int k) const {
+  if (rows_ != cols_) {
+    throw invalid_argument("Power of not square matrix");
+  }
+  if (k < 0) {
+    throw invalid_argument("Power with negative exponent");
+  }
+  if (k == 0) {
+    return Identity(rows_);
+  }
+  Matrix<Type> buffers[3] = {Clone(), Matrix<Type>(rows_, cols_),
+                             Matrix<Type>(rows_, cols_)};
+  Matrix<Type>* base = &buffers[0];
+  Matrix<Type>* result = &buffers[1];
+  Matrix<Type>* spare = &buffers[2];
+  bool is_result_set = false;
+
+  while (true) {
+    if (k & 1) {
+      if (!is_result_set) {
+        std::copy(std::as_const(*base).begin(), std::as_const(*base).end(),
+                  result->begin());
+        is_result_set = true;
+      } else {
+        Gemm(1, *result, false, *base, false, 0, spare);
+        std::swap(result, spare);
+      }
+    }
+    k >>= 1;
+    if (k == 0) {
+      break;
+    }
+    Gemm(1, *base, false, *base, false, 0, spare);
+    std::swap(base, spare);
+  }
+
+  return *result;
+}
+
+/**
+ * @brief Matrix exponential by scaling and squaring with diagonal Pade
+ * approximant of degree 3 to 13 (Higham, 2005): degree is chosen by 1-norm
+ * so that no scaling is needed when possible, otherwise matrix is divided
+ * by 2^s, approximated with degree 13 and squared "s" times with Gemm
+ *
+ * @return Matrix
+ */
+template <arithmetic Type>
+Matrix<Type> Matrix<Type>::Exp() const
+  requires std::floating_point<Type>
+{
+  if (rows_ != cols_) {
+    throw invalid_argument("Exponential of not square matrix");
+  }
+  constexpr std::pair<int, double> kDegrees[] = {{3, 1.495585217958292e-2},
+                                                 {5, 2.539398330063230e-1},
+                                                 {7, 9.504178996162932e-1},
+                                                 {9, 2.097847961257068}};
+  constexpr double kMaxNorm = 5.371920351148152;
+  const double norm = static_cast<double>(NormOne());
+  if (!std::isfinite(norm)) {
+    throw invalid_argument("Exponential of not finite matrix");
+  }
+  for (const auto& [degree, max_norm] : kDegrees) {
+    if (norm <= max_norm) {
+      return PadeApproximant(degree);
+    }
+  }
+
+  const int squarings =
+      std::max(0, static_cast<int>(std::ceil(std::log2(norm / kMaxNorm))));
+  Matrix<Type> returnable =
+      (*this / std::ldexp(1.0, squarings)).PadeApproximant(13);
+  Matrix<Type> spare(rows_, cols_);
+  for (int i = 0; i < squarings; ++i) {
+    Gemm(1, returnable, false, returnable, false, 0, &spare);
+    std::swap(returnable.matrix_, spare.matrix_);
+  }
+
+  return returnable;
+}
+
+/**
+ * @brief LU factorization with partial pivoting: P * this = L * U, where P
+ * moves row "order[i]" to row "i". Pivoting only updates the permutation,
+ * rows are moved once after elimination
+ *
+ * @param order Permutation* type output row permutation P
+ * @return Matrix with unit lower triangle of L and upper triangle of U
+ */
+template <arithmetic Type>
+Matrix<Type> Matrix<Type>::Lu(Permutation* order) const
+  requires std::floating_point<Type>
+{
+  if (rows_ != cols_) {
+    throw invalid_argument("LU factorization of not square matrix");
+  }
+  Matrix<Type> returnable = Clone();
+
+  LuFactor(&returnable, order);
+
+  return returnable;
+}
+
+/**
+ * @brief Moves row "order[i]" to row "i" for each row in one pass over data
+ *
+ * @param order const Permutation& type
+ */
+template <arithmetic Type>
+void Matrix<Type>::Permute(const Permutation& order) {
+  if (order.size() != rows_) {
+    throw invalid_argument("Permuting rows by permutation of different size");
+  }
+  if (order.IsIdentity()) {
+    return;
+  }
+  MatrixPtr buffer = Allocate(size());
+  const Type* source = matrix_.get();
+  const size_t cols = static_cast<size_t>(cols_);
+
+  ForEachRowBlock(rows_, cols, [&](int first, int last) {
+    for (int i = first; i < last; ++i) {
+      memcpy(buffer.get() + static_cast<size_t>(i) * cols,
+             source + static_cast<size_t>(order[i]) * cols,
+             sizeof(Type) * cols);
+    }
+  });
+  matrix_.swap(buffer);
 }
 
 /**
@@ -230,6 +688,16 @@ int Matrix<Type>::rows() const {
   return rows_;
 }
 
+/**
+ * @brief Returns memory placement policy of matrix
+ *
+ * @return MemoryPolicy
+ */
+template <arithmetic Type>
+MemoryPolicy Matrix<Type>::memory_policy() const {
+  return policy_;
+}
+
 /**
  * @brief Returns amount of matrix columns
  *
@@ -250,21 +718,7 @@ void Matrix<Type>::set_rows(int new_val) {
   if (new_val < 1) {
     throw invalid_argument("Setting rows amount that is equal or less than 0");
   }
-  MatrixPtr buffer = MatrixPtr(new RowPtr[new_val]);
-
-  if (new_val < rows_) {
-    rows_ = new_val;
-  }
-  for (int i = 0; i < rows_; ++i) {
-    buffer[i].swap(matrix_[i]);
-  }
-  matrix_.swap(buffer);
-
-  for (int i = rows_; i < new_val; ++i) {
-    matrix_[i] = RowPtr(new Type[cols_]);
-    memset(matrix_[i].get(), 0, sizeof(Type) * static_cast<size_t>(cols_));
-  }
-  rows_ = new_val;
+  Resize(new_val, cols_);
 }
 
 /**
@@ -277,23 +731,7 @@ void Matrix<Type>::set_cols(int new_val) {
   if (new_val <= 0) {
     throw invalid_argument("Setting cols amount that is equal or less than 0");
   }
-  RowPtr buffer(nullptr);
-
-  if (new_val < cols_) {
-    cols_ = new_val;
-  }
-  for (int i = 0; i < rows_; ++i) {
-    buffer.reset(new Type[new_val]);
-    for (int j = 0; j < cols_; ++j) {
-      buffer[j] = matrix_[i][j];
-    }
-    for (int j = cols_; j < new_val; ++j) {
-      buffer[j] = 0;
-    }
-
-    matrix_[i].swap(buffer);
-  }
-  cols_ = new_val;
+  Resize(rows_, new_val);
 }
 
 /*
@@ -304,9 +742,13 @@ bool Matrix<Type>::operator==(const Matrix<Type>& other) const {
   bool is_equal = true;
 
   if (rows_ == other.rows_ && cols_ == other.cols_) {
-    for (int i = 0; is_equal && i < rows_; ++i) {
-      for (int j = 0; is_equal && j < cols_; ++j) {
-        is_equal = fabs(matrix_[i][j] - other.matrix_[i][j]) < kAccuracy;
+    const Type* left = data();
+    const Type* right = other.data();
+    for (size_t i = 0; is_equal && i < size(); ++i) {
+      if constexpr (std::is_floating_point_v<Type>) {
+        is_equal = fabs(left[i] - right[i]) < kAccuracy;
+      } else {
+        is_equal = left[i] == right[i];
       }
     }
   } else {
@@ -323,16 +765,10 @@ bool Matrix<Type>::operator!=(const Matrix<Type>& other) const {
 
 template <arithmetic Type>
 Matrix<Type>& Matrix<Type>::operator=(const Matrix<Type>& other) {
-  if (other != *this) {
-    rows_ = other.rows_;
-    cols_ = other.cols_;
-    InitMatrix(false);
-    for (int i = 0; i < rows_; ++i) {
-      for (int j = 0; j < cols_; ++j) {
-        matrix_[i][j] = other.matrix_[i][j];
-      }
-    }
-  }
+  rows_ = other.rows_;
+  cols_ = other.cols_;
+  matrix_ = other.matrix_;
+  policy_ = other.policy_;
 
   return *this;
 }
@@ -351,8 +787,31 @@ Matrix<Type> Matrix<Type>::operator-(const Matrix<Type>& other) const {
 
 template <arithmetic Type>
 Matrix<Type> Matrix<Type>::operator*(const Matrix<Type>& other) const {
+  if (cols_ != other.rows_) {
+    throw invalid_argument(
+        "Multiplication matrix with different cols and rows");
+  }
+  Matrix<Type> returnable(rows_, other.cols_, policy_, Uninitialized());
+
+  GemmKernel(1, data(), false, other.data(), false, 0,
+             returnable.matrix_.get(), static_cast<size_t>(rows_),
+             static_cast<size_t>(other.cols_), static_cast<size_t>(cols_));
+
+  return returnable;
+}
+
+template <arithmetic Type>
+template <arithmetic Val>
+Matrix<Type> Matrix<Type>::operator+(const Val value) const {
+  Matrix returnable(*this);
+  return returnable += value;
+}
+
+template <arithmetic Type>
+template <arithmetic Val>
+Matrix<Type> Matrix<Type>::operator-(const Val value) const {
   Matrix returnable(*this);
-  return returnable *= other;
+  return returnable -= value;
 }
 
 template <arithmetic Type>
@@ -363,81 +822,235 @@ Matrix<Type> Matrix<Type>::operator*(const Val value) const {
 }
 
 template <arithmetic Type>
-Matrix<Type> Matrix<Type>::operator+=(const Matrix<Type>& other) {
-  if (rows_ != other.rows_ || cols_ != other.cols_) {
-    throw invalid_argument("Matrix that is not square");
-  }
+template <arithmetic Val>
+Matrix<Type> Matrix<Type>::operator/(const Val value) const {
+  Matrix returnable(*this);
+  return returnable /= value;
+}
 
-  for (int i = 0; i < rows_; ++i) {
-    for (int j = 0; j < cols_; ++j) {
-      matrix_[i][j] += other.matrix_[i][j];
-    }
+/**
+ * @brief Elementwise sum. "other" of 1*cols or rows*1 size is added to every
+ * row or column in one pass without materialization
+ *
+ * @param other const Matrix& type
+ */
+template <arithmetic Type>
+Matrix<Type> Matrix<Type>::operator+=(const Matrix<Type>& other) {
+  if (!IsBroadcastable(other)) {
+    throw invalid_argument("Sum with matrix of not broadcastable size");
   }
+  ApplyElementwise(other, [](Type left, Type right) { return left + right; });
 
   return *this;
 }
 
+/**
+ * @brief Elementwise difference, broadcasting "other" as operator+= does
+ *
+ * @param other const Matrix& type
+ */
 template <arithmetic Type>
 Matrix<Type> Matrix<Type>::operator-=(const Matrix<Type>& other) {
-  if (rows_ != other.rows_ || cols_ != other.cols_) {
-    throw invalid_argument("Substraction the matrix that is not square");
-  }
-
-  for (int i = 0; i < rows_; ++i) {
-    for (int j = 0; j < cols_; ++j) {
-      matrix_[i][j] -= other.matrix_[i][j];
-    }
+  if (!IsBroadcastable(other)) {
+    throw invalid_argument("Difference with matrix of not broadcastable size");
   }
+  ApplyElementwise(other, [](Type left, Type right) { return left - right; });
 
   return *this;
 }
 
-template <arithmetic Type>
-Matrix<Type> Matrix<Type>::operator*=(const Matrix<Type>& other) {
-  if (cols_ != other.rows_) {
-    throw invalid_argument(
-        "Multiplication matrix with different cols and rows");
-  }
-  RowPtr buffer_row(nullptr);
-
-  for (int i = 0; i < rows_; ++i) {
-    buffer_row.reset(new Type[other.cols_]);
-    for (int j = 0; j < other.cols_; ++j) {
-      buffer_row[j] = 0;
-      for (int k = 0; k < cols_; k += 1) {
-        buffer_row[j] += matrix_[i][k] * other.matrix_[k][j];
-      }
-    }
-    matrix_[i].swap(buffer_row);
-  }
+/**
+ * @brief Multiplies by "other". Operands are only read, so a shared buffer
+ * is released instead of copied
+ *
+ * @param other const Matrix& type
+ */
+template <arithmetic Type>
+Matrix<Type> Matrix<Type>::operator*=(const Matrix<Type>& other) {
+  Matrix<Type> product = std::as_const(*this) * other;
+  matrix_.swap(product.matrix_);
   cols_ = other.cols_;
 
   return *this;
 }
 
+template <arithmetic Type>
+template <arithmetic Val>
+Matrix<Type> Matrix<Type>::operator+=(const Val value) {
+  ApplyEach([value](Type val) { return static_cast<Type>(val + value); });
+
+  return *this;
+}
+
+template <arithmetic Type>
+template <arithmetic Val>
+Matrix<Type> Matrix<Type>::operator-=(const Val value) {
+  ApplyEach([value](Type val) { return static_cast<Type>(val - value); });
+
+  return *this;
+}
+
 template <arithmetic Type>
 template <arithmetic Val>
 Matrix<Type> Matrix<Type>::operator*=(const Val value) {
-  ProcessEach([value](Type& val) { val *= value; });
+  ApplyEach([value](Type val) { return static_cast<Type>(val * value); });
+
   return *this;
 }
 
 template <arithmetic Type>
-Type& Matrix<Type>::operator()(int i, int j) {
-  if ((i < 0 || i > rows_) || j < 0 || j > cols_) {
-    throw out_of_range("Setting element that is out of matrix range");
-  }
+template <arithmetic Val>
+Matrix<Type> Matrix<Type>::operator/=(const Val value) {
+  ApplyEach([value](Type val) { return static_cast<Type>(val / value); });
 
-  return matrix_[i][j];
+  return *this;
+}
+
+/**
+ * @brief Element access. Index is checked in debug builds only, so it is
+ * safe to use in hot loops of release builds. Non-const version detaches
+ * shared buffer, kernels write through one MutableData() pointer instead
+ *
+ * @param i int type row index
+ * @param j int type column index
+ * @return Type&
+ */
+template <arithmetic Type>
+Type& Matrix<Type>::operator()(int i, int j) {
+#ifndef NDEBUG
+  CheckIndex(i, j);
+#endif
+  return MutableData()[static_cast<size_t>(i) * static_cast<size_t>(cols_) +
+                static_cast<size_t>(j)];
 }
 
 template <arithmetic Type>
 Type Matrix<Type>::operator()(int i, int j) const {
-  if ((i < 0 || i > rows_) || j < 0 || j > cols_) {
-    throw out_of_range("Setting element that is out of matrix range");
-  }
+#ifndef NDEBUG
+  CheckIndex(i, j);
+#endif
+  return data()[static_cast<size_t>(i) * static_cast<size_t>(cols_) +
+                static_cast<size_t>(j)];
+}
+
+/**
+ * @brief Element access with index check in any build
+ *
+ * @param i int type row index
+ * @param j int type column index
+ * @return Type&
+ */
+template <arithmetic Type>
+Type& Matrix<Type>::at(int i, int j) {
+  CheckIndex(i, j);
+  return this->operator()(i, j);
+}
+
+template <arithmetic Type>
+Type Matrix<Type>::at(int i, int j) const {
+  CheckIndex(i, j);
+  return this->operator()(i, j);
+}
+
+/**
+ * @brief Returns amount of matrix elements
+ *
+ * @return size_t
+ */
+template <arithmetic Type>
+size_t Matrix<Type>::size() const {
+  return static_cast<size_t>(rows_) * static_cast<size_t>(cols_);
+}
+
+/**
+ * @brief Returns pointer to contiguous row-major matrix data. Non-const
+ * version detaches shared buffer
+ *
+ * @return Type*
+ */
+template <arithmetic Type>
+Type* Matrix<Type>::data() {
+  return MutableData();
+}
+
+template <arithmetic Type>
+const Type* Matrix<Type>::data() const {
+  return matrix_.get();
+}
+
+/**
+ * @brief Detaches shared buffer and returns pointer to its data. Non-const
+ * accessors call it on every access, so kernels take it once and write
+ * through the pointer
+ *
+ * @return Type*
+ */
+template <arithmetic Type>
+Type* Matrix<Type>::MutableData() {
+  Detach();
+  return matrix_.get();
+}
+
+/**
+ * @brief Returns row view. Row index is checked in debug builds only
+ *
+ * @param i int type row index
+ * @return std::span<Type>
+ */
+template <arithmetic Type>
+std::span<Type> Matrix<Type>::row(int i) {
+#ifndef NDEBUG
+  CheckIndex(i, 0);
+#endif
+  return std::span<Type>(
+      MutableData() + static_cast<size_t>(i) * static_cast<size_t>(cols_),
+      static_cast<size_t>(cols_));
+}
+
+template <arithmetic Type>
+std::span<const Type> Matrix<Type>::row(int i) const {
+#ifndef NDEBUG
+  CheckIndex(i, 0);
+#endif
+  return std::span<const Type>(
+      data() + static_cast<size_t>(i) * static_cast<size_t>(cols_),
+      static_cast<size_t>(cols_));
+}
+
+/**
+ * @brief Random access iterators over all elements in row-major order.
+ * Usable with standard algorithms including parallel execution policies
+ *
+ * @return iterator
+ */
+template <arithmetic Type>
+typename Matrix<Type>::iterator Matrix<Type>::begin() {
+  return MutableData();
+}
 
-  return matrix_[i][j];
+template <arithmetic Type>
+typename Matrix<Type>::iterator Matrix<Type>::end() {
+  return MutableData() + size();
+}
+
+template <arithmetic Type>
+typename Matrix<Type>::const_iterator Matrix<Type>::begin() const {
+  return data();
+}
+
+template <arithmetic Type>
+typename Matrix<Type>::const_iterator Matrix<Type>::end() const {
+  return data() + size();
+}
+
+template <arithmetic Type>
+typename Matrix<Type>::const_iterator Matrix<Type>::cbegin() const {
+  return begin();
+}
+
+template <arithmetic Type>
+typename Matrix<Type>::const_iterator Matrix<Type>::cend() const {
+  return end();
 }
 
 /*
@@ -445,36 +1058,682 @@ Type Matrix<Type>::operator()(int i, int j) const {
 */
 template <arithmetic Type>
 void Matrix<Type>::InitMatrix(bool fill_with_zero) {
-  matrix_ = MatrixPtr(new RowPtr[rows_]);
+  matrix_ = Allocate(size());
+  if (fill_with_zero) {
+    Type* values = matrix_.get();
+    const size_t cols = static_cast<size_t>(cols_);
+    ForEachRowBlock(rows_, cols, [values, cols](int first, int last) {
+      memset(values + static_cast<size_t>(first) * cols, 0,
+             sizeof(Type) * static_cast<size_t>(last - first) * cols);
+    });
+  }
+}
+
+/**
+ * @brief Allocates buffer for "count" elements according to memory policy.
+ * Memory is not touched, so pages are placed by the first writing thread
+ *
+ * @param count size_t type
+ * @return MatrixPtr
+ */
+template <arithmetic Type>
+typename Matrix<Type>::MatrixPtr Matrix<Type>::Allocate(size_t count) const {
+  if (count > std::numeric_limits<size_t>::max() / sizeof(Type)) {
+    throw std::bad_array_new_length();
+  }
+  if (policy_ == MemoryPolicy::kInterleaved) {
+    const size_t bytes = sizeof(Type) * count;
+    void* memory = AllocateInterleaved(bytes);
+    if (memory != nullptr) {
+      return MatrixPtr(static_cast<Type*>(memory), [bytes](Type* values) {
+        FreeInterleaved(values, bytes);
+      });
+    }
+  }
+
+  return MatrixPtr(new Type[count]);
+}
+
+/**
+ * @brief Multiplication kernel on row-major buffers: "a" is m*k (k*m if
+ * transposed), "b" is k*n (n*k if transposed), "c" is m*n. Rows of "c" are
+ * split between threads, each thread walks k and n by cache blocks
+ *
+ */
+template <arithmetic Type>
+void Matrix<Type>::GemmKernel(Type alpha, const Type* a, bool trans_a,
+                              const Type* b, bool trans_b, Type beta, Type* c,
+                              size_t m, size_t n, size_t k) {
+  if (!BlasGemm(alpha, a, trans_a, b, trans_b, beta, c, m, n, k)) {
+    NativeGemm(alpha, a, trans_a, b, trans_b, beta, c, m, n, k,
+               Tuning().Load());
+  }
+}
+
+/**
+ * @brief Native multiplication kernel with explicit amount of threads, cache
+ * block and parallel threshold of the shape class of m*n result
+ *
+ */
+template <arithmetic Type>
+void Matrix<Type>::NativeGemm(Type alpha, const Type* a, bool trans_a,
+                              const Type* b, bool trans_b, Type beta, Type* c,
+                              size_t m, size_t n, size_t k,
+                              const TuningParameters& parameters) {
+  const GemmShape shape = TuningParameters::Shape(m, n);
+  const size_t block = static_cast<size_t>(parameters.GemmBlock(shape));
+  auto rows = [&](int first, int last) {
+    GemmRows(alpha, a, trans_a, b, trans_b, beta, c, m, n, k, block,
+             static_cast<size_t>(first), static_cast<size_t>(last));
+  };
+
+  if (m * n * std::max<size_t>(k, 1) >= parameters.ParallelElements(shape)) {
+    ParallelFor(0, static_cast<int>(m), parameters.threads, rows);
+  } else {
+    rows(0, static_cast<int>(m));
+  }
+}
+
+template <arithmetic Type>
+void Matrix<Type>::GemmRows(Type alpha, const Type* a, bool trans_a,
+                            const Type* b, bool trans_b, Type beta, Type* c,
+                            size_t m, size_t n, size_t k, size_t block,
+                            size_t first, size_t last) {
+  for (size_t i = first; i < last; ++i) {
+    Type* c_row = c + i * n;
+    if (beta == 0) {
+      memset(c_row, 0, sizeof(Type) * n);
+    } else if (beta != 1) {
+      for (size_t j = 0; j < n; ++j) {
+        c_row[j] *= beta;
+      }
+    }
+  }
+
+  for (size_t p0 = 0; p0 < k; p0 += block) {
+    const size_t p1 = std::min(k, p0 + block);
+    for (size_t j0 = 0; j0 < n; j0 += block) {
+      const size_t j1 = std::min(n, j0 + block);
+      for (size_t i = first; i < last; ++i) {
+        Type* c_row = c + i * n;
+        if (!trans_b) {
+          for (size_t p = p0; p < p1; ++p) {
+            const Type factor =
+                alpha * (trans_a ? a[p * m + i] : a[i * k + p]);
+            const Type* b_row = b + p * n;
+            for (size_t j = j0; j < j1; ++j) {
+              c_row[j] += factor * b_row[j];
+            }
+          }
+        } else {
+          for (size_t j = j0; j < j1; ++j) {
+            const Type* b_row = b + j * k;
+            Type sum = 0;
+            for (size_t p = p0; p < p1; ++p) {
+              sum += (trans_a ? a[p * m + i] : a[i * k + p]) * b_row[p];
+            }
+            c_row[j] += alpha * sum;
+          }
+        }
+      }
+    }
+  }
+}
+
+/**
+ * @brief Transposes row-major "source" of rows*cols into "target" by square
+ * tiles, so both buffers are walked within cache lines
+ *
+ */
+template <arithmetic Type>
+void Matrix<Type>::TransposeBuffer(const Type* source, Type* target,
+                                   size_t rows, size_t cols,
+                                   const TuningParameters& parameters) {
+  const size_t tile = static_cast<size_t>(parameters.transpose_tile);
+  auto tiles = [&](int first, int last) {
+    const size_t end = static_cast<size_t>(last);
+    for (size_t i0 = static_cast<size_t>(first); i0 < end; i0 += tile) {
+      const size_t i1 = std::min(end, i0 + tile);
+      for (size_t j0 = 0; j0 < cols; j0 += tile) {
+        const size_t j1 = std::min(cols, j0 + tile);
+        for (size_t i = i0; i < i1; ++i) {
+          for (size_t j = j0; j < j1; ++j) {
+            target[j * rows + i] = source[i * cols + j];
+          }
+        }
+      }
+    }
+  };
+
+  if (rows * cols >= kParallelElements) {
+    ParallelFor(0, static_cast<int>(rows), parameters.threads, tiles);
+  } else {
+    tiles(0, static_cast<int>(rows));
+  }
+}
+
+/**
+ * @brief Returns tuning parameters of the element type. They are read from
+ * tuning cache at first use, defaults are used if cache has no entry
+ *
+ */
+template <arithmetic Type>
+TuningState& Matrix<Type>::Tuning() {
+  static TuningState state([] {
+    TuningParameters parameters;
+    LoadTuning(TuningCachePath(), TuningKey<Type>(), &parameters);
+    return parameters;
+  }());
+  return state;
+}
+
+/**
+ * @brief Returns tuning parameters of native kernels for the element type
+ *
+ * @return TuningParameters
+ */
+template <arithmetic Type>
+TuningParameters Matrix<Type>::tuning() {
+  return Tuning().Load();
+}
+
+/**
+ * @brief Sets tuning parameters of native kernels for the element type
+ *
+ * @param parameters const TuningParameters& type
+ */
+template <arithmetic Type>
+void Matrix<Type>::set_tuning(const TuningParameters& parameters) {
+  if (parameters.gemm_block < 1 || parameters.tall_gemm_block < 1 ||
+      parameters.wide_gemm_block < 1 || parameters.transpose_tile < 1 ||
+      parameters.threads < 0) {
+    throw invalid_argument("Non-positive tuning parameter");
+  }
+  Tuning().Store(parameters);
+}
+
+/**
+ * @brief Returns the best time of "repeats" runs of "body" in seconds
+ *
+ */
+template <arithmetic Type>
+template <class Body>
+double Matrix<Type>::BestTime(int repeats, Body body) {
+  double best = std::numeric_limits<double>::max();
+  for (int i = 0; i < repeats; ++i) {
+    const auto start = std::chrono::steady_clock::now();
+    body();
+    const std::chrono::duration<double> time =
+        std::chrono::steady_clock::now() - start;
+    best = std::min(best, time.count());
+  }
+  return best;
+}
+
+/**
+ * @brief Benchmarks native kernels: cache block of Gemm and the smallest
+ * Gemm worth splitting between threads for each GemmShape, amount of
+ * threads and tile of Transpose. Shapes are timed on products of equal
+ * amount of operations: size*size by size*size, 2size*size by size*size/2
+ * and size/2*size by size*2size. Winners are set as current tuning and
+ * stored in tuning cache under processor model and element type. BLAS
+ * backend is not tuned, as it is used whenever available
+ *
+ * @param options const AutotuneOptions& type
+ * @return TuningParameters winners
+ */
+template <arithmetic Type>
+TuningParameters Matrix<Type>::Autotune(const AutotuneOptions& options) {
+  if (options.size < 1 || options.repeats < 1) {
+    throw invalid_argument("Autotuning of empty benchmark");
+  }
+  const size_t size = static_cast<size_t>(options.size);
+  const size_t half = std::max<size_t>(size / 2, 1);
+  Matrix<Type> a(2 * options.size, options.size),
+      b(options.size, 2 * options.size), c(options.size, options.size);
+  Type* left = a.data();
+  Type* right = b.data();
+  Type* result = c.data();
+  for (size_t i = 0; i < a.size(); ++i) {
+    left[i] = static_cast<Type>(i % 7);
+    right[i] = static_cast<Type>(i % 5);
+  }
+  // m, n and k of the product timed for each shape class
+  const std::vector<std::pair<GemmShape, std::array<size_t, 3>>> shapes = {
+      {GemmShape::kSquare, {size, size, size}},
+      {GemmShape::kTall, {2 * size, half, size}},
+      {GemmShape::kWide, {half, 2 * size, size}}};
+  auto gemm = [&](const TuningParameters& parameters,
+                  const std::array<size_t, 3>& dims) {
+    return BestTime(options.repeats, [&] {
+      NativeGemm(1, left, false, right, false, 0, result, dims[0], dims[1],
+                 dims[2], parameters);
+    });
+  };
+  auto choose = [](const std::vector<int>& candidates, auto time) {
+    int best = candidates.front();
+    double best_time = std::numeric_limits<double>::max();
+    for (int candidate : candidates) {
+      const double candidate_time = time(candidate);
+      if (candidate_time < best_time) {
+        best = candidate;
+        best_time = candidate_time;
+      }
+    }
+    return best;
+  };
+
+  TuningParameters best = Tuning().Load();
+  for (const auto& [shape, dims] : shapes) {
+    best.GemmBlock(shape) = choose({32, 64, 128, 256, 512}, [&](int block) {
+      TuningParameters parameters = best;
+      parameters.GemmBlock(shape) = block;
+      return gemm(parameters, dims);
+    });
+  }
+
+  const int hardware = HardwareThreads();
+  std::vector<int> threads;
+  for (int count = 1; count < hardware; count *= 2) {
+    threads.push_back(count);
+  }
+  threads.push_back(hardware);
+  const int threads_count = choose(threads, [&](int count) {
+    TuningParameters parameters = best;
+    parameters.threads = count;
+    parameters.parallel_elements = 0;
+    return gemm(parameters, shapes.front().second);
+  });
+  best.threads = threads_count == hardware ? 0 : threads_count;
+
+  if (threads_count > 1) {
+    for (const auto& [shape, dims] : shapes) {
+      size_t& threshold = best.ParallelElements(shape);
+      threshold = dims[0] * dims[1] * dims[2];
+      for (std::array<size_t, 3> scaled = dims;
+           scaled[0] >= 8 && scaled[1] >= 8;
+           scaled = {scaled[0] / 2, scaled[1] / 2, scaled[2] / 2}) {
+        TuningParameters serial = best, parallel = best;
+        serial.ParallelElements(shape) = std::numeric_limits<size_t>::max();
+        parallel.ParallelElements(shape) = 0;
+        if (gemm(parallel, scaled) >= gemm(serial, scaled)) {
+          break;
+        }
+        threshold = scaled[0] * scaled[1] * scaled[2];
+      }
+    }
+  }
+
+  best.transpose_tile = choose({8, 16, 32, 64, 128}, [&](int tile) {
+    TuningParameters parameters = best;
+    parameters.transpose_tile = tile;
+    return BestTime(options.repeats, [&] {
+      TransposeBuffer(left, result, size, size, parameters);
+    });
+  });
+
+  Tuning().Store(best);
+  if (options.persist) {
+    StoreTuning(options.cache_path, TuningKey<Type>(), best);
+  }
+  return best;
+}
+
+/**
+ * @brief LU factorization with partial pivoting of square "lu" in place.
+ * Native elimination addresses rows through "order" and permutes data once
+ *
+ */
+template <arithmetic Type>
+void Matrix<Type>::LuFactor(Matrix<Type>* lu, Permutation* order) {
+  const size_t n = static_cast<size_t>(lu->rows_);
+  Type* values = lu->MutableData();
+  std::vector<int> pivots(n);
+  int info = 0;
+
+  if (LapackLuFactor(values, n, pivots.data(), &info)) {
+    *order = Permutation::FromPivots(pivots);
+  } else {
+    *order = Permutation(lu->rows_);
+    auto permuted_row = [values, n, order](size_t i) {
+      return values + static_cast<size_t>((*order)[static_cast<int>(i)]) * n;
+    };
+    for (size_t col = 0; col < n && info == 0; ++col) {
+      size_t pivot = col;
+      for (size_t i = col + 1; i < n; ++i) {
+        if (std::abs(permuted_row(i)[col]) >
+            std::abs(permuted_row(pivot)[col])) {
+          pivot = i;
+        }
+      }
+      if (permuted_row(pivot)[col] == 0) {
+        info = 1;
+        break;
+      }
+      order->Swap(static_cast<int>(col), static_cast<int>(pivot));
+
+      const Type* pivot_row = permuted_row(col);
+      auto eliminate = [&](int first, int last) {
+        for (size_t i = col + 1 + static_cast<size_t>(first);
+             i < col + 1 + static_cast<size_t>(last); ++i) {
+          Type* target = permuted_row(i);
+          target[col] /= pivot_row[col];
+          for (size_t j = col + 1; j < n; ++j) {
+            target[j] -= target[col] * pivot_row[j];
+          }
+        }
+      };
+      const size_t rest = n - col - 1;
+      ForEachPart(static_cast<int>(rest), rest * rest, eliminate);
+    }
+    lu->Permute(*order);
+  }
+
+  if (info != 0) {
+    throw invalid_argument("Solving system with singular matrix");
+  }
+}
+
+/**
+ * @brief Solves system by LuFactor result in place of "b"
+ *
+ */
+template <arithmetic Type>
+void Matrix<Type>::LuSolve(const Matrix<Type>& lu, const Permutation& order,
+                           Matrix<Type>* b) {
+  const size_t n = static_cast<size_t>(lu.rows_);
+  const size_t nrhs = static_cast<size_t>(b->cols_);
+  b->Permute(order);
+  const Type* factors = lu.data();
+  Type* values = b->MutableData();
+
+  if (!BlasTriangularSolve(true, factors, values, n, nrhs)) {
+    for (size_t i = 0; i < n; ++i) {
+      for (size_t p = 0; p < i; ++p) {
+        for (size_t j = 0; j < nrhs; ++j) {
+          values[i * nrhs + j] -= factors[i * n + p] * values[p * nrhs + j];
+        }
+      }
+    }
+  }
+  if (!BlasTriangularSolve(false, factors, values, n, nrhs)) {
+    for (size_t i = n; i-- > 0;) {
+      for (size_t p = i + 1; p < n; ++p) {
+        for (size_t j = 0; j < nrhs; ++j) {
+          values[i * nrhs + j] -= factors[i * n + p] * values[p * nrhs + j];
+        }
+      }
+      for (size_t j = 0; j < nrhs; ++j) {
+        values[i * nrhs + j] /= factors[i * n + i];
+      }
+    }
+  }
+}
+
+template <arithmetic Type>
+Matrix<Type> Matrix<Type>::Identity(int size) {
+  Matrix<Type> returnable(size, size);
+  for (int i = 0; i < size; ++i) {
+    returnable(i, i) = 1;
+  }
+
+  return returnable;
+}
+
+/**
+ * @brief Returns maximum absolute column sum
+ *
+ */
+template <arithmetic Type>
+Type Matrix<Type>::NormOne() const
+  requires std::floating_point<Type>
+{
+  std::vector<Type> sums(static_cast<size_t>(cols_));
   for (int i = 0; i < rows_; ++i) {
-    matrix_[i] = RowPtr(new Type[cols_]);
-    memset(matrix_[i].get(), 0, sizeof(Type) * static_cast<size_t>(cols_));
+    std::span<const Type> values = row(i);
+    for (size_t j = 0; j < sums.size(); ++j) {
+      sums[j] += std::abs(values[j]);
+    }
+  }
+
+  return *std::max_element(sums.begin(), sums.end());
+}
+
+/**
+ * @brief Diagonal Pade approximant r = (v - u)^-1 * (v + u) of exponential,
+ * where "u" holds odd and "v" even powers. Degree 13 evaluates the
+ * polynomials from 2, 4 and 6 powers with 6 multiplications
+ *
+ * @param degree int type 3, 5, 7, 9 or 13
+ */
+template <arithmetic Type>
+Matrix<Type> Matrix<Type>::PadeApproximant(int degree) const
+  requires std::floating_point<Type>
+{
+  static constexpr double kDegree3[] = {120, 60, 12, 1};
+  static constexpr double kDegree5[] = {30240, 15120, 3360, 420, 30, 1};
+  static constexpr double kDegree7[] = {17297280, 8648640, 1995840, 277200,
+                                        25200,    1512,    56,      1};
+  static constexpr double kDegree9[] = {
+      17643225600, 8821612800, 2075673600, 302702400, 30270240,
+      2162160,     110880,     3960,       90,        1};
+  static constexpr double kDegree13[] = {
+      64764752532480000, 32382376266240000, 7771770303897600,
+      1187353796428800,  129060195264000,   10559470521600,
+      670442572800,      33522128640,       1323241920,
+      40840800,          960960,            16380,
+      182,               1};
+  const Matrix<Type> identity = Identity(rows_);
+  const Matrix<Type> square = *this * *this;
+  Matrix<Type> odd(rows_, cols_), even(rows_, cols_);
+
+  if (degree == 13) {
+    const double* b = kDegree13;
+    const Matrix<Type> fourth = square * square;
+    const Matrix<Type> sixth = fourth * square;
+    odd = sixth * (sixth * b[13] + fourth * b[11] + square * b[9]) +
+          sixth * b[7] + fourth * b[5] + square * b[3] + identity * b[1];
+    even = sixth * (sixth * b[12] + fourth * b[10] + square * b[8]) +
+           sixth * b[6] + fourth * b[4] + square * b[2] + identity * b[0];
+  } else {
+    using Coefficients = std::span<const double>;
+    const Coefficients b = degree == 3   ? Coefficients(kDegree3)
+                           : degree == 5 ? Coefficients(kDegree5)
+                           : degree == 7 ? Coefficients(kDegree7)
+                                         : Coefficients(kDegree9);
+    Matrix<Type> power = identity;
+    for (size_t k = 0; 2 * k < b.size(); ++k) {
+      if (k > 0) {
+        power = k == 1 ? square : power * square;
+      }
+      odd += power * b[2 * k + 1];
+      even += power * b[2 * k];
+    }
   }
+  const Matrix<Type> u = *this * odd;
+
+  return (even - u).Solve(even + u);
 }
 
+/**
+ * @brief Checks whether "other" has the same size, is 1*cols row vector or
+ * rows*1 column vector
+ *
+ */
 template <arithmetic Type>
-void Matrix<Type>::IsInputFileOpened(const ifstream& file) {
+bool Matrix<Type>::IsBroadcastable(const Matrix<Type>& other) const {
+  return (other.rows_ == rows_ || other.rows_ == 1) &&
+         (other.cols_ == cols_ || other.cols_ == 1) &&
+         (other.rows_ == rows_ || other.cols_ == cols_);
+}
+
+/**
+ * @brief Replaces every element by operation(element, other element) in one
+ * pass over row blocks. Row or column vector "other" is broadcast
+ *
+ */
+template <arithmetic Type>
+template <class Operation>
+void Matrix<Type>::ApplyElementwise(const Matrix<Type>& other,
+                                    Operation operation) {
+  Type* target = MutableData();
+  const Type* source = other.data();
+  const size_t cols = static_cast<size_t>(cols_);
+  const bool is_full = other.rows_ == rows_ && other.cols_ == cols_;
+  const bool is_row = !is_full && other.cols_ == cols_;
+
+  ForEachRowBlock(rows_, cols, [&](int first, int last) {
+    if (is_full) {
+      const size_t begin = static_cast<size_t>(first) * cols;
+      const size_t end = static_cast<size_t>(last) * cols;
+      std::transform(target + begin, target + end, source + begin,
+                     target + begin, operation);
+      return;
+    }
+    for (size_t i = static_cast<size_t>(first); i < static_cast<size_t>(last);
+         ++i) {
+      Type* row = target + i * cols;
+      if (is_row) {
+        std::transform(row, row + cols, source, row, operation);
+      } else {
+        const Type value = source[i];
+        std::transform(row, row + cols, row, [&operation, value](Type left) {
+          return operation(left, value);
+        });
+      }
+    }
+  });
+}
+
+/**
+ * @brief Replaces every element by operation(element) in one pass over row
+ * blocks
+ *
+ */
+template <arithmetic Type>
+template <class Operation>
+void Matrix<Type>::ApplyEach(Operation operation) {
+  Type* values = MutableData();
+  const size_t cols = static_cast<size_t>(cols_);
+
+  ForEachRowBlock(rows_, cols, [&](int first, int last) {
+    Type* begin = values + static_cast<size_t>(first) * cols;
+    Type* end = values + static_cast<size_t>(last) * cols;
+    std::transform(begin, end, begin, operation);
+  });
+}
+
+template <arithmetic Type>
+void Matrix<Type>::Detach() {
+  if (matrix_.use_count() > 1) {
+    CopyData(matrix_);
+  } else {
+    // Pairs with release by the last other owner, e.g. background saver
+    std::atomic_thread_fence(std::memory_order_acquire);
+  }
+}
+
+template <arithmetic Type>
+void Matrix<Type>::CopyData(const MatrixPtr& source) {
+  MatrixPtr buffer = Allocate(size());
+  Type* target = buffer.get();
+  const size_t cols = static_cast<size_t>(cols_);
+
+  ForEachRowBlock(rows_, cols, [&target, &source, cols](int first, int last) {
+    memcpy(target + static_cast<size_t>(first) * cols,
+           source.get() + static_cast<size_t>(first) * cols,
+           sizeof(Type) * static_cast<size_t>(last - first) * cols);
+  });
+  matrix_.swap(buffer);
+}
+
+template <arithmetic Type>
+void Matrix<Type>::Resize(int rows, int cols) {
+  MatrixPtr source;
+  source.swap(matrix_);
+  const int common_rows = std::min(rows, rows_);
+  const size_t common_cols = static_cast<size_t>(std::min(cols, cols_));
+  const size_t old_cols = static_cast<size_t>(cols_);
+
+  rows_ = rows;
+  cols_ = cols;
+  InitMatrix(true);
+  Type* target = matrix_.get();
+  for (size_t i = 0; i < static_cast<size_t>(common_rows); ++i) {
+    memcpy(target + i * static_cast<size_t>(cols), source.get() + i * old_cols,
+           sizeof(Type) * common_cols);
+  }
+}
+
+template <arithmetic Type>
+void Matrix<Type>::CheckIndex(int i, int j) const {
+  if (i < 0 || i >= rows_ || j < 0 || j >= cols_) {
+    throw out_of_range("Setting element that is out of matrix range");
+  }
+}
+
+template <arithmetic Type>
+void Matrix<Type>::IsInputFileOpened(const ifstream& file) const {
   if (!file.is_open()) {
     throw invalid_argument("File cuold not be opened.");
   }
 }
 
 template <arithmetic Type>
-void Matrix<Type>::IsOutputFileOpened(const ofstream& file) {
+void Matrix<Type>::IsOutputFileOpened(const ofstream& file) const {
   if (!file.is_open()) {
     throw invalid_argument("File could not be opened.");
   }
 }
 
 template <arithmetic Type>
-void Matrix<Type>::ReadMatrixSize(ifstream& file) {
+bool Matrix<Type>::IsCompressedFile(ifstream& file) const {
+  char magic[2] = {0, 0};
+  file.read(magic, 2);
+  bool is_compressed = file.gcount() == 2 &&
+                       static_cast<unsigned char>(magic[0]) == 0x1f &&
+                       static_cast<unsigned char>(magic[1]) == 0x8b;
+  file.clear();
+  file.seekg(0);
+
+  return is_compressed;
+}
+
+template <arithmetic Type>
+typename Matrix<Type>::Str Matrix<Type>::ReadCompressedFile(
+    const Str& file_path) const {
+#ifdef MATRIX_WITH_ZLIB
+  std::unique_ptr<gzFile_s, decltype(&gzclose)> file(
+      gzopen(file_path.c_str(), "rb"), &gzclose);
+  if (!file) {
+    throw invalid_argument("File cuold not be opened.");
+  }
+  Str content;
+  Str chunk(kWriteBlockBytes, '\0');
+  int read = 0;
+  while ((read = gzread(file.get(), chunk.data(),
+                        static_cast<unsigned>(chunk.size()))) > 0) {
+    content.append(chunk.data(), static_cast<size_t>(read));
+  }
+  if (read < 0) {
+    throw invalid_argument("Compressed file is corrupted");
+  }
+
+  return content;
+#else
+  throw invalid_argument("Compressed loading requires MATRIX_WITH_ZLIB: " +
+                         file_path);
+#endif
+}
+
+template <arithmetic Type>
+void Matrix<Type>::ReadMatrixSize(std::istream& file) {
   Str line;
   getline(file, line, '\n');
   int rows = 0, cols = 0;
-  sscanf(line.data(), "%d %d", &rows, &cols);
+  std::istringstream(line) >> rows >> cols;
 
   if (rows < 1 || cols < 1) {
-    file.close();
     throw invalid_argument("Incorrect matrix size");
   }
   set_rows(static_cast<int>(rows));
@@ -482,59 +1741,153 @@ void Matrix<Type>::ReadMatrixSize(ifstream& file) {
 }
 
 template <arithmetic Type>
-void Matrix<Type>::ReadMatrix(ifstream& file) {
+void Matrix<Type>::ReadMatrix(std::istream& file) {
   Str line;
+  Type* values = MutableData();
+  const size_t cols = static_cast<size_t>(cols_);
   int row = 0;
-  int rows = this->rows();
-  while (getline(file, line, '\n') && row < rows) {
-    ReadLineToMatrixRow(line, row);
+  while (row < rows_ && getline(file, line, '\n')) {
+    ReadLineToMatrixRow(line, std::span<Type>(
+                                  values + static_cast<size_t>(row) * cols,
+                                  cols));
     ++row;
   }
 }
 
+/**
+ * @brief Parses numbers of "line" to "target" row, extra numbers are ignored.
+ * Numbers are runs of number chars separated by any other chars. Touches
+ * only "target" memory and never reads past the end of "line"
+ *
+ */
 template <arithmetic Type>
-void Matrix<Type>::ReadLineToMatrixRow(const Str& line, int row) {
-  int col = 0;
-  for (int i = 0; i < static_cast<int>(line.size()); ++i) {
-    const char* number = &(line.data())[i];
-    this->operator()(row, col) = atof(number);
-    ++col;
+void Matrix<Type>::ReadLineToMatrixRow(const Str& line,
+                                       std::span<Type> target) {
+  size_t i = 0;
+  if (!line.empty() && !IsNumberChar(line[0])) {
+    ShiftToNextNumber(line, &i);
+  }
+  for (size_t col = 0; i < line.size() && col < target.size(); ++col) {
+    target[col] = ParseNumber(line.c_str() + i);
     ShiftToNextNumber(line, &i);
   }
 }
 
+/**
+ * @brief Moves "i" past number chars and separators following them to the
+ * beginning of the next number or to the end of "line"
+ *
+ */
 template <arithmetic Type>
-void Matrix<Type>::ShiftToNextNumber(const Str& line, int* i) {
-  while (IsNumberChar(line.data()[*i]) && *i < static_cast<int>(line.size())) {
+void Matrix<Type>::ShiftToNextNumber(const Str& line, size_t* i) {
+  while (*i < line.size() && IsNumberChar(line[*i])) {
     ++(*i);
   }
-  while (!IsNumberChar(line.data()[*i]) && *i < static_cast<int>(line.size())) {
+  while (*i < line.size() && !IsNumberChar(line[*i])) {
     ++(*i);
   }
-  --(*i);
 }
 
 template <arithmetic Type>
 bool Matrix<Type>::IsNumberChar(char sym) {
-  return isdigit(sym) || sym == '.' || sym == '-' || sym == '+' || sym == 'e';
+  return isdigit(static_cast<unsigned char>(sym)) || sym == '.' ||
+         sym == '-' || sym == '+' || sym == 'e';
 }
 
+/**
+ * @brief Converts number at the beginning of null-terminated "number",
+ * values out of "Type" range are saturated instead of undefined conversion
+ *
+ */
 template <arithmetic Type>
-void Matrix<Type>::WriteMatrixSize(ofstream& file) {
-  file << rows() << " " << cols() << "\n";
+Type Matrix<Type>::ParseNumber(const char* number) {
+  using Limits = std::numeric_limits<Type>;
+  const double value = atof(number);
+  if constexpr (std::is_integral_v<Type>) {
+    if (std::isnan(value)) {
+      return 0;
+    }
+    if (value <= static_cast<double>(Limits::lowest())) {
+      return Limits::lowest();
+    }
+    if (value >= static_cast<double>(Limits::max())) {
+      return Limits::max();
+    }
+  } else if (std::isfinite(value) &&
+             std::abs(value) > static_cast<double>(Limits::max())) {
+    return value > 0 ? Limits::infinity() : -Limits::infinity();
+  }
+
+  return static_cast<Type>(value);
 }
 
 template <arithmetic Type>
-void Matrix<Type>::WriteMatrix(ofstream& file) {
-  for (int i = 0; i < rows(); ++i) {
-    for (int j = 0; j < cols(); ++j) {
-      if (this->operator()(i, j) == 0) {
-        this->operator()(i, j) = 0;
+void Matrix<Type>::WriteMatrix(const std::function<void(const Str&)>& write,
+                               const SaveOptions& options) const {
+  write(std::to_string(rows_) + " " + std::to_string(cols_) + "\n");
+
+  const int threads = options.threads > 0 ? options.threads : HardwareThreads();
+  const size_t row_bytes = static_cast<size_t>(cols_) * 16 + 1;
+  const int block_rows =
+      static_cast<int>(std::max<size_t>(1, kWriteBlockBytes / row_bytes));
+  std::vector<Str> blocks(static_cast<size_t>(threads));
+
+  for (int batch = 0; batch < rows_; batch += block_rows * threads) {
+    const int batch_blocks =
+        std::min(threads, (rows_ - batch + block_rows - 1) / block_rows);
+    ParallelFor(0, batch_blocks, threads, [&](int first, int last) {
+      for (int block = first; block < last; ++block) {
+        const int first_row = batch + block * block_rows;
+        FormatRows(first_row, std::min(rows_, first_row + block_rows),
+                   options.precision, &blocks[static_cast<size_t>(block)]);
       }
-      file << this->operator()(i, j) << " ";
+    });
+    for (int block = 0; block < batch_blocks; ++block) {
+      write(blocks[static_cast<size_t>(block)]);
+    }
+  }
+}
+
+template <arithmetic Type>
+void Matrix<Type>::FormatRows(int first, int last, int precision,
+                              Str* out) const {
+  char number[kNumberBufferSize];
+  out->clear();
+  for (int i = first; i < last; ++i) {
+    for (Type value : row(i)) {
+      char* end =
+          FormatNumber(value, precision, number, number + sizeof(number));
+      *end++ = ' ';
+      out->append(number, end);
+    }
+    out->push_back('\n');
+  }
+}
+
+template <arithmetic Type>
+char* Matrix<Type>::FormatNumber(Type value, int precision, char* first,
+                                 char* last) {
+  std::to_chars_result result;
+  if constexpr (std::is_same_v<Type, bool>) {
+    result = std::to_chars(first, last - 1, static_cast<int>(value));
+  } else if constexpr (std::is_floating_point_v<Type>) {
+    if (value == 0) {
+      value = 0;
+    }
+    if (precision < 0) {
+      result = std::to_chars(first, last - 1, value);
+    } else {
+      result = std::to_chars(first, last - 1, value, std::chars_format::fixed,
+                             precision);
     }
-    file << "\n";
+  } else {
+    result = std::to_chars(first, last - 1, value);
   }
+  if (result.ec != std::errc()) {
+    throw std::runtime_error("Number could not be formatted");
+  }
+
+  return result.ptr;
 }
 
 }  // namespace hhullen
@@ -1,19 +1,43 @@
 #ifndef SRC_MATRIX_H_
 #define SRC_MATRIX_H_
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <chrono>
 #include <cmath>
+#include <concepts>
 #include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <iostream>
+#include <limits>
 #include <memory>
+#include <span>
+#include <sstream>
 #include <string>
+#include <utility>
+#include <vector>
+
+#ifdef MATRIX_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#include "async_io.h"
+#include "blas_backend.h"
+#include "parallel.h"
+#include "permutation.h"
+#include "tuning.h"
 
 using std::atof;
 using std::getline;
 using std::ifstream;
 using std::invalid_argument;
 using std::isdigit;
+using std::memcpy;
 using std::memset;
 using std::ofstream;
 using std::out_of_range;
@@ -25,35 +49,101 @@ concept arithmetic = requires(T var) {
   std::is_arithmetic_v<T>;
 };
 
+template <arithmetic Type>
+class Pipeline;
+
+/**
+ * @brief Dense row-major matrix with copy-on-write storage.
+ *
+ * Threading model: const member functions never modify shared state, so any
+ * amount of threads may call them on one object concurrently, together with
+ * library kernels which read it. Non-const member functions, including
+ * non-const operator(), at(), data(), row() and iterators, are writes: they
+ * require exclusive access to the object. Different objects sharing one
+ * buffer may be used from different threads freely, first write to each of
+ * them copies the buffer
+ *
+ */
 template <arithmetic Type>
 class Matrix {
-  using RowPtr = std::shared_ptr<Type[]>;
-  using MatrixPtr = std::shared_ptr<RowPtr[]>;
+  using MatrixPtr = std::shared_ptr<Type[]>;
   using Str = std::string;
 
+  template <arithmetic OtherType>
+  friend class Pipeline;
+
  public:
+  using value_type = Type;
+  using iterator = Type*;
+  using const_iterator = const Type*;
+
+  struct SaveOptions {
+    int precision = -1;
+    int threads = 0;
+    bool compress = false;
+  };
+
+  struct AutotuneOptions {
+    int size = 512;
+    int repeats = 3;
+    bool persist = true;
+    Str cache_path = TuningCachePath();
+  };
+
   Matrix();
   Matrix(int rows, int cols);
+  Matrix(int rows, int cols, MemoryPolicy policy);
   Matrix(const Matrix<Type>& other);
   Matrix(Matrix<Type>&& other);
   ~Matrix();
 
+  Matrix<Type> Clone() const;
+  bool IsShared() const;
+
   void Load(const Str& file_path);
-  void Save(const Str& file_path);
+  void Save(const Str& file_path) const;
+  void Save(const Str& file_path, const SaveOptions& options) const;
+  static std::future<Matrix<Type>> LoadAsync(const Str& file_path,
+                                             IoCallback on_done = nullptr);
+  std::future<IoStats> SaveAsync(const Str& file_path,
+                                 const SaveOptions& options = SaveOptions(),
+                                 IoCallback on_done = nullptr) const;
 
   int rows() const;
   int cols() const;
+  MemoryPolicy memory_policy() const;
   void set_rows(int new_val);
   void set_cols(int new_val);
 
   void SwapRows(const int row_1, const int row_2);
   void ProcessRows(const int row_1, const int row_2,
                    const std::function<void(Type&, Type&)>& lambda);
+  void ProcessRows(const int row_1, const int row_2,
+                   const std::function<void(Type&, Type&)>& lambda,
+                   const Permutation& order);
   void ProcessRow(const int row, const std::function<void(Type&)>& lambda);
   void ProcessEach(const std::function<void(Type&)>& lambda);
   void HadamardProduct(const Matrix<Type>& other);
+  void HadamardDivision(const Matrix<Type>& other);
   Matrix<Type> Transpose() const;
   void set(int i, int j, Type value);
+  static void Gemm(Type alpha, const Matrix<Type>& a, bool trans_a,
+                   const Matrix<Type>& b, bool trans_b, Type beta,
+                   Matrix<Type>* c);
+  static void Gemv(Type alpha, const Matrix<Type>& a, bool trans_a,
+                   std::span<const Type> x, Type beta, std::span<Type> y);
+  Matrix<Type> Solve(const Matrix<Type>& b) const
+    requires std::floating_point<Type>;
+  Matrix<Type> Lu(Permutation* order) const
+    requires std::floating_point<Type>;
+  Matrix<Type> Power(int k) const;
+  Matrix<Type> Exp() const
+    requires std::floating_point<Type>;
+  void Permute(const Permutation& order);
+  static TuningParameters tuning();
+  static void set_tuning(const TuningParameters& parameters);
+  static TuningParameters Autotune(
+      const AutotuneOptions& options = AutotuneOptions());
 
   bool operator==(const Matrix<Type>& other) const;
   bool operator!=(const Matrix<Type>& other) const;
@@ -62,30 +152,105 @@ class Matrix {
   Matrix<Type> operator-(const Matrix<Type>& other) const;
   Matrix<Type> operator*(const Matrix<Type>& other) const;
   template <arithmetic Val>
+  Matrix<Type> operator+(const Val value) const;
+  template <arithmetic Val>
+  Matrix<Type> operator-(const Val value) const;
+  template <arithmetic Val>
   Matrix<Type> operator*(const Val value) const;
+  template <arithmetic Val>
+  Matrix<Type> operator/(const Val value) const;
   Matrix<Type> operator+=(const Matrix<Type>& other);
   Matrix<Type> operator-=(const Matrix<Type>& other);
   Matrix<Type> operator*=(const Matrix<Type>& other);
   template <arithmetic Val>
+  Matrix<Type> operator+=(const Val value);
+  template <arithmetic Val>
+  Matrix<Type> operator-=(const Val value);
+  template <arithmetic Val>
   Matrix<Type> operator*=(const Val value);
+  template <arithmetic Val>
+  Matrix<Type> operator/=(const Val value);
   Type& operator()(int i, int j);
   Type operator()(int i, int j) const;
 
+  Type& at(int i, int j);
+  Type at(int i, int j) const;
+  size_t size() const;
+  Type* data();
+  const Type* data() const;
+  Type* MutableData();
+  std::span<Type> row(int i);
+  std::span<const Type> row(int i) const;
+  iterator begin();
+  iterator end();
+  const_iterator begin() const;
+  const_iterator end() const;
+  const_iterator cbegin() const;
+  const_iterator cend() const;
+
  private:
   int rows_, cols_;
   MatrixPtr matrix_;
-  const double kAccuracy = 0.000001 * std::is_floating_point_v<Type>;
+  MemoryPolicy policy_ = MemoryPolicy::kFirstTouch;
+  const double kAccuracy = 0.000001;
+  static constexpr int kMaxPrecision = 64;
+  static constexpr size_t kNumberBufferSize =
+      std::numeric_limits<Type>::max_exponent10 + kMaxPrecision + 16;
+  static constexpr size_t kWriteBlockBytes = 1 << 20;
+
+  struct Uninitialized {};
+  Matrix(int rows, int cols, MemoryPolicy policy, Uninitialized);
 
   void InitMatrix(bool fill_with_zero = false);
-  void IsInputFileOpened(const ifstream& file);
-  void IsOutputFileOpened(const ofstream& file);
-  void ReadMatrixSize(ifstream& file);
-  void ReadMatrix(ifstream& file);
-  void ReadLineToMatrixRow(const Str& line, int row);
-  void ShiftToNextNumber(const Str& line, int* i);
-  bool IsNumberChar(char sym);
-  void WriteMatrixSize(ofstream& file);
-  void WriteMatrix(ofstream& file);
+  MatrixPtr Allocate(size_t count) const;
+  bool IsBroadcastable(const Matrix<Type>& other) const;
+  template <class Operation>
+  void ApplyElementwise(const Matrix<Type>& other, Operation operation);
+  template <class Operation>
+  void ApplyEach(Operation operation);
+  static void GemmKernel(Type alpha, const Type* a, bool trans_a,
+                         const Type* b, bool trans_b, Type beta, Type* c,
+                         size_t m, size_t n, size_t k);
+  static void NativeGemm(Type alpha, const Type* a, bool trans_a,
+                         const Type* b, bool trans_b, Type beta, Type* c,
+                         size_t m, size_t n, size_t k,
+                         const TuningParameters& parameters);
+  static void GemmRows(Type alpha, const Type* a, bool trans_a, const Type* b,
+                       bool trans_b, Type beta, Type* c, size_t m, size_t n,
+                       size_t k, size_t block, size_t first, size_t last);
+  static void TransposeBuffer(const Type* source, Type* target, size_t rows,
+                              size_t cols,
+                              const TuningParameters& parameters);
+  static TuningState& Tuning();
+  template <class Body>
+  static double BestTime(int repeats, Body body);
+  static void LuFactor(Matrix<Type>* lu, Permutation* order);
+  static void LuSolve(const Matrix<Type>& lu, const Permutation& order,
+                      Matrix<Type>* b);
+  static Matrix<Type> Identity(int size);
+  Type NormOne() const
+    requires std::floating_point<Type>;
+  Matrix<Type> PadeApproximant(int degree) const
+    requires std::floating_point<Type>;
+  void Detach();
+  void CopyData(const MatrixPtr& source);
+  void Resize(int rows, int cols);
+  void CheckIndex(int i, int j) const;
+  void IsInputFileOpened(const ifstream& file) const;
+  void IsOutputFileOpened(const ofstream& file) const;
+  bool IsCompressedFile(ifstream& file) const;
+  Str ReadCompressedFile(const Str& file_path) const;
+  void ReadMatrixSize(std::istream& file);
+  void ReadMatrix(std::istream& file);
+  static void ReadLineToMatrixRow(const Str& line, std::span<Type> target);
+  static void ShiftToNextNumber(const Str& line, size_t* i);
+  static bool IsNumberChar(char sym);
+  static Type ParseNumber(const char* number);
+  void WriteMatrix(const std::function<void(const Str&)>& write,
+                   const SaveOptions& options) const;
+  void FormatRows(int first, int last, int precision, Str* out) const;
+  static char* FormatNumber(Type value, int precision, char* first,
+                            char* last);
 };
 
 }  // namespace hhullen
@@ -0,0 +1,158 @@
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "layout_matrix.cc"
+#include "matrix.cc"
+
+using hhullen::LayoutMatrix;
+using hhullen::Matrix;
+
+/**
+ * @brief Counts L1 data cache read misses of the calling thread through
+ * perf_event_open, count is -1 when counters are not available
+ *
+ */
+class CacheMisses {
+ public:
+  CacheMisses() {
+#ifdef __linux__
+    perf_event_attr attributes;
+    std::memset(&attributes, 0, sizeof(attributes));
+    attributes.type = PERF_TYPE_HW_CACHE;
+    attributes.size = sizeof(attributes);
+    attributes.config = PERF_COUNT_HW_CACHE_L1D |
+                        (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                        (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    descriptor_ = static_cast<int>(
+        syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#endif
+  }
+  CacheMisses(const CacheMisses&) = delete;
+  CacheMisses& operator=(const CacheMisses&) = delete;
+  ~CacheMisses() {
+#ifdef __linux__
+    if (descriptor_ >= 0) {
+      close(descriptor_);
+    }
+#endif
+  }
+
+  long long count() const {
+    long long returnable = -1;
+#ifdef __linux__
+    if (descriptor_ < 0 ||
+        read(descriptor_, &returnable, sizeof(returnable)) !=
+            static_cast<ssize_t>(sizeof(returnable))) {
+      returnable = -1;
+    }
+#endif
+    return returnable;
+  }
+
+ private:
+  int descriptor_ = -1;
+};
+
+template <class Operation>
+double MeasureSeconds(Operation operation, int repeats) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < repeats; ++i) {
+    operation();
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  return elapsed.count() / repeats;
+}
+
+template <class Type>
+void BenchmarkBackend(const char* backend, int size) {
+  Matrix<Type> a(size, size), b(size, size), c(size, size);
+  std::iota(a.begin(), a.end(), Type(0));
+  std::iota(b.begin(), b.end(), Type(1));
+  for (int i = 0; i < size; ++i) {
+    a(i, i) += Type(size) * Type(size);
+  }
+  const int repeats = size > 256 ? 2 : 10;
+
+  double gemm = MeasureSeconds(
+      [&] { Matrix<Type>::Gemm(1, a, false, b, true, 0, &c); }, repeats);
+  double solve = MeasureSeconds([&] { c = a.Solve(b); }, repeats);
+  double flops = 2.0 * size * size * size;
+
+  std::printf("%-7s %5d  gemm %9.3f ms %8.2f GFLOP/s  solve %9.3f ms\n",
+              backend, size, gemm * 1e3, flops / gemm * 1e-9, solve * 1e3);
+}
+
+template <class Operation>
+void PrintLayoutResult(const char* name, Operation operation) {
+  CacheMisses misses;
+  const long long before = misses.count();
+  const double seconds = MeasureSeconds(operation, 3);
+  const long long after = misses.count();
+  if (before < 0 || after < 0) {
+    std::printf("%-22s %9.3f ms  L1D misses n/a\n", name, seconds * 1e3);
+  } else {
+    std::printf("%-22s %9.3f ms  L1D misses %lld\n", name, seconds * 1e3,
+                (after - before) / 3);
+  }
+}
+
+template <class Layout>
+void BenchmarkLayout(const char* name, const Matrix<double>& source) {
+  LayoutMatrix<double, Layout> matrix(source);
+  LayoutMatrix<double, Layout> transposed;
+  const std::string transpose = std::string(name) + " transpose";
+  const std::string columns = std::string(name) + " column walk";
+
+  PrintLayoutResult(transpose.c_str(),
+                    [&] { transposed = matrix.Transpose(); });
+  double sum = 0;
+  PrintLayoutResult(columns.c_str(), [&] {
+    for (int j = 0; j < matrix.cols(); ++j) {
+      for (int i = 0; i < matrix.rows(); ++i) {
+        sum += matrix(i, j);
+      }
+    }
+  });
+  if (sum == 0.5) {
+    std::printf("\n");
+  }
+}
+
+void BenchmarkLayouts(int size) {
+  Matrix<double> source(size, size);
+  std::iota(source.begin(), source.end(), 0.0);
+  std::printf("layouts %d x %d\n", size, size);
+
+  Matrix<double> transposed;
+  PrintLayoutResult("Matrix transpose",
+                    [&] { transposed = source.Transpose(); });
+  BenchmarkLayout<hhullen::RowMajorLayout>("row-major", source);
+  BenchmarkLayout<hhullen::ColMajorLayout>("col-major", source);
+  BenchmarkLayout<hhullen::TiledLayout<32>>("tiled", source);
+  BenchmarkLayout<hhullen::ZOrderLayout<32>>("z-order", source);
+}
+
+int main() {
+  for (int size : {128, 256, 512}) {
+    hhullen::SetBlasBackend(false);
+    BenchmarkBackend<double>("native", size);
+    hhullen::SetBlasBackend(true);
+    if (hhullen::IsBlasBackendActive<double>()) {
+      BenchmarkBackend<double>("cblas", size);
+    }
+  }
+
+  BenchmarkLayouts(4096);
+
+  return 0;
+}
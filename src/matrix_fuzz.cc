@@ -0,0 +1,113 @@
+#include <unistd.h>
+#include <zlib.h>
+
+#include <cstdint>
+
+#include "matrix.cc"
+
+using hhullen::Matrix;
+
+namespace {
+
+constexpr size_t kMaxElements = 1 << 20;
+constexpr size_t kMaxInflatedBytes = 1 << 24;
+
+/**
+ * @brief Returns gzip "data" inflated up to kMaxInflatedBytes or raw "data"
+ * when it is not gzip, empty string for corrupted or too large content
+ *
+ */
+std::string Inflate(const uint8_t* data, size_t size) {
+  std::string raw(reinterpret_cast<const char*>(data), size);
+  if (size < 2 || data[0] != 0x1f || data[1] != 0x8b) {
+    return raw;
+  }
+  z_stream stream{};
+  if (inflateInit2(&stream, 16 + MAX_WBITS) != Z_OK) {
+    return std::string();
+  }
+  std::string returnable(kMaxInflatedBytes, '\0');
+  stream.next_in = reinterpret_cast<Bytef*>(raw.data());
+  stream.avail_in = static_cast<uInt>(raw.size());
+  stream.next_out = reinterpret_cast<Bytef*>(returnable.data());
+  stream.avail_out = static_cast<uInt>(returnable.size());
+  const int status = inflate(&stream, Z_FINISH);
+  returnable.resize(stream.total_out);
+  inflateEnd(&stream);
+
+  return status == Z_STREAM_END ? returnable : std::string();
+}
+
+/**
+ * @brief Declared size is checked before loading, as a matrix of any
+ * declared size is a valid input and would only exhaust memory
+ *
+ */
+bool HasLoadableSize(const std::string& content) {
+  int rows = 0, cols = 0;
+  std::istringstream(content.substr(0, content.find('\n'))) >> rows >> cols;
+  return rows < 1 || cols < 1 ||
+         static_cast<size_t>(rows) * static_cast<size_t>(cols) <=
+             kMaxElements;
+}
+
+template <class Type>
+void LoadFile(const std::string& path) {
+  Matrix<Type> matrix;
+  try {
+    matrix.Load(path);
+  } catch (const std::invalid_argument&) {
+    return;
+  }
+  const Matrix<Type> transposed = matrix.Transpose();
+  if (matrix.rows() < 1 || transposed.rows() != matrix.cols()) {
+    __builtin_trap();
+  }
+}
+
+}  // namespace
+
+/**
+ * @brief Fuzz target for Matrix::Load of text and gzip files. Input is
+ * written to a per-process file and loaded as floating and integral
+ * matrices
+ *
+ */
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* data, size_t size) {
+  const std::string content = Inflate(data, size);
+  if (content.empty() || !HasLoadableSize(content)) {
+    return 0;
+  }
+  const std::string path =
+      "matrix_fuzz_" + std::to_string(getpid()) + ".input";
+  {
+    std::ofstream file(path, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(data),
+               static_cast<std::streamsize>(size));
+  }
+  LoadFile<double>(path);
+  LoadFile<float>(path);
+  LoadFile<int>(path);
+  std::remove(path.c_str());
+
+  return 0;
+}
+
+#ifdef MATRIX_FUZZ_STANDALONE
+/**
+ * @brief Replays inputs given as arguments without libFuzzer, e.g. a corpus
+ * under compilers without -fsanitize=fuzzer
+ *
+ */
+int main(int argc, char* argv[]) {
+  for (int i = 1; i < argc; ++i) {
+    std::ifstream file(argv[i], std::ios::binary);
+    const std::string input((std::istreambuf_iterator<char>(file)),
+                            std::istreambuf_iterator<char>());
+    LLVMFuzzerTestOneInput(reinterpret_cast<const uint8_t*>(input.data()),
+                           input.size());
+    std::cout << "Replayed " << argv[i] << '\n';
+  }
+  return 0;
+}
+#endif
@@ -0,0 +1,57 @@
+#include "distributed.cc"
+#include "matrix.cc"
+
+using hhullen::DistributedMatrix;
+using hhullen::Matrix;
+
+namespace {
+
+constexpr int kRows = 300, kInner = 257, kCols = 190, kBlock = 32;
+
+double Left(int i, int j) { return (i * 7 + j * 3) % 11 - 5; }
+double Right(int i, int j) { return (i * 5 + j) % 7 - 3; }
+
+}  // namespace
+
+/**
+ * @brief Checks distributed multiplication and transpose over MPI against
+ * single-process results, e.g. make mpi MPI_PROCESSES=6
+ *
+ */
+int main(int argc, char* argv[]) {
+  int provided = 0;
+  MPI_Init_thread(&argc, &argv, MPI_THREAD_SERIALIZED, &provided);
+  int status = 0;
+  {
+    hhullen::Communicator comm(MPI_COMM_WORLD);
+    DistributedMatrix<double> left(comm, kRows, kInner, kBlock, Left);
+    DistributedMatrix<double> right(comm, kInner, kCols, kBlock, Right);
+    const Matrix<double> product = (left * right).Gather();
+    const Matrix<double> transposed = left.Transpose().Gather();
+
+    if (comm.rank() == 0) {
+      Matrix<double> a(kRows, kInner), b(kInner, kCols);
+      Matrix<double> expected(kRows, kCols);
+      for (int i = 0; i < kRows; ++i) {
+        for (int j = 0; j < kInner; ++j) {
+          a(i, j) = Left(i, j);
+        }
+      }
+      for (int i = 0; i < kInner; ++i) {
+        for (int j = 0; j < kCols; ++j) {
+          b(i, j) = Right(i, j);
+        }
+      }
+      Matrix<double>::Gemm(1, a, false, b, false, 0, &expected);
+      const bool is_correct =
+          product == expected && transposed == a.Transpose();
+      std::cout << "Distributed multiplication and transpose on "
+                << comm.size() << " processes ("
+                << left.grid_rows() << "x" << left.grid_cols()
+                << " grid): " << (is_correct ? "OK" : "FAILED") << '\n';
+      status = is_correct ? 0 : 1;
+    }
+  }
+  MPI_Finalize();
+  return status;
+}
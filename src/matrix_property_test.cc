@@ -0,0 +1,423 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <random>
+
+#include "bit_matrix.h"
+#include "layout_matrix.cc"
+#include "matrix.cc"
+#include "stencil.cc"
+
+using hhullen::Matrix;
+
+namespace {
+
+using Boundary = hhullen::Boundary;
+
+/**
+ * @brief Reads positive integer from environment variable or returns
+ * "fallback", so failures are reproduced with the printed seed
+ *
+ */
+unsigned EnvironmentValue(const char* name, unsigned fallback) {
+  const char* value = std::getenv(name);
+  return value != nullptr && std::atoi(value) > 0
+             ? static_cast<unsigned>(std::atoi(value))
+             : fallback;
+}
+
+const unsigned kSeed = EnvironmentValue("MATRIX_PROPERTY_SEED", 1);
+const int kIterations =
+    static_cast<int>(EnvironmentValue("MATRIX_PROPERTY_ITERATIONS", 30));
+
+/**
+ * @brief Naive reference result computed in long double
+ *
+ */
+struct Reference {
+  int rows, cols;
+  std::vector<long double> values;
+
+  Reference(int rows_amount, int cols_amount)
+      : rows(rows_amount),
+        cols(cols_amount),
+        values(static_cast<size_t>(rows_amount) *
+               static_cast<size_t>(cols_amount)) {}
+  long double& operator()(int i, int j) {
+    return values[static_cast<size_t>(i) * static_cast<size_t>(cols) +
+                  static_cast<size_t>(j)];
+  }
+};
+
+/**
+ * @brief Random shapes are mostly small, every fifth dimension crosses
+ * blocking and parallel thresholds of the kernels
+ *
+ */
+template <class Type>
+class Generator {
+ public:
+  explicit Generator(unsigned seed) : engine_(seed) {}
+
+  int Size() {
+    return Uniform(0, 4) == 0 ? Uniform(250, 300) : Uniform(1, 40);
+  }
+  int Uniform(int first, int last) {
+    return std::uniform_int_distribution<int>(first, last)(engine_);
+  }
+  bool Flag() { return Uniform(0, 1) == 1; }
+  Type Value() {
+    if constexpr (std::is_integral_v<Type>) {
+      return static_cast<Type>(Uniform(-9, 9));
+    } else {
+      return std::uniform_real_distribution<Type>(-1, 1)(engine_);
+    }
+  }
+  Matrix<Type> Random(int rows, int cols) {
+    Matrix<Type> returnable(rows, cols);
+    for (Type& value : returnable) {
+      value = Value();
+    }
+    return returnable;
+  }
+
+ private:
+  std::mt19937 engine_;
+};
+
+/**
+ * @brief Allowed difference for sums of "terms" products of values of at
+ * most 1, integral results must match exactly
+ *
+ */
+template <class Type>
+long double Tolerance(long double terms) {
+  if constexpr (std::is_integral_v<Type>) {
+    return 0;
+  } else {
+    return 4 * (terms + 1) * std::numeric_limits<Type>::epsilon();
+  }
+}
+
+template <class Type>
+Reference ToReference(const Matrix<Type>& matrix) {
+  Reference returnable(matrix.rows(), matrix.cols());
+  for (int i = 0; i < matrix.rows(); ++i) {
+    for (int j = 0; j < matrix.cols(); ++j) {
+      returnable(i, j) = matrix(i, j);
+    }
+  }
+  return returnable;
+}
+
+template <class Type>
+void ExpectMatches(const Matrix<Type>& actual, Reference expected,
+                   long double tolerance) {
+  ASSERT_EQ(actual.rows(), expected.rows);
+  ASSERT_EQ(actual.cols(), expected.cols);
+  int mismatches = 0;
+  for (int i = 0; i < actual.rows() && mismatches < 3; ++i) {
+    for (int j = 0; j < actual.cols() && mismatches < 3; ++j) {
+      const long double difference =
+          std::abs(static_cast<long double>(actual(i, j)) - expected(i, j));
+      if (!(difference <= tolerance)) {
+        ADD_FAILURE() << "(" << i << ", " << j << "): " << actual(i, j)
+                      << " != " << static_cast<double>(expected(i, j));
+        ++mismatches;
+      }
+    }
+  }
+}
+
+Reference NaiveProduct(Reference a, bool trans_a, Reference b, bool trans_b) {
+  const int m = trans_a ? a.cols : a.rows, k = trans_a ? a.rows : a.cols;
+  const int n = trans_b ? b.rows : b.cols;
+  Reference returnable(m, n);
+  for (int i = 0; i < m; ++i) {
+    for (int j = 0; j < n; ++j) {
+      for (int p = 0; p < k; ++p) {
+        returnable(i, j) +=
+            (trans_a ? a(p, i) : a(i, p)) * (trans_b ? b(j, p) : b(p, j));
+      }
+    }
+  }
+  return returnable;
+}
+
+int NaiveBoundary(int index, int size, Boundary boundary) {
+  if (index >= 0 && index < size) {
+    return index;
+  }
+  if (boundary == Boundary::kZero) {
+    return -1;
+  }
+  if (boundary == Boundary::kClamp) {
+    return std::clamp(index, 0, size - 1);
+  }
+  if (boundary == Boundary::kWrap) {
+    return ((index % size) + size) % size;
+  }
+  while (size > 1 && (index < 0 || index >= size)) {
+    index = index < 0 ? -index : 2 * (size - 1) - index;
+  }
+  return size > 1 ? index : 0;
+}
+
+}  // namespace
+
+template <class Type>
+class test_property : public ::testing::Test {
+ protected:
+  Generator<Type> generator_{kSeed};
+  ::testing::ScopedTrace seed_{__FILE__, __LINE__,
+                               "MATRIX_PROPERTY_SEED=" + std::to_string(kSeed)};
+};
+
+using PropertyTypes = ::testing::Types<float, double, int, long>;
+TYPED_TEST_SUITE(test_property, PropertyTypes);
+
+TYPED_TEST(test_property, multiplication) {
+  using Type = TypeParam;
+  Generator<Type>& random = this->generator_;
+  for (int iteration = 0; iteration < kIterations; ++iteration) {
+    const int m = random.Size(), n = random.Size(), k = random.Size();
+    const bool trans_a = random.Flag(), trans_b = random.Flag();
+    const Type alpha = static_cast<Type>(random.Uniform(-2, 2));
+    const Type beta = static_cast<Type>(random.Uniform(-2, 2));
+    const Matrix<Type> a =
+        trans_a ? random.Random(k, m) : random.Random(m, k);
+    const Matrix<Type> b =
+        trans_b ? random.Random(n, k) : random.Random(k, n);
+    Matrix<Type> c = random.Random(m, n);
+    SCOPED_TRACE(testing::Message() << m << "x" << n << "x" << k << " "
+                                    << trans_a << trans_b);
+
+    Reference product =
+        NaiveProduct(ToReference(a), trans_a, ToReference(b), trans_b);
+    Reference expected = ToReference(c);
+    for (size_t i = 0; i < expected.values.size(); ++i) {
+      expected.values[i] =
+          alpha * product.values[i] + beta * expected.values[i];
+    }
+    Matrix<Type>::Gemm(alpha, a, trans_a, b, trans_b, beta, &c);
+    ExpectMatches(c, expected, 2 * Tolerance<Type>(k));
+    if (!trans_a && !trans_b) {
+      ExpectMatches(a * b, product, Tolerance<Type>(k));
+    }
+
+    const std::vector<Type> x(a.begin(), a.begin() + k);
+    std::vector<Type> y(static_cast<size_t>(m));
+    Matrix<Type>::Gemv(1, a, trans_a, x, 0, y);
+    Matrix<Type> column(static_cast<int>(x.size()), 1);
+    std::copy(x.begin(), x.end(), column.begin());
+    Matrix<Type> result(static_cast<int>(y.size()), 1);
+    std::copy(y.begin(), y.end(), result.begin());
+    ExpectMatches(result,
+                  NaiveProduct(ToReference(a), trans_a, ToReference(column),
+                               false),
+                  Tolerance<Type>(static_cast<long double>(x.size())));
+  }
+}
+
+TYPED_TEST(test_property, invalid_sizes) {
+  using Type = TypeParam;
+  Generator<Type>& random = this->generator_;
+  for (int iteration = 0; iteration < kIterations; ++iteration) {
+    const int rows = random.Uniform(-2, 3), cols = random.Uniform(-2, 3);
+    const auto policy = random.Flag() ? hhullen::MemoryPolicy::kInterleaved
+                                      : hhullen::MemoryPolicy::kFirstTouch;
+    SCOPED_TRACE(testing::Message() << rows << "x" << cols);
+    if (rows < 1 || cols < 1) {
+      EXPECT_THROW(Matrix<Type>(rows, cols), std::invalid_argument);
+      EXPECT_THROW(Matrix<Type>(rows, cols, policy), std::invalid_argument);
+    } else {
+      EXPECT_EQ(Matrix<Type>(rows, cols).size(),
+                static_cast<size_t>(rows * cols));
+      EXPECT_EQ(Matrix<Type>(rows, cols, policy).size(),
+                static_cast<size_t>(rows * cols));
+    }
+  }
+}
+
+TYPED_TEST(test_property, power) {
+  using Type = TypeParam;
+  Generator<Type>& random = this->generator_;
+  for (int iteration = 0; iteration < kIterations; ++iteration) {
+    const int n = random.Size() % 64 + 1, k = random.Uniform(0, 3);
+    const Matrix<Type> a = random.Random(n, n);
+    Reference expected(n, n);
+    for (int i = 0; i < n; ++i) {
+      expected(i, i) = 1;
+    }
+    for (int p = 0; p < k; ++p) {
+      expected = NaiveProduct(expected, false, ToReference(a), false);
+    }
+    ExpectMatches(a.Power(k), expected,
+                  Tolerance<Type>(std::pow(static_cast<long double>(n), k)));
+  }
+}
+
+TYPED_TEST(test_property, transpose_and_layouts) {
+  using Type = TypeParam;
+  Generator<Type>& random = this->generator_;
+  for (int iteration = 0; iteration < kIterations; ++iteration) {
+    const Matrix<Type> a = random.Random(random.Size(), random.Size());
+    Reference expected(a.cols(), a.rows());
+    for (int i = 0; i < a.rows(); ++i) {
+      for (int j = 0; j < a.cols(); ++j) {
+        expected(j, i) = a(i, j);
+      }
+    }
+
+    ExpectMatches(a.Transpose(), expected, 0);
+    ExpectMatches(
+        hhullen::LayoutMatrix<Type, hhullen::ColMajorLayout>(a).ToMatrix(),
+        ToReference(a), 0);
+    ExpectMatches(hhullen::LayoutMatrix<Type, hhullen::TiledLayout<8>>(a)
+                      .Transpose()
+                      .ToMatrix(),
+                  expected, 0);
+    ExpectMatches(hhullen::LayoutMatrix<Type, hhullen::ZOrderLayout<4>>(a)
+                      .Transpose()
+                      .ToMatrix(),
+                  expected, 0);
+  }
+}
+
+TYPED_TEST(test_property, elementwise) {
+  using Type = TypeParam;
+  Generator<Type>& random = this->generator_;
+  for (int iteration = 0; iteration < kIterations; ++iteration) {
+    const int rows = random.Size(), cols = random.Size();
+    const Matrix<Type> a = random.Random(rows, cols);
+    const Matrix<Type> b = random.Flag() ? random.Random(rows, cols)
+                           : random.Flag() ? random.Random(1, cols)
+                                           : random.Random(rows, 1);
+    const Type value = random.Value();
+    Reference sum(rows, cols), difference(rows, cols), product(rows, cols),
+        shifted(rows, cols), scaled(rows, cols);
+    for (int i = 0; i < rows; ++i) {
+      for (int j = 0; j < cols; ++j) {
+        const long double left = a(i, j);
+        const long double right =
+            b(b.rows() == 1 ? 0 : i, b.cols() == 1 ? 0 : j);
+        sum(i, j) = left + right;
+        difference(i, j) = left - right;
+        product(i, j) = left * right;
+        shifted(i, j) = left - value;
+        scaled(i, j) = left * value;
+      }
+    }
+
+    Matrix<Type> result = a.Clone();
+    result += b;
+    ExpectMatches(result, sum, Tolerance<Type>(1));
+    result = a.Clone();
+    result -= b;
+    ExpectMatches(result, difference, Tolerance<Type>(1));
+    result = a.Clone();
+    result.HadamardProduct(b);
+    ExpectMatches(result, product, Tolerance<Type>(1));
+    ExpectMatches(a - value, shifted, Tolerance<Type>(1));
+    ExpectMatches(a * value, scaled, Tolerance<Type>(1));
+    if constexpr (std::is_floating_point_v<Type>) {
+      result = a.Clone();
+      result.HadamardProduct(b);
+      result.HadamardDivision(b);
+      ExpectMatches(result, ToReference(a), Tolerance<Type>(4));
+    }
+  }
+}
+
+TYPED_TEST(test_property, bit_reductions) {
+  using Type = TypeParam;
+  Generator<Type>& random = this->generator_;
+  for (int iteration = 0; iteration < kIterations; ++iteration) {
+    const int rows = random.Size(), inner = random.Size() + 64;
+    const int cols = random.Size();
+    Matrix<Type> a(rows, inner), b(inner, cols);
+    for (Type& value : a) {
+      value = static_cast<Type>(random.Uniform(0, 5) == 0);
+    }
+    for (Type& value : b) {
+      value = static_cast<Type>(random.Uniform(0, 5) == 0);
+    }
+    const hhullen::BitMatrix bits = hhullen::BitMatrix::FromMatrix(a);
+
+    Reference row_counts(rows, 1), col_counts(1, inner), count(1, 1);
+    for (int i = 0; i < rows; ++i) {
+      for (int j = 0; j < inner; ++j) {
+        row_counts(i, 0) += a(i, j);
+        col_counts(0, j) += a(i, j);
+        count(0, 0) += a(i, j);
+      }
+    }
+    Matrix<int> row_result(rows, 1), col_result(1, inner), count_result;
+    const std::vector<int> rows_counted = bits.RowCounts();
+    const std::vector<int> cols_counted = bits.ColCounts();
+    std::copy(rows_counted.begin(), rows_counted.end(), row_result.begin());
+    std::copy(cols_counted.begin(), cols_counted.end(), col_result.begin());
+    count_result(0, 0) = static_cast<int>(bits.Count());
+    ExpectMatches(row_result, row_counts, 0);
+    ExpectMatches(col_result, col_counts, 0);
+    ExpectMatches(count_result, count, 0);
+
+    Reference product =
+        NaiveProduct(ToReference(a), false, ToReference(b), false);
+    for (long double& value : product.values) {
+      value = value > 0;
+    }
+    ExpectMatches(
+        (bits * hhullen::BitMatrix::FromMatrix(b)).template ToMatrix<Type>(),
+        product, 0);
+  }
+}
+
+TYPED_TEST(test_property, convolution) {
+  using Type = TypeParam;
+  Generator<Type>& random = this->generator_;
+  for (int iteration = 0; iteration < kIterations; ++iteration) {
+    const Matrix<Type> input = random.Random(random.Size(), random.Size());
+    const Matrix<Type> kernel =
+        random.Random(random.Uniform(1, 5), random.Uniform(1, 5));
+    const Boundary boundary = static_cast<Boundary>(random.Uniform(0, 3));
+    const int rows = input.rows(), cols = input.cols();
+    const int kernel_rows = kernel.rows(), kernel_cols = kernel.cols();
+    Reference expected(rows, cols);
+    for (int i = 0; i < rows; ++i) {
+      for (int j = 0; j < cols; ++j) {
+        for (int p = 0; p < kernel_rows; ++p) {
+          for (int q = 0; q < kernel_cols; ++q) {
+            const int row =
+                NaiveBoundary(i - p + kernel_rows / 2, rows, boundary);
+            const int col =
+                NaiveBoundary(j - q + kernel_cols / 2, cols, boundary);
+            if (row >= 0 && col >= 0) {
+              expected(i, j) += kernel(p, q) * input(row, col);
+            }
+          }
+        }
+      }
+    }
+
+    for (auto method : {hhullen::ConvolutionMethod::kDirect,
+                        hhullen::ConvolutionMethod::kIm2col}) {
+      SCOPED_TRACE(testing::Message()
+                   << rows << "x" << cols << " kernel " << kernel_rows << "x"
+                   << kernel_cols << " boundary "
+                   << static_cast<int>(boundary));
+      ExpectMatches(hhullen::Convolve(input, kernel, boundary, method),
+                    expected, Tolerance<Type>(kernel_rows * kernel_cols));
+    }
+  }
+}
+
+int main(int argc, char* argv[]) {
+  // Kernels run with default tuning, not with tuning cache of the host
+  setenv("MATRIX_TUNING_CACHE", "matrix_tuning_cache.txt", 1);
+  std::remove("matrix_tuning_cache.txt");
+  ::testing::InitGoogleTest(&argc, argv);
+  const int status = RUN_ALL_TESTS();
+  std::remove("matrix_tuning_cache.txt");
+  return status;
+}
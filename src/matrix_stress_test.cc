@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <numeric>
+#include <thread>
+
+#include "decompositions.cc"
+#include "matrix.cc"
+
+using hhullen::Matrix;
+
+namespace {
+
+constexpr int kReaders = 8;
+constexpr int kIterations = 10;
+constexpr int kSize = 96;
+
+Matrix<double> FilledMatrix(int rows, int cols, double shift) {
+  Matrix<double> returnable(rows, cols);
+  for (int i = 0; i < rows; ++i) {
+    for (int j = 0; j < cols; ++j) {
+      returnable(i, j) = std::sin(i * 0.5 + j * 0.25 + shift) + (i == j);
+    }
+  }
+  return returnable;
+}
+
+void RunThreads(int amount, const std::function<void(int)>& body) {
+  std::vector<std::thread> threads;
+  for (int i = 0; i < amount; ++i) {
+    threads.emplace_back(body, i);
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+}
+
+}  // namespace
+
+TEST(test_threading, concurrent_const_readers) {
+  const Matrix<double> a = FilledMatrix(kSize, kSize, 0);
+  const Matrix<double> b = FilledMatrix(kSize, kSize, 1);
+  const Matrix<double> product = a * b.Transpose();
+  const Matrix<double> transposed = a.Transpose();
+  const Matrix<double> bias = FilledMatrix(1, kSize, 2);
+  std::vector<int> failures(kReaders, 0);
+
+  RunThreads(kReaders, [&](int reader) {
+    int& failed = failures[static_cast<size_t>(reader)];
+    const std::string path =
+        "matrix_stress_" + std::to_string(reader) + ".txt";
+    Matrix<double>::SaveOptions options;
+    options.threads = 4;
+    for (int iteration = 0; iteration < kIterations; ++iteration) {
+      Matrix<double> result(kSize, kSize);
+      Matrix<double>::Gemm(1, a, false, b, true, 0, &result);
+      failed += result != product;
+      failed += a.Transpose() != transposed;
+
+      Matrix<double> copy(a);
+      copy += bias;
+      copy *= 2;
+      failed += copy(3, 4) != 2 * (a(3, 4) + bias(0, 4));
+
+      std::vector<double> row_sums(kSize);
+      hhullen::ParallelFor(0, kSize, 4, [&a, &row_sums](int first, int last) {
+        for (int i = first; i < last; ++i) {
+          for (double value : a.row(i)) {
+            row_sums[static_cast<size_t>(i)] += value;
+          }
+        }
+      });
+      failed += std::abs(std::accumulate(row_sums.begin(), row_sums.end(),
+                                         0.0) -
+                         std::accumulate(a.begin(), a.end(), 0.0)) > 1e-9;
+
+      a.Save(path, options);
+      a.SaveAsync(path + ".async", options).get();
+    }
+    std::filesystem::remove(path);
+    std::filesystem::remove(path + ".async");
+  });
+
+  for (int failed : failures) {
+    EXPECT_EQ(failed, 0);
+  }
+}
+
+TEST(test_threading, writers_of_shared_buffer) {
+  const Matrix<double> source = FilledMatrix(kSize * 4, kSize * 2, 0);
+  const Matrix<double> reference = source.Clone();
+  const Matrix<double> scale = FilledMatrix(kSize * 4, 1, 3);
+  std::vector<Matrix<double>> copies(kReaders, source);
+
+  RunThreads(kReaders, [&](int writer) {
+    Matrix<double>& copy = copies[static_cast<size_t>(writer)];
+    for (int iteration = 0; iteration < kIterations; ++iteration) {
+      copy.HadamardProduct(scale);
+      copy += writer;
+      copy.row(0)[0] = writer;
+      if (iteration % 2) {
+        copy = source;
+      }
+    }
+  });
+
+  EXPECT_TRUE(source == reference);
+  for (int writer = 0; writer < kReaders; ++writer) {
+    EXPECT_EQ(copies[static_cast<size_t>(writer)].rows(), kSize * 4);
+  }
+}
+
+TEST(test_threading, parallel_kernels_with_readers) {
+  const Matrix<double> a = FilledMatrix(kSize * 2, kSize, 0);
+  const Matrix<double> b = FilledMatrix(kSize * 2, 1, 1);
+  const Matrix<double> expected = hhullen::LeastSquares(a, b);
+  std::vector<int> failures(kReaders, 0);
+
+  RunThreads(kReaders, [&](int reader) {
+    for (int iteration = 0; iteration < kIterations / 2; ++iteration) {
+      hhullen::QrDecomposition<double> qr(a, reader % 3 + 1);
+      failures[static_cast<size_t>(reader)] += qr.LeastSquares(b) != expected;
+      failures[static_cast<size_t>(reader)] +=
+          a.Transpose().Transpose() != a;
+    }
+  });
+
+  for (int failed : failures) {
+    EXPECT_EQ(failed, 0);
+  }
+}
+
+int main(int argc, char* argv[]) {
+  // Kernels run with default tuning, not with tuning cache of the host
+  setenv("MATRIX_TUNING_CACHE", "matrix_tuning_cache.txt", 1);
+  std::remove("matrix_tuning_cache.txt");
+  ::testing::InitGoogleTest(&argc, argv);
+  const int status = RUN_ALL_TESTS();
+  std::remove("matrix_tuning_cache.txt");
+  return status;
+}
@@ -36,6 +36,114 @@ TEST(test_constructor, move_constructor) {
   EXPECT_EQ(test.rows(), 5);
 }
 
+TEST(test_constructor, copy_shares_data) {
+  Matrix<double> test_init(5, 5);
+  fill_matrix(&test_init, 2);
+
+  Matrix<double> test(test_init);
+  Matrix<double> assigned;
+  assigned = test_init;
+
+  EXPECT_TRUE(test_init.IsShared());
+  EXPECT_TRUE(test.IsShared());
+  run_through_matrix_num(assigned, 2);
+}
+
+TEST(test_constructor, copy_on_write) {
+  Matrix<double> test_init(3, 3);
+  fill_matrix(&test_init, 2);
+
+  Matrix<double> by_set(test_init), by_index(test_init), by_each(test_init),
+      by_sum(test_init);
+  by_set.set(0, 0, 5);
+  by_index(1, 1) = 5;
+  by_each.ProcessEach([](double& value) { value = 5; });
+  by_sum += test_init;
+
+  EXPECT_FALSE(test_init.IsShared());
+  EXPECT_EQ(by_set(0, 0), 5);
+  EXPECT_EQ(by_index(1, 1), 5);
+  run_through_matrix_num(by_each, 5);
+  run_through_matrix_num(by_sum, 4);
+  run_through_matrix_num(test_init, 2);
+}
+
+TEST(test_constructor, accessors_detach_on_write) {
+  Matrix<double> test_init(3, 3);
+  fill_matrix(&test_init, 2);
+
+  Matrix<double> by_index(test_init), by_iterator(test_init),
+      by_row(test_init);
+  by_index(1, 1) = 5;
+  std::transform(by_iterator.begin(), by_iterator.end(), by_iterator.begin(),
+                 [](double value) { return value * 2; });
+  by_row.row(2)[0] = 7;
+
+  EXPECT_FALSE(test_init.IsShared());
+  EXPECT_EQ(by_index(1, 1), 5);
+  EXPECT_EQ(by_row(2, 0), 7);
+  run_through_matrix_num(by_iterator, 4);
+  run_through_matrix_num(test_init, 2);
+}
+
+TEST(test_constructor, clone) {
+  Matrix<double> test_init(3, 3);
+  fill_matrix(&test_init, 2);
+
+  Matrix<double> test = test_init.Clone();
+
+  EXPECT_FALSE(test.IsShared());
+  EXPECT_FALSE(test_init.IsShared());
+  EXPECT_TRUE(test == test_init);
+}
+
+TEST(test_constructor, interleaved_memory) {
+  Matrix<double> test(300, 300, hhullen::MemoryPolicy::kInterleaved);
+  Matrix<double> result(300, 300);
+  fill_matrix(&test, 2);
+  fill_matrix(&result, 4);
+
+  Matrix<double> copy(test);
+  copy += test;
+
+  EXPECT_GE(hhullen::NumaNodes(), 1);
+  EXPECT_EQ(copy.memory_policy(), hhullen::MemoryPolicy::kInterleaved);
+  EXPECT_TRUE(copy == result);
+  run_through_matrix_num(test, 2);
+}
+
+TEST(test_constructor, memory_policy_invalid_size) {
+  for (hhullen::MemoryPolicy policy : {hhullen::MemoryPolicy::kFirstTouch,
+                                       hhullen::MemoryPolicy::kInterleaved}) {
+    EXPECT_THROW(Matrix<double>(0, 5, policy), std::invalid_argument);
+    EXPECT_THROW(Matrix<double>(5, 0, policy), std::invalid_argument);
+    EXPECT_THROW(Matrix<double>(5, -1, policy), std::invalid_argument);
+    EXPECT_THROW(Matrix<double>(-1, 5, policy), std::invalid_argument);
+  }
+}
+
+TEST(test_constructor, pinned_threads) {
+  const bool was_pinned = hhullen::ThreadPinning();
+  hhullen::SetThreadPinning(true);
+  Matrix<double> test(400, 200), result(400, 200);
+  fill_matrix(&test, 3);
+  fill_matrix(&result, 3);
+
+  test *= 2;
+  test.HadamardProduct(result);
+  test -= result;
+  std::vector<int> covered(100, 0);
+  hhullen::ParallelFor(0, 100, 4, [&covered](int first, int last) {
+    for (int i = first; i < last; ++i) {
+      covered[static_cast<size_t>(i)] += 1;
+    }
+  });
+  hhullen::SetThreadPinning(was_pinned);
+
+  run_through_matrix_num(test, 15);
+  EXPECT_EQ(std::count(covered.begin(), covered.end(), 1), 100);
+}
+
 TEST(test_operations, IsEqual) {
   Matrix<double> test, test2;
 
@@ -102,6 +210,533 @@ TEST(test_operations, Multiply) {
   EXPECT_TRUE(test == result);
 }
 
+TEST(test_operations, Gemm) {
+  Matrix<double> a(4, 3), b(5, 3), c(4, 5);
+  std::iota(a.begin(), a.end(), 1.0);
+  std::iota(b.begin(), b.end(), -7.0);
+  fill_matrix(&c, 2);
+  Matrix<double> expected = a * b.Transpose() * 3 + c * 0.5;
+
+  Matrix<double>::Gemm(3, a, false, b, true, 0.5, &c);
+  EXPECT_TRUE(c == expected);
+
+  Matrix<double> at = a.Transpose(), bt = b.Transpose();
+  Matrix<double>::Gemm(3, at, true, bt, false, 0.5, &c);
+  EXPECT_TRUE(c == a * b.Transpose() * 3 + expected * 0.5);
+
+  Matrix<double> big_a(70, 90), big_b(80, 70), big_c(90, 80);
+  std::iota(big_a.begin(), big_a.end(), 0.0);
+  std::iota(big_b.begin(), big_b.end(), 1.0);
+  Matrix<double>::Gemm(1, big_a, true, big_b, true, 0, &big_c);
+  EXPECT_TRUE(big_c == (big_b * big_a).Transpose());
+}
+
+TEST(test_operations, MultiplyShared) {
+  Matrix<double> a(3, 4), b(4, 2), c(3, 2);
+  fill_matrix(&a, 1);
+  fill_matrix(&b, 2);
+  Matrix<double> a_copy(a), c_copy(c);
+  const double* a_values = std::as_const(a).data();
+
+  Matrix<double> product = a * b;
+  EXPECT_TRUE(a.IsShared());
+  EXPECT_EQ(std::as_const(a).data(), a_values);
+  run_through_matrix_num(product, 8);
+
+  a *= b;
+  EXPECT_FALSE(a_copy.IsShared());
+  EXPECT_EQ(std::as_const(a_copy).data(), a_values);
+  run_through_matrix_num(a, 8);
+  run_through_matrix_num(a_copy, 1);
+
+  Matrix<double>::Gemm(1, a_copy, false, b, false, 0, &c);
+  EXPECT_FALSE(c_copy.IsShared());
+  run_through_matrix_num(c, 8);
+  run_through_matrix_num(c_copy, 0);
+}
+
+TEST(test_operations, GemmIncorrect) {
+  Matrix<double> a(4, 3), b(3, 5), c(4, 5);
+
+  EXPECT_THROW(Matrix<double>::Gemm(1, a, true, b, false, 0, &c),
+               std::invalid_argument);
+  EXPECT_THROW(Matrix<double>::Gemm(1, a, false, b, false, 0, &a),
+               std::invalid_argument);
+  EXPECT_NO_THROW(Matrix<double>::Gemm(1, a, false, b, false, 0, &c));
+}
+
+TEST(test_operations, Gemv) {
+  Matrix<double> a(3, 2);
+  std::iota(a.begin(), a.end(), 1.0);
+  std::vector<double> x = {1, -1}, x_t = {1, 0, 2}, y = {1, 1, 1}, y_t(2, 7);
+
+  Matrix<double>::Gemv(2, a, false, x, 1, y);
+  Matrix<double>::Gemv(1, a, true, x_t, 0, y_t);
+
+  EXPECT_EQ(y, std::vector<double>({-1, -1, -1}));
+  EXPECT_EQ(y_t, std::vector<double>({11, 14}));
+  EXPECT_THROW(Matrix<double>::Gemv(1, a, true, x, 0, y),
+               std::invalid_argument);
+}
+
+TEST(test_operations, Solve) {
+  Matrix<double> a(3, 3), x(3, 2);
+  std::vector<double> values = {0, 2, 1, 1, 1, 1, 4, -1, 3};
+  std::copy(values.begin(), values.end(), a.begin());
+  std::iota(x.begin(), x.end(), -2.0);
+
+  Matrix<double> solution = a.Solve(a * x);
+
+  EXPECT_TRUE(solution == x);
+  EXPECT_THROW(a.Solve(Matrix<double>(2, 1)), std::invalid_argument);
+  EXPECT_THROW(Matrix<double>(3, 3).Solve(x), std::invalid_argument);
+}
+
+TEST(test_operations, Permutation) {
+  hhullen::Permutation order(4), other(4);
+  order.Swap(0, 2);
+  order.Swap(2, 3);
+  other.Swap(1, 3);
+
+  EXPECT_EQ(order[0], 2);
+  EXPECT_EQ(order[2], 3);
+  EXPECT_EQ(order[3], 0);
+  EXPECT_TRUE((order * order.Inverse()).IsIdentity());
+  EXPECT_EQ(hhullen::Permutation::FromPivots({2, 1, 3, 3}), order);
+  EXPECT_THROW(order.Swap(0, 4), std::out_of_range);
+
+  Matrix<double> test(4, 3), permuted(4, 3), composed(4, 3);
+  std::iota(test.begin(), test.end(), 0.0);
+  permuted = test;
+  permuted.Permute(order);
+  composed = test;
+  composed.Permute(other);
+  composed.Permute(order);
+  test.Permute(order * other);
+
+  EXPECT_EQ(permuted.row(0)[0], 6);
+  EXPECT_EQ(permuted.row(3)[2], 2);
+  EXPECT_TRUE(composed == test);
+}
+
+TEST(test_operations, Lu) {
+  Matrix<double> a(4, 4);
+  std::vector<double> values = {0, 2, 1, 3, 1, 1, 1,  0,
+                                4, -1, 3, 2, 1, 0, 0, 1};
+  std::copy(values.begin(), values.end(), a.begin());
+  hhullen::Permutation order;
+
+  Matrix<double> lu = a.Lu(&order);
+  Matrix<double> lower(4, 4), upper(4, 4);
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      (j < i ? lower : upper)(i, j) = lu(i, j);
+    }
+    lower(i, i) = 1;
+  }
+  a.Permute(order);
+
+  EXPECT_TRUE(lower * upper == a);
+  EXPECT_EQ(order[0], 2);
+}
+
+TEST(test_operations, Power) {
+  Matrix<double> a(4, 4), expected(4, 4);
+  std::iota(a.begin(), a.end(), -7.0);
+  a *= 0.1;
+  for (int i = 0; i < 4; ++i) {
+    expected(i, i) = 1;
+  }
+
+  for (int k = 0; k <= 13; ++k) {
+    EXPECT_TRUE(a.Power(k) == expected);
+    expected *= a;
+  }
+  Matrix<int> step(2, 2);
+  step(0, 0) = step(0, 1) = step(1, 0) = 1;
+  EXPECT_EQ(step.Power(30)(0, 1), 832040);
+  EXPECT_THROW(a.Power(-1), std::invalid_argument);
+  EXPECT_THROW(Matrix<double>(2, 3).Power(2), std::invalid_argument);
+}
+
+TEST(test_operations, Exp) {
+  Matrix<double> diagonal(3, 3), nilpotent(2, 2), rotation(2, 2);
+  diagonal(0, 0) = 0.001;
+  diagonal(1, 1) = -2;
+  diagonal(2, 2) = 3;
+  nilpotent(0, 1) = 1;
+  Matrix<double> exp_diagonal = diagonal.Exp(), exp_nilpotent = nilpotent.Exp();
+  EXPECT_NEAR(exp_diagonal(0, 0), std::exp(0.001), 1e-12);
+  EXPECT_NEAR(exp_diagonal(1, 1), std::exp(-2), 1e-12);
+  EXPECT_NEAR(exp_diagonal(2, 2), std::exp(3), 1e-12);
+  EXPECT_EQ(exp_diagonal(0, 1), 0);
+  EXPECT_NEAR(exp_nilpotent(0, 1), 1, 1e-12);
+  EXPECT_NEAR(exp_nilpotent(1, 1), 1, 1e-12);
+
+  for (double angle : {0.5, 10.0, 100.0}) {
+    rotation(0, 1) = -angle;
+    rotation(1, 0) = angle;
+    Matrix<double> result = rotation.Exp();
+    EXPECT_NEAR(result(0, 0), std::cos(angle), 1e-9);
+    EXPECT_NEAR(result(1, 0), std::sin(angle), 1e-9);
+  }
+
+  Matrix<double> generator(3, 3);
+  std::vector<double> rates = {-3, 2, 1, 0.5, -1, 0.5, 4, 4, -8};
+  std::copy(rates.begin(), rates.end(), generator.begin());
+  Matrix<double> transition = (generator * 2).Exp();
+  for (int i = 0; i < 3; ++i) {
+    std::span<const double> row = std::as_const(transition).row(i);
+    EXPECT_NEAR(std::accumulate(row.begin(), row.end(), 0.0), 1, 1e-12);
+  }
+  EXPECT_TRUE(transition * transition == (generator * 4).Exp());
+  EXPECT_THROW(Matrix<double>(2, 3).Exp(), std::invalid_argument);
+}
+
+TEST(test_decompositions, symmetric_eigen) {
+  Matrix<double> a(5, 5);
+  for (int i = 0; i < 5; ++i) {
+    for (int j = 0; j < 5; ++j) {
+      a(i, j) = 1.0 / (i + j + 1) + (i == j ? i : 0);
+    }
+  }
+
+  hhullen::EigenDecomposition<double> all = hhullen::SymmetricEigen(a);
+  hhullen::EigenDecomposition<double> top = hhullen::SymmetricEigen(a, 2);
+  Matrix<double> diagonal(5, 5), identity(5, 5);
+  for (int i = 0; i < 5; ++i) {
+    diagonal(i, i) = all.values(i, 0);
+    identity(i, i) = 1;
+  }
+
+  EXPECT_TRUE(all.vectors * diagonal * all.vectors.Transpose() == a);
+  EXPECT_TRUE(all.vectors.Transpose() * all.vectors == identity);
+  EXPECT_GT(all.values(0, 0), all.values(1, 0));
+  EXPECT_EQ(top.values.rows(), 2);
+  EXPECT_EQ(top.vectors.cols(), 2);
+  EXPECT_NEAR(top.values(1, 0), all.values(1, 0), kAccuracy);
+  EXPECT_NEAR(std::abs(top.vectors(0, 0)), std::abs(all.vectors(0, 0)),
+              kAccuracy);
+}
+
+TEST(test_decompositions, thin_svd) {
+  Matrix<double> tall(7, 3);
+  for (int i = 0; i < 7; ++i) {
+    for (int j = 0; j < 3; ++j) {
+      tall(i, j) = std::sin(i * 3 + j + 1.0);
+    }
+  }
+  Matrix<double> wide = tall.Transpose();
+
+  for (const Matrix<double>* a : {&tall, &wide}) {
+    hhullen::SingularDecomposition<double> svd = hhullen::ThinSvd(*a);
+    Matrix<double> scaled = svd.u;
+    for (int i = 0; i < scaled.rows(); ++i) {
+      for (int j = 0; j < scaled.cols(); ++j) {
+        scaled(i, j) *= svd.s(j, 0);
+      }
+    }
+
+    EXPECT_EQ(svd.s.rows(), 3);
+    EXPECT_GE(svd.s(0, 0), svd.s(1, 0));
+    EXPECT_GE(svd.s(1, 0), svd.s(2, 0));
+    EXPECT_TRUE(scaled * svd.vt == *a);
+  }
+  EXPECT_EQ(hhullen::ThinSvd(tall, 1).u.cols(), 1);
+}
+
+TEST(test_decompositions, symmetric_eigen_top) {
+  Matrix<double> clustered(200, 200), distinct(300, 300);
+  for (int i = 0; i < 200; ++i) {
+    for (int j = 0; j < 200; ++j) {
+      clustered(i, j) = std::sin(i + 1.0) * std::sin(j + 1.0) + (i == j) * 2;
+    }
+  }
+  for (int i = 0; i < 300; ++i) {
+    for (int j = 0; j < 300; ++j) {
+      distinct(i, j) = 1.0 / (i + j + 1) + (i == j ? i : 0);
+    }
+  }
+
+  for (auto [a, k] : {std::pair(&clustered, 5), std::pair(&distinct, 250)}) {
+    hhullen::EigenDecomposition<double> top = hhullen::SymmetricEigen(*a, k);
+    Matrix<double> scaled = top.vectors.Clone(), identity(k, k);
+    for (int j = 0; j < k; ++j) {
+      identity(j, j) = 1;
+      for (int i = 0; i < a->rows(); ++i) {
+        scaled(i, j) *= top.values(j, 0);
+      }
+    }
+
+    EXPECT_TRUE(*a * top.vectors == scaled);
+    EXPECT_TRUE(top.vectors.Transpose() * top.vectors == identity);
+  }
+  EXPECT_NEAR(hhullen::SymmetricEigen(clustered, 5).values(4, 0), 2,
+              kAccuracy);
+  EXPECT_NEAR(hhullen::SymmetricEigen(distinct, 250).values(249, 0),
+              hhullen::SymmetricEigen(distinct).values(249, 0), kAccuracy);
+}
+
+TEST(test_decompositions, thin_svd_graded) {
+  const std::vector<double> expected = {1, 1e-4, 1e-8, 1e-12};
+  auto reflection = [](int size, double seed) {
+    Matrix<double> w(size, 1), identity(size, size);
+    for (int i = 0; i < size; ++i) {
+      w(i, 0) = std::sin(seed * (i + 1));
+      identity(i, i) = 1;
+    }
+    const double norm = (w.Transpose() * w)(0, 0);
+    return identity - w * w.Transpose() * (2 / norm);
+  };
+  Matrix<double> left = reflection(8, 1.7), diagonal(8, 4);
+  for (int i = 0; i < 4; ++i) {
+    diagonal(i, i) = expected[static_cast<size_t>(i)];
+  }
+  const Matrix<double> tall = left * diagonal * reflection(4, 0.3);
+
+  for (const Matrix<double>& a : {tall, tall.Transpose()}) {
+    hhullen::SingularDecomposition<double> svd = hhullen::ThinSvd(a);
+    for (int i = 0; i < 4; ++i) {
+      EXPECT_NEAR(svd.s(i, 0) / expected[static_cast<size_t>(i)], 1, 1e-3);
+    }
+  }
+
+  Matrix<double> large(300, 256);
+  for (int i = 0; i < large.rows(); ++i) {
+    for (int j = 0; j < large.cols(); ++j) {
+      large(i, j) = std::sin(i * 0.7 + j * 1.3) + (i == j);
+    }
+  }
+  hhullen::SingularDecomposition<double> svd = hhullen::ThinSvd(large);
+  Matrix<double> scaled = svd.u.Clone();
+  for (int i = 0; i < scaled.rows(); ++i) {
+    for (int j = 0; j < scaled.cols(); ++j) {
+      scaled(i, j) *= svd.s(j, 0);
+    }
+  }
+  EXPECT_TRUE(scaled * svd.vt == large);
+}
+
+TEST(test_decompositions, qr_apply_q) {
+  Matrix<double> a(300, 40);
+  for (int i = 0; i < a.rows(); ++i) {
+    for (int j = 0; j < a.cols(); ++j) {
+      a(i, j) = std::sin(i * 0.37 + j * 1.3) + (i == j ? 2 : 0);
+    }
+  }
+  Matrix<double> identity(40, 40);
+  for (int i = 0; i < 40; ++i) {
+    identity(i, i) = 1;
+  }
+
+  for (int row_blocks : {1, 4}) {
+    hhullen::QrDecomposition<double> qr(a, row_blocks);
+    Matrix<double> q = qr.ApplyQ(identity);
+
+    EXPECT_EQ(qr.row_blocks(), row_blocks);
+    EXPECT_TRUE(qr.ApplyQ(qr.r()) == a);
+    EXPECT_TRUE(qr.ApplyQt(q) == identity);
+    EXPECT_TRUE(q.Transpose() * q == identity);
+    EXPECT_DOUBLE_EQ(qr.r()(5, 2), 0);
+  }
+  EXPECT_THROW(hhullen::QrDecomposition<double>(a.Transpose()),
+               std::invalid_argument);
+}
+
+TEST(test_decompositions, least_squares) {
+  Matrix<double> a(500, 3), b(500, 1);
+  for (int i = 0; i < a.rows(); ++i) {
+    double x = i * 0.01;
+    a(i, 0) = 1;
+    a(i, 1) = x;
+    a(i, 2) = x * x;
+    b(i, 0) = 2 - 3 * x + 0.5 * x * x + (i % 2 ? 1e-3 : -1e-3);
+  }
+  Matrix<double> normal = (a.Transpose() * a).Solve(a.Transpose() * b);
+
+  for (int row_blocks : {1, 8}) {
+    Matrix<double> x =
+        hhullen::QrDecomposition<double>(a, row_blocks).LeastSquares(b);
+    EXPECT_TRUE(x == normal);
+    EXPECT_NEAR(x(1, 0), -3, 1e-3);
+  }
+  EXPECT_TRUE(hhullen::LeastSquares(a, b) == normal);
+
+  Matrix<double> rank_deficient(4, 2);
+  EXPECT_THROW(hhullen::LeastSquares(rank_deficient, Matrix<double>(4, 1)),
+               std::invalid_argument);
+}
+
+Matrix<double> Column(const std::vector<double>& values) {
+  Matrix<double> returnable(static_cast<int>(values.size()), 1);
+  std::copy(values.begin(), values.end(), returnable.begin());
+  return returnable;
+}
+
+struct ConvectionDiffusion {
+  using value_type = double;
+  int size;
+
+  int rows() const { return size; }
+  void Apply(std::span<const double> x, std::span<double> y) const {
+    for (size_t i = 0; i < x.size(); ++i) {
+      y[i] = 2.5 * x[i] - (i > 0 ? 1.5 * x[i - 1] : 0) -
+             (i + 1 < x.size() ? 0.5 * x[i + 1] : 0);
+    }
+  }
+};
+
+TEST(test_iterative, conjugate_gradient) {
+  const int n = 200;
+  Matrix<double> a(n, n), b(n, 1);
+  for (int i = 0; i < n; ++i) {
+    a(i, i) = 2.1 + (i % 7) * 0.5;
+    if (i > 0) {
+      a(i, i - 1) = a(i - 1, i) = -1;
+    }
+    b(i, 0) = std::sin(i * 0.1);
+  }
+  Matrix<double> expected = a.Solve(b);
+  hhullen::MatrixOperator<double> op(a);
+  std::vector<double> rhs(b.begin(), b.end());
+
+  int calls = 0;
+  hhullen::SolverOptions options;
+  options.on_iteration = [&calls](int, double) { ++calls; };
+  std::vector<double> x(n);
+  hhullen::SolverReport report =
+      hhullen::ConjugateGradient(op, rhs, x, options);
+  EXPECT_TRUE(report.converged);
+  EXPECT_EQ(calls, report.iterations);
+  EXPECT_EQ(report.history.size(), static_cast<size_t>(report.iterations));
+  EXPECT_TRUE(Column(x) == expected);
+
+  std::fill(x.begin(), x.end(), 0);
+  report = hhullen::ConjugateGradient(
+      op, rhs, x, {}, hhullen::JacobiPreconditioner<double>(a));
+  EXPECT_TRUE(report.converged);
+  EXPECT_TRUE(Column(x) == expected);
+
+  std::fill(x.begin(), x.end(), 0);
+  report = hhullen::ConjugateGradient(op, rhs, x, {},
+                                      hhullen::IluPreconditioner<double>(a));
+  EXPECT_TRUE(report.converged);
+  EXPECT_LE(report.iterations, 2);
+  EXPECT_TRUE(Column(x) == expected);
+
+  std::vector<double> wrong_size(n + 1);
+  EXPECT_THROW(hhullen::ConjugateGradient(op, wrong_size, x),
+               std::invalid_argument);
+}
+
+TEST(test_iterative, gmres) {
+  const int n = 300;
+  ConvectionDiffusion op{n};
+  Matrix<double> a(n, n), b(n, 1);
+  for (int i = 0; i < n; ++i) {
+    a(i, i) = 2.5;
+    if (i > 0) {
+      a(i, i - 1) = -1.5;
+      a(i - 1, i) = -0.5;
+    }
+    b(i, 0) = 1 + (i % 3);
+  }
+  Matrix<double> expected = a.Solve(b);
+  std::vector<double> rhs(b.begin(), b.end());
+
+  hhullen::SolverOptions options;
+  options.restart = 10;
+  options.max_iterations = 5000;
+  std::vector<double> x(n);
+  hhullen::SolverReport report = hhullen::Gmres(op, rhs, x, options);
+  EXPECT_TRUE(report.converged);
+  EXPECT_LE(report.residual, options.tolerance);
+  EXPECT_TRUE(Column(x) == expected);
+
+  std::vector<double> diagonal(n, 2.5);
+  std::fill(x.begin(), x.end(), 0);
+  report = hhullen::Gmres(
+      op, rhs, x, options,
+      hhullen::JacobiPreconditioner<double>(std::span<const double>(diagonal)));
+  EXPECT_TRUE(report.converged);
+  EXPECT_TRUE(Column(x) == expected);
+
+  std::fill(x.begin(), x.end(), 0);
+  report = hhullen::Gmres(hhullen::MatrixOperator<double>(a), rhs, x, options,
+                          hhullen::IluPreconditioner<double>(a));
+  EXPECT_TRUE(report.converged);
+  EXPECT_LE(report.iterations, 2);
+  EXPECT_TRUE(Column(x) == expected);
+
+  options.max_iterations = 3;
+  std::fill(x.begin(), x.end(), 0);
+  report = hhullen::Gmres(op, rhs, x, options);
+  EXPECT_FALSE(report.converged);
+  EXPECT_EQ(report.iterations, 3);
+}
+
+TEST(test_tuning, parameters) {
+  const hhullen::TuningParameters defaults = Matrix<double>::tuning();
+  Matrix<double> a(37, 91), b(91, 53), expected(37, 53), result(37, 53);
+  fill_matrix(&a, 1);
+  fill_matrix(&b, 2);
+  Matrix<double>::Gemm(1, a, false, b, false, 0, &expected);
+  const Matrix<double> transposed = a.Transpose();
+  Matrix<double> skinny(91, 5);
+  fill_matrix(&skinny, 3);
+  const Matrix<double> tall = b.Transpose() * skinny;
+  const Matrix<double> wide = skinny.Transpose() * b;
+
+  Matrix<double>::set_tuning({5, 3, 2, 0, 7, 0, 11, 0});
+  EXPECT_EQ(Matrix<double>::tuning().gemm_block, 5);
+  EXPECT_EQ(Matrix<double>::tuning().GemmBlock(hhullen::GemmShape::kWide),
+            11);
+  Matrix<double>::Gemm(1, a, false, b, false, 0, &result);
+  EXPECT_TRUE(result == expected);
+  EXPECT_TRUE(b.Transpose() * skinny == tall);
+  EXPECT_TRUE(skinny.Transpose() * b == wide);
+  EXPECT_TRUE(a.Transpose() == transposed);
+  Matrix<double>::set_tuning(defaults);
+
+  EXPECT_EQ(hhullen::TuningParameters::Shape(91, 37),
+            hhullen::GemmShape::kSquare);
+  EXPECT_EQ(hhullen::TuningParameters::Shape(53, 5), hhullen::GemmShape::kTall);
+  EXPECT_EQ(hhullen::TuningParameters::Shape(5, 53), hhullen::GemmShape::kWide);
+  EXPECT_THROW(Matrix<double>::set_tuning({0, 32, 0, 0}),
+               std::invalid_argument);
+  EXPECT_THROW(Matrix<double>::set_tuning({256, 32, 0, 0, 256, 0, 0, 0}),
+               std::invalid_argument);
+  EXPECT_THROW(Matrix<double>::set_tuning({256, 32, -1, 0}),
+               std::invalid_argument);
+  EXPECT_TRUE(Matrix<double>::tuning() == defaults);
+}
+
+TEST(test_tuning, autotune_cache) {
+  const hhullen::TuningParameters defaults = Matrix<float>::tuning();
+  const std::string path = "matrix_tuning_output.txt";
+  std::remove(path.c_str());
+  hhullen::StoreTuning(path, "other|float32", {64, 16, 1, 10});
+
+  const hhullen::TuningParameters tuned =
+      Matrix<float>::Autotune({64, 1, true, path});
+  EXPECT_TRUE(Matrix<float>::tuning() == tuned);
+  hhullen::TuningParameters loaded, other;
+  EXPECT_TRUE(hhullen::LoadTuning(path, hhullen::TuningKey<float>(), &loaded));
+  EXPECT_TRUE(loaded == tuned);
+  EXPECT_TRUE(hhullen::LoadTuning(path, "other|float32", &other));
+  EXPECT_EQ(other.parallel_elements, 10U);
+  EXPECT_FALSE(hhullen::LoadTuning(path, "other", &other));
+  std::ofstream(path, std::ios::app) << "square only\t48 16 1 20\n";
+  EXPECT_TRUE(hhullen::LoadTuning(path, "square only", &other));
+  EXPECT_EQ(other.tall_gemm_block, 48);
+  EXPECT_EQ(other.wide_parallel_elements, 20U);
+  EXPECT_THROW(Matrix<float>::Autotune({0, 1, false, path}),
+               std::invalid_argument);
+
+  Matrix<float>::set_tuning(defaults);
+  std::remove(path.c_str());
+}
+
 TEST(test_operations, Transpose) {
   Matrix<double> test(3, 2), result(2, 3);
 
@@ -293,6 +928,89 @@ TEST(test_operators, hadamart_product) {
   EXPECT_EQ(test(3, 0), 25);
 }
 
+TEST(test_operators, broadcasting) {
+  Matrix<double> test(300, 250), bias(1, 250), scale(300, 1);
+  fill_matrix(&test, 1);
+  for (int j = 0; j < 250; ++j) {
+    bias(0, j) = j;
+  }
+  for (int i = 0; i < 300; ++i) {
+    scale(i, 0) = i + 1;
+  }
+  Matrix<double> expected = test.Clone();
+  for (int i = 0; i < 300; ++i) {
+    for (int j = 0; j < 250; ++j) {
+      expected(i, j) = ((expected(i, j) + j) * (i + 1) - 2) / 4;
+    }
+  }
+
+  test += bias;
+  test.HadamardProduct(scale);
+  test = (test - 2) / 4;
+
+  EXPECT_TRUE(test == expected);
+  test -= bias;
+  test.HadamardDivision(scale);
+  EXPECT_DOUBLE_EQ(test(3, 5), (expected(3, 5) - 5) / 4);
+  EXPECT_DOUBLE_EQ((test + 1)(0, 0), test(0, 0) + 1);
+  EXPECT_THROW(test += Matrix<double>(2, 250), std::invalid_argument);
+  EXPECT_THROW(test.HadamardProduct(Matrix<double>(1, 3)),
+               std::invalid_argument);
+}
+
+TEST(test_operators, integral_equality) {
+  Matrix<int> test(2, 3), other(2, 3), row(1, 3), column(1, 1);
+  std::iota(test.begin(), test.end(), 1);
+  std::iota(other.begin(), other.end(), 1);
+  column(0, 0) = 5;
+
+  EXPECT_TRUE(test == other);
+  other(1, 2) = 7;
+  EXPECT_TRUE(test != other);
+  row += column;
+  EXPECT_TRUE(row == Matrix<int>(1, 3) + 5);
+  EXPECT_THROW(Matrix<int>(0, 3), std::invalid_argument);
+}
+
+TEST(test_operators, checked_access) {
+  Matrix<double> test(3, 2);
+
+  EXPECT_THROW(test.at(3, 0), std::out_of_range);
+  EXPECT_THROW(test.at(0, 2), std::out_of_range);
+  EXPECT_THROW(test.at(-1, 0), std::out_of_range);
+  EXPECT_NO_THROW(test.at(2, 1) = 4);
+  EXPECT_EQ(test(2, 1), 4);
+}
+
+TEST(test_operators, data_and_rows) {
+  Matrix<double> test(3, 2);
+  fill_matrix(&test, 1);
+
+  test.row(1)[0] = 7;
+  test.data()[5] = 9;
+
+  EXPECT_EQ(test.size(), 6U);
+  EXPECT_EQ(test.row(1).size(), 2U);
+  EXPECT_EQ(test(1, 0), 7);
+  EXPECT_EQ(test(2, 1), 9);
+  EXPECT_EQ(test.row(2).data(), test.data() + 4);
+}
+
+TEST(test_operators, iterators) {
+  Matrix<double> test(4, 5);
+  std::iota(test.begin(), test.end(), 0.0);
+  const Matrix<double> shared(test);
+
+  std::transform(std::execution::par, test.begin(), test.end(), test.begin(),
+                 [](double value) { return value * 2; });
+  double sum = std::reduce(std::execution::par, test.cbegin(), test.cend());
+
+  EXPECT_EQ(sum, 380);
+  EXPECT_EQ(test(3, 4), 38);
+  EXPECT_EQ(shared(3, 4), 19);
+  EXPECT_EQ(std::distance(shared.begin(), shared.end()), 20);
+}
+
 TEST(test_supports, load_from_file_correct) {
   Matrix<double> test;
   string path = string("datasets/marix_correct.txt");
@@ -415,6 +1133,191 @@ TEST(test_supports, write_file) {
   EXPECT_EQ(test(4, 4), 8.95);
 }
 
+TEST(test_supports, write_file_round_trip) {
+  Matrix<double> test(40, 3), result;
+  for (int i = 0; i < test.rows(); ++i) {
+    test(i, 0) = 0.1 * i;
+    test(i, 1) = -1.0 / (i + 1);
+    test(i, 2) = 1e-300 * i;
+  }
+  test(0, 0) = -0.0;
+
+  const Matrix<double>& saved = test;
+  saved.Save("matrix_output.txt", {-1, 4, false});
+  result.Load("matrix_output.txt");
+
+  EXPECT_EQ(result.rows(), 40);
+  EXPECT_EQ(result.cols(), 3);
+  EXPECT_TRUE(std::equal(test.begin(), test.end(), result.begin()));
+  EXPECT_FALSE(std::signbit(result(0, 0)));
+}
+
+TEST(test_supports, load_from_file_edge_cases) {
+  {
+    std::ofstream file("matrix_output.txt");
+    file << "3 3\n  1 2 3\n1e400 -1e400 x 4\n\xff" "5e0\n";
+  }
+  Matrix<double> test;
+  Matrix<int> integral;
+
+  test.Load("matrix_output.txt");
+  integral.Load("matrix_output.txt");
+
+  EXPECT_EQ(test(0, 0), 1);
+  EXPECT_EQ(test(0, 1), 2);
+  EXPECT_EQ(test(0, 2), 3);
+  EXPECT_TRUE(std::isinf(test(1, 0)));
+  EXPECT_EQ(test(1, 2), 4);
+  EXPECT_EQ(test(2, 0), 5);
+  EXPECT_EQ(integral(1, 0), std::numeric_limits<int>::max());
+  EXPECT_EQ(integral(1, 1), std::numeric_limits<int>::min());
+  {
+    std::ofstream file("matrix_output.txt");
+    file << "99999999999 2\n";
+  }
+  EXPECT_THROW(test.Load("matrix_output.txt"), std::invalid_argument);
+}
+
+TEST(test_supports, write_file_precision) {
+  Matrix<double> test(1, 2);
+  test(0, 0) = 1.0 / 3;
+  test(0, 1) = 2;
+
+  test.Save("matrix_output.txt", {2, 1, false});
+  std::ifstream file("matrix_output.txt");
+  string size, values;
+  getline(file, size);
+  getline(file, values);
+
+  EXPECT_EQ(size, "1 2");
+  EXPECT_EQ(values, "0.33 2.00 ");
+}
+
+TEST(test_supports, write_file_compressed) {
+#ifndef MATRIX_WITH_ZLIB
+  GTEST_SKIP() << "Compression requires MATRIX_WITH_ZLIB";
+#endif
+  Matrix<double> test, result;
+  test.Load("datasets/marix_correct.txt");
+
+  test.Save("matrix_output.txt.gz", {-1, 2, true});
+  result.Load("matrix_output.txt.gz");
+
+  EXPECT_TRUE(test == result);
+}
+
+TEST(test_supports, save_async) {
+  Matrix<double> test(30, 30), result;
+  fill_matrix(&test, 3);
+  size_t reported_bytes = 0;
+
+  std::future<hhullen::IoStats> saved = test.SaveAsync(
+      "matrix_output.txt", {},
+      [&reported_bytes](const hhullen::IoStats& stats) {
+        reported_bytes = stats.bytes;
+      });
+  fill_matrix(&test, 5);
+  hhullen::IoStats stats = saved.get();
+  result.Load("matrix_output.txt");
+
+  EXPECT_EQ(stats.bytes, reported_bytes);
+  EXPECT_GT(stats.bytes, 0U);
+  EXPECT_GE(stats.bandwidth(), 0);
+  run_through_matrix_num(result, 3);
+  run_through_matrix_num(test, 5);
+}
+
+TEST(test_supports, load_async) {
+  bool is_called = false;
+  std::future<Matrix<double>> loaded = Matrix<double>::LoadAsync(
+      "datasets/marix_correct.txt",
+      [&is_called](const hhullen::IoStats&) { is_called = true; });
+  std::future<Matrix<double>> missing =
+      Matrix<double>::LoadAsync("datasets/no_such_file.txt");
+
+  Matrix<double> test = loaded.get();
+
+  EXPECT_TRUE(is_called);
+  EXPECT_EQ(test.rows(), 5);
+  EXPECT_EQ(test(4, 4), 8.95);
+  EXPECT_THROW(missing.get(), std::invalid_argument);
+}
+
+TEST(test_chunked_storage, round_trip) {
+#ifndef MATRIX_WITH_ZLIB
+  GTEST_SKIP() << "Compression requires MATRIX_WITH_ZLIB";
+#endif
+  const std::string path = "matrix_output.chunked";
+  Matrix<double> test(300, 170);
+  for (int i = 0; i < 300; ++i) {
+    for (int j = 0; j < 170; ++j) {
+      test(i, j) = std::sin(i * 0.01) * j + 0.125;
+    }
+  }
+
+  hhullen::SaveChunked(test, path, {64, 48});
+  const hhullen::ChunkedHeader header = hhullen::ReadChunkedHeader(path);
+  EXPECT_EQ(header.grid_rows(), 5);
+  EXPECT_EQ(header.grid_cols(), 4);
+  EXPECT_TRUE(header.compress && header.shuffle);
+  Matrix<double> result = hhullen::LoadChunked<double>(path);
+  EXPECT_TRUE(std::equal(test.begin(), test.end(), result.begin()));
+
+  result = hhullen::LoadChunked<double>(path, 60, 40, 70, 90, 2);
+  EXPECT_EQ(result.rows(), 70);
+  EXPECT_EQ(result.cols(), 90);
+  for (int i = 0; i < 70; ++i) {
+    for (int j = 0; j < 90; ++j) {
+      EXPECT_EQ(result(i, j), test(60 + i, 40 + j));
+    }
+  }
+  EXPECT_EQ(hhullen::LoadChunked<double>(path, 299, 169, 1, 1)(0, 0),
+            test(299, 169));
+
+  hhullen::SaveChunked(test, path, {1000, 7, false, false});
+  EXPECT_EQ(std::filesystem::file_size(path), 36U + 300 * 170 * 8 + 25 * 16);
+  result = hhullen::LoadChunked<double>(path, 1);
+  EXPECT_TRUE(std::equal(test.begin(), test.end(), result.begin()));
+
+  Matrix<int> integers(5, 9);
+  std::iota(integers.begin(), integers.end(), -20);
+  hhullen::SaveChunked(integers, path, {2, 4});
+  EXPECT_TRUE(hhullen::LoadChunked<int>(path) == integers);
+  std::remove(path.c_str());
+}
+
+TEST(test_chunked_storage, errors) {
+#ifndef MATRIX_WITH_ZLIB
+  GTEST_SKIP() << "Compression requires MATRIX_WITH_ZLIB";
+#endif
+  const std::string path = "matrix_output.chunked";
+  Matrix<float> test(20, 20);
+  hhullen::SaveChunked(test, path, {8, 8});
+
+  EXPECT_THROW(hhullen::LoadChunked<double>(path), std::invalid_argument);
+  EXPECT_THROW(hhullen::LoadChunked<float>(path, 10, 0, 11, 5),
+               std::out_of_range);
+  EXPECT_THROW(hhullen::LoadChunked<float>(path, -1, 0, 1, 1),
+               std::out_of_range);
+  EXPECT_THROW(hhullen::SaveChunked(test, path, {0, 8}),
+               std::invalid_argument);
+  EXPECT_THROW(hhullen::LoadChunked<float>("datasets/marix_correct.txt"),
+               std::invalid_argument);
+  EXPECT_THROW(hhullen::LoadChunked<float>("datasets/no_such_file"),
+               std::invalid_argument);
+
+  std::filesystem::resize_file(path, std::filesystem::file_size(path) - 1);
+  EXPECT_THROW(hhullen::LoadChunked<float>(path), std::invalid_argument);
+  hhullen::SaveChunked(test, path, {8, 8});
+  {
+    std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+    file.seekp(40);
+    file.put('\x7f');
+  }
+  EXPECT_THROW(hhullen::LoadChunked<float>(path), std::invalid_argument);
+  std::remove(path.c_str());
+}
+
 TEST(test_supports, multiply_row_to_number) {
   Matrix<double> test;
   string path = string("datasets/marix_correct.txt");
@@ -498,6 +1401,19 @@ TEST(test_supports, exchqnge_rows) {
   EXPECT_EQ(test(4, 4), 8.95);
 }
 
+TEST(test_supports, summarize_permuted_rows) {
+  Matrix<double> test;
+  test.Load("datasets/marix_correct.txt");
+  hhullen::Permutation order(test.rows());
+
+  order.Swap(0, 2);
+  test.ProcessRows(0, 2, [](double& v_1, double& v_2) { v_2 += v_1; }, order);
+
+  EXPECT_EQ(test(0, 0), 5);
+  EXPECT_EQ(test(2, 0), 4);
+  EXPECT_EQ(test(0, 4), 14);
+}
+
 TEST(test_supports, summarize_rows) {
   Matrix<double> test;
   string path = string("datasets/marix_correct.txt");
@@ -541,9 +1457,517 @@ TEST(test_supports, summarize_rows) {
   EXPECT_EQ(test(4, 4), 8.95);
 }
 
+template <class Layout>
+void ExpectLayoutOperations(const Matrix<double>& a, const Matrix<double>& b) {
+  hhullen::LayoutMatrix<double, Layout> left(a), right(b);
+  hhullen::LayoutMatrix<double, Layout> product(b.Transpose());
+  hhullen::LayoutMatrix<double, hhullen::RowMajorLayout> row_major(left);
+
+  EXPECT_TRUE(left.ToMatrix() == a);
+  EXPECT_TRUE(row_major.ToMatrix() == a);
+  EXPECT_TRUE(left.Transpose().ToMatrix() == a.Transpose());
+  EXPECT_TRUE((left + right).ToMatrix() == a + b);
+  EXPECT_TRUE((left - right * 2).ToMatrix() == a - b * 2);
+  EXPECT_TRUE((left * product).ToMatrix() == a * b.Transpose());
+  EXPECT_DOUBLE_EQ(left(44, 69), a(44, 69));
+  EXPECT_GE(left.storage_size(), a.size());
+  EXPECT_THROW(left.at(45, 0), std::out_of_range);
+  EXPECT_THROW(left += product, std::invalid_argument);
+
+  Matrix<double> row(1, 70), column(45, 1);
+  for (int j = 0; j < 70; ++j) {
+    row(0, j) = j + 1;
+  }
+  for (int i = 0; i < 45; ++i) {
+    column(i, 0) = 0.5 * i - 3;
+  }
+  Matrix<double> expected = (a + 1.5 - 0.5) / 2;
+  expected += row;
+  expected.HadamardProduct(column);
+  expected.HadamardDivision(b);
+  hhullen::LayoutMatrix<double, Layout> broadcast = (left + 1.5 - 0.5) / 2;
+  broadcast += hhullen::LayoutMatrix<double, Layout>(row);
+  broadcast.HadamardProduct(hhullen::LayoutMatrix<double, Layout>(column));
+  broadcast.HadamardDivision(right);
+  EXPECT_TRUE((broadcast == hhullen::LayoutMatrix<double, Layout>(expected)));
+  EXPECT_THROW(broadcast.HadamardProduct(product), std::invalid_argument);
+
+  double sum = 0;
+  left.ForEach([&sum](int i, int j, double value) { sum += value - i - j; });
+  EXPECT_NEAR(sum, std::accumulate(a.begin(), a.end(), 0.0) -
+                       45.0 * 70 * (44.0 / 2 + 69.0 / 2),
+              1e-6);
+}
+
+TEST(test_layout_matrix, layouts) {
+  Matrix<double> a(45, 70), b(45, 70);
+  for (int i = 0; i < 45; ++i) {
+    for (int j = 0; j < 70; ++j) {
+      a(i, j) = i * 100 + j;
+      b(i, j) = std::cos(i - j);
+    }
+  }
+
+  ExpectLayoutOperations<hhullen::RowMajorLayout>(a, b);
+  ExpectLayoutOperations<hhullen::ColMajorLayout>(a, b);
+  ExpectLayoutOperations<hhullen::TiledLayout<16>>(a, b);
+  ExpectLayoutOperations<hhullen::ZOrderLayout<8>>(a, b);
+  EXPECT_EQ((hhullen::LayoutMatrix<int, hhullen::TiledLayout<16>>(45, 70)
+                 .storage_size()),
+            48u * 80u);
+}
+
+TEST(test_layout_matrix, z_order_size) {
+  using Layout = hhullen::ZOrderLayout<8>;
+  for (auto [rows, cols] : {std::pair(4000, 40), std::pair(40, 4000),
+                            std::pair(300, 20), std::pair(20, 300),
+                            std::pair(45, 70)}) {
+    const size_t size = Layout::Size(rows, cols);
+    const size_t elements = static_cast<size_t>(rows * cols);
+    size_t visited = 0, next = 0;
+    bool is_ordered = true;
+    Layout::Visit(rows, cols, [&](int i, int j, size_t offset) {
+      is_ordered = is_ordered && offset == Layout::Offset(i, j, rows, cols) &&
+                   offset >= next && offset < size;
+      next = offset + 1;
+      ++visited;
+    });
+
+    EXPECT_LE(size, 4 * elements);
+    EXPECT_TRUE(is_ordered);
+    EXPECT_EQ(visited, elements);
+  }
+  for (auto [row, col] : {std::pair(5, 200), std::pair(0x1234, 0xABCD)}) {
+    size_t expected = 0;
+    for (size_t bit = 0; bit < 16; ++bit) {
+      expected |= ((static_cast<size_t>(col) >> bit) & 1) << (2 * bit);
+      expected |= ((static_cast<size_t>(row) >> bit) & 1) << (2 * bit + 1);
+    }
+    EXPECT_EQ(Layout::Interleave(static_cast<size_t>(row),
+                                 static_cast<size_t>(col)),
+              expected);
+  }
+}
+
+TEST(test_structured_matrix, symmetric) {
+  Matrix<double> a(70, 70), b(70, 20), expected(70, 20);
+  for (int i = 0; i < 70; ++i) {
+    for (int j = 0; j <= i; ++j) {
+      a(i, j) = a(j, i) = (i == j ? 200.0 : 1.0 / (1 + i + 2 * j));
+    }
+  }
+  fill_matrix(&b, 2);
+  Matrix<double>::Gemm(1, a, false, b, false, 0, &expected);
+
+  hhullen::SymmetricMatrix<double> packed(a);
+  EXPECT_EQ(packed.storage_size(), 70U * 71 / 2);
+  EXPECT_TRUE(packed.ToMatrix() == a);
+  EXPECT_TRUE(packed * b == expected);
+  packed(3, 5) = 7;
+  EXPECT_EQ(packed(5, 3), 7);
+
+  packed = hhullen::SymmetricMatrix<double>(a);
+  std::vector<double> rhs(70, 1), x(70);
+  hhullen::SolverReport report = hhullen::ConjugateGradient(packed, rhs, x);
+  EXPECT_TRUE(report.converged);
+  EXPECT_TRUE(Column(x) == a.Solve(Column(rhs)));
+
+  EXPECT_THROW(packed * Matrix<double>(3, 3), std::invalid_argument);
+  EXPECT_THROW(packed.at(70, 0), std::out_of_range);
+  EXPECT_THROW(hhullen::SymmetricMatrix<double>(Matrix<double>(2, 3)),
+               std::invalid_argument);
+}
+
+TEST(test_structured_matrix, triangular) {
+  Matrix<double> a(60, 60), b(60, 7);
+  for (int i = 0; i < 60; ++i) {
+    for (int j = 0; j < 60; ++j) {
+      a(i, j) = i == j ? 4 + i % 3 : 0.5 / (1 + std::abs(i - j));
+    }
+  }
+  fill_matrix(&b, 3);
+  for (hhullen::Triangle triangle :
+       {hhullen::Triangle::kLower, hhullen::Triangle::kUpper}) {
+    hhullen::TriangularMatrix<double> packed(a, triangle);
+    Matrix<double> dense = packed.ToMatrix(), product(60, 7);
+    const int outside = triangle == hhullen::Triangle::kLower ? 0 : 59;
+    EXPECT_EQ(dense(outside, 59 - outside), 0);
+    EXPECT_EQ(dense(59 - outside, outside), a(59 - outside, outside));
+    Matrix<double>::Gemm(1, dense, false, b, false, 0, &product);
+
+    EXPECT_EQ(packed.storage_size(), 60U * 61 / 2);
+    EXPECT_TRUE(packed * b == product);
+    EXPECT_TRUE(packed.Solve(product) == b);
+    EXPECT_TRUE(packed.Solve(b) == dense.Solve(b));
+    EXPECT_TRUE(packed * b == product);
+    EXPECT_EQ(std::as_const(packed)(outside, 59 - outside), 0);
+    EXPECT_THROW(packed.at(outside, 59 - outside) = 1, std::out_of_range);
+  }
+  hhullen::TriangularMatrix<double> singular(3, hhullen::Triangle::kUpper);
+  EXPECT_THROW(singular.Solve(Matrix<double>(3, 1)), std::invalid_argument);
+}
+
+TEST(test_structured_matrix, band) {
+  const int n = 500;
+  Matrix<double> a(n, n), b(n, 40), expected(n, 40);
+  for (int i = 0; i < n; ++i) {
+    for (int j = std::max(0, i - 2); j <= std::min(n - 1, i + 1); ++j) {
+      a(i, j) = i == j ? 4 : -1.0 / (1 + j);
+    }
+  }
+  fill_matrix(&b, 1);
+  Matrix<double>::Gemm(1, a, false, b, false, 0, &expected);
+
+  hhullen::BandMatrix<double> band(a, 2, 1);
+  EXPECT_EQ(band.storage_size(), static_cast<size_t>(n) * 4);
+  EXPECT_TRUE(band.ToMatrix() == a);
+  EXPECT_TRUE(band * b == expected);
+  EXPECT_EQ(std::as_const(band)(0, 3), 0);
+  EXPECT_THROW(band.at(0, 3) = 1, std::out_of_range);
+
+  std::vector<double> x(n, 1), y(n);
+  band.Apply(x, y);
+  Matrix<double> ones(n, 1);
+  ones.ProcessEach([](double& value) { value = 1; });
+  EXPECT_TRUE(Column(y) == a * ones);
+
+  EXPECT_EQ(hhullen::BandMatrix<int>(3, 5, 0).lower(), 2);
+  EXPECT_THROW(hhullen::BandMatrix<int>(3, -1, 0), std::invalid_argument);
+}
+
+TEST(test_distributed, multiplication_and_transpose) {
+  Matrix<double> a(70, 45), b(45, 33), expected(70, 33);
+  for (int i = 0; i < 70; ++i) {
+    for (int j = 0; j < 45; ++j) {
+      a(i, j) = (i * 7 + j * 3) % 11 - 5;
+    }
+  }
+  for (int i = 0; i < 45; ++i) {
+    for (int j = 0; j < 33; ++j) {
+      b(i, j) = (i * 5 + j) % 7 - 3;
+    }
+  }
+  Matrix<double>::Gemm(1, a, false, b, false, 0, &expected);
+
+  for (int processes : {1, 3, 4}) {
+    EXPECT_NO_THROW(hhullen::RunProcesses(
+        processes, [&](hhullen::Communicator& comm) {
+          hhullen::DistributedMatrix<double> left(comm, a, 8);
+          hhullen::DistributedMatrix<double> right(
+              comm, 45, 33, 8, [&b](int i, int j) { return b(i, j); });
+          const Matrix<double> product = (left * right).Gather();
+          const int root = 1 % comm.size();
+          const Matrix<double> transposed = left.Transpose().Gather(root);
+          comm.Barrier();
+          if (comm.rank() == 0) {
+            EXPECT_EQ(left.grid_rows() * left.grid_cols(), processes);
+            EXPECT_TRUE(product == expected);
+          }
+          if (comm.rank() == root && !(transposed == a.Transpose())) {
+            throw std::runtime_error("Wrong distributed transpose");
+          }
+        }));
+  }
+}
+
+TEST(test_distributed, uneven_distribution) {
+  Matrix<double> a(5, 3), b(3, 9);
+  fill_matrix(&a, 2);
+  fill_matrix(&b, 3);
+  EXPECT_NO_THROW(hhullen::RunProcesses(4, [&](hhullen::Communicator& comm) {
+    hhullen::DistributedMatrix<double> left(comm, a, 4), right(comm, b, 4);
+    if (comm.rank() == 3 &&
+        (left.local_rows() != 1 || left.local_cols() != 0)) {
+      throw std::runtime_error("Wrong local extent");
+    }
+    const Matrix<double> product = (left * right).Gather();
+    const Matrix<double> transposed = right.Transpose().Gather();
+    if (comm.rank() == 0) {
+      EXPECT_TRUE(product == a * b);
+      EXPECT_TRUE(transposed == b.Transpose());
+    }
+  }));
+
+  auto mismatched = [](hhullen::Communicator& comm) {
+    hhullen::DistributedMatrix<double> test(comm, 3, 4);
+    static_cast<void>(test * test);
+  };
+  auto failed = [](hhullen::Communicator& comm) {
+    if (comm.rank() == 2) {
+      throw std::runtime_error("Failure of one process");
+    }
+    comm.Barrier();
+  };
+  EXPECT_THROW(hhullen::RunProcesses(2, mismatched), std::invalid_argument);
+  EXPECT_THROW(hhullen::RunProcesses(3, failed), std::runtime_error);
+}
+
+TEST(test_pipeline, streams_blocks) {
+#ifndef MATRIX_WITH_ZLIB
+  GTEST_SKIP() << "Compression requires MATRIX_WITH_ZLIB";
+#endif
+  Matrix<double> test(1000, 37);
+  for (int i = 0; i < 1000; ++i) {
+    for (int j = 0; j < 37; ++j) {
+      test(i, j) = std::sin(i * 0.1) * j - 0.5;
+    }
+  }
+  Matrix<double> weights(37, 5);
+  std::iota(weights.begin(), weights.end(), -80.0);
+  weights *= 0.25;
+  test.Save("matrix_output.txt");
+
+  hhullen::Pipeline<double> pipeline({.block_rows = 64, .queue_blocks = 2});
+  pipeline.Load("matrix_output.txt")
+      .Transform([](Matrix<double>& block) { block *= 2.0; })
+      .Transform([&weights](Matrix<double>& block, int first_row) {
+        block = block * weights;
+        for (double& value : block.row(0)) {
+          value += first_row;
+        }
+      })
+      .Save("matrix_output.txt.gz", {.compress = true});
+  const hhullen::PipelineStats stats = pipeline.Run();
+  EXPECT_EQ(stats.blocks, 16);
+  EXPECT_GE(stats.peak_blocks, 1);
+  EXPECT_LE(stats.peak_blocks, 2 * 3 + 4);
+  EXPECT_GT(stats.bytes, 0U);
+
+  Matrix<double> expected = test * 2.0 * weights;
+  for (int first_row = 0; first_row < 1000; first_row += 64) {
+    for (double& value : expected.row(first_row)) {
+      value += first_row;
+    }
+  }
+  hhullen::Pipeline<double>({.threads = 1})
+      .Load("matrix_output.txt.gz")
+      .Save("matrix_output.txt")
+      .Run();
+  Matrix<double> result;
+  result.Load("matrix_output.txt");
+  EXPECT_TRUE(result == expected);
+  std::remove("matrix_output.txt");
+  std::remove("matrix_output.txt.gz");
+}
+
+TEST(test_pipeline, errors) {
+  Matrix<int> test(300, 4);
+  std::iota(test.begin(), test.end(), 0);
+  test.Save("matrix_output.txt");
+
+  hhullen::Pipeline<int> failing({.block_rows = 16});
+  failing.Load("matrix_output.txt")
+      .Transform([](Matrix<int>&, int first_row) {
+        if (first_row >= 160) {
+          throw std::runtime_error("Transformation failed");
+        }
+      })
+      .Save("matrix_output.txt.gz");
+  EXPECT_THROW(failing.Run(), std::runtime_error);
+
+  hhullen::Pipeline<int> resizing({.block_rows = 16});
+  resizing.Load("matrix_output.txt")
+      .Transform([](Matrix<int>& block) { block = Matrix<int>(1, 4); })
+      .Save("matrix_output.txt.gz");
+  EXPECT_THROW(resizing.Run(), std::invalid_argument);
+
+  EXPECT_THROW(hhullen::Pipeline<int>().Load("matrix_output.txt").Run(),
+               std::invalid_argument);
+  EXPECT_THROW(hhullen::Pipeline<int>()
+                   .Load("matrix_missing.txt")
+                   .Save("matrix_output.txt.gz")
+                   .Run(),
+               std::invalid_argument);
+  EXPECT_THROW(hhullen::Pipeline<int>({.block_rows = 0}),
+               std::invalid_argument);
+  std::remove("matrix_output.txt");
+  std::remove("matrix_output.txt.gz");
+}
+
+TEST(test_stencil, convolution) {
+  Matrix<double> image(40, 1100), small(3, 2), large(9, 9);
+  fill_matrix(&image, 0);
+  for (int i = 0; i < image.rows(); ++i) {
+    for (int j = 0; j < image.cols(); ++j) {
+      image(i, j) = std::sin(i * 0.3 + j * 0.07);
+    }
+  }
+  small(0, 0) = 1;
+  small(1, 1) = -2;
+  small(2, 0) = 0.5;
+  for (int i = 0; i < 9; ++i) {
+    for (int j = 0; j < 9; ++j) {
+      large(i, j) = 1.0 / (i + j + 1);
+    }
+  }
+
+  for (const Matrix<double>* kernel : {&small, &large}) {
+    const int center_i = kernel->rows() / 2, center_j = kernel->cols() / 2;
+    Matrix<double> expected(image.rows(), image.cols());
+    for (int i = 0; i < image.rows(); ++i) {
+      for (int j = 0; j < image.cols(); ++j) {
+        for (int p = 0; p < kernel->rows(); ++p) {
+          for (int q = 0; q < kernel->cols(); ++q) {
+            const int row = i + center_i - p, col = j + center_j - q;
+            if (row >= 0 && col >= 0 && row < image.rows() &&
+                col < image.cols()) {
+              expected(i, j) += (*kernel)(p, q) * image(row, col);
+            }
+          }
+        }
+      }
+    }
+
+    EXPECT_TRUE(hhullen::Convolve(image, *kernel) == expected);
+    EXPECT_TRUE(hhullen::Convolve(image, *kernel, hhullen::Boundary::kZero,
+                                  hhullen::ConvolutionMethod::kDirect) ==
+                expected);
+    EXPECT_TRUE(hhullen::Convolve(image, *kernel, hhullen::Boundary::kZero,
+                                  hhullen::ConvolutionMethod::kIm2col) ==
+                expected);
+  }
+  Matrix<double> identity(1, 1);
+  identity(0, 0) = 1;
+  EXPECT_TRUE(hhullen::Convolve(image, identity) == image);
+
+  Matrix<double> delta(3, 2);
+  delta(1, 1) = 3;
+  std::vector<Matrix<double>> bank =
+      hhullen::Convolve(image, {small, small * 2, delta},
+                        hhullen::Boundary::kClamp,
+                        hhullen::ConvolutionMethod::kIm2col);
+  EXPECT_EQ(bank.size(), 3u);
+  EXPECT_TRUE(bank[1] == bank[0] * 2);
+  EXPECT_TRUE(bank[2] == image * 3);
+  EXPECT_TRUE(bank[0] == hhullen::Convolve(image, small,
+                                           hhullen::Boundary::kClamp));
+  EXPECT_THROW(hhullen::Convolve(image, {small, large}),
+               std::invalid_argument);
+}
+
+TEST(test_stencil, boundaries) {
+  Matrix<int> grid(3, 4);
+  for (int i = 0; i < 3; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      grid(i, j) = i * 4 + j;
+    }
+  }
+  auto five_point = [](const hhullen::StencilView<int>& view) {
+    return view(-1, 0) + view(1, 0) + view(0, -1) + view(0, 1) -
+           4 * view(0, 0);
+  };
+  auto left_neighbor = [](const hhullen::StencilView<int>& view) {
+    return view(0, -2) * 100 + view(-1, 0);
+  };
+
+  Matrix<int> zero =
+      hhullen::Stencil(grid, 1, hhullen::Boundary::kZero, five_point);
+  Matrix<int> clamp =
+      hhullen::Stencil(grid, 1, hhullen::Boundary::kClamp, five_point);
+  Matrix<int> reflect =
+      hhullen::Stencil(grid, 2, hhullen::Boundary::kReflect, left_neighbor);
+  Matrix<int> wrap =
+      hhullen::Stencil(grid, 2, hhullen::Boundary::kWrap, left_neighbor);
+
+  EXPECT_EQ(zero(0, 0), 4 + 1 - 0);
+  EXPECT_EQ(zero(1, 1), 1 + 9 + 4 + 6 - 20);
+  EXPECT_EQ(clamp(0, 0), 0 + 4 + 0 + 1 - 0);
+  EXPECT_EQ(clamp(2, 3), 7 + 11 + 10 + 11 - 44);
+  EXPECT_EQ(reflect(0, 0), 2 * 100 + 4);
+  EXPECT_EQ(reflect(0, 1), 1 * 100 + 5);
+  EXPECT_EQ(wrap(0, 0), 2 * 100 + 8);
+  EXPECT_EQ(wrap(1, 1), 7 * 100 + 1);
+  EXPECT_THROW(hhullen::Stencil(grid, -1, hhullen::Boundary::kZero,
+                                five_point),
+               std::invalid_argument);
+}
+
+TEST(test_bit_matrix, logic_and_counts) {
+  Matrix<int> source(3, 70);
+  for (int j = 0; j < 70; j += 3) {
+    source(0, j) = 1;
+  }
+  source(1, 69) = 5;
+  source(2, 0) = -1;
+  hhullen::BitMatrix mask = hhullen::BitMatrix::FromMatrix(source);
+  hhullen::BitMatrix inverted = ~mask;
+
+  EXPECT_EQ(mask.words_per_row(), 2u);
+  EXPECT_TRUE(mask.get(1, 69));
+  EXPECT_FALSE(mask.get(1, 68));
+  EXPECT_EQ(mask.Count(), 26u);
+  EXPECT_EQ(inverted.Count(), 3u * 70u - 26u);
+  EXPECT_EQ(mask.RowCounts(), std::vector<int>({24, 1, 1}));
+  EXPECT_EQ(mask.ColCounts()[0], 2);
+  EXPECT_EQ(mask.ColCounts()[69], 2);
+  EXPECT_EQ((mask & inverted).Count(), 0u);
+  EXPECT_EQ((mask | inverted).Count(), 210u);
+  EXPECT_TRUE((mask ^ inverted) == ~hhullen::BitMatrix(3, 70));
+  Matrix<int> unpacked = mask.ToMatrix<int>();
+  EXPECT_EQ(unpacked(1, 69), 1);
+  EXPECT_EQ(unpacked(2, 0), 1);
+  EXPECT_EQ(unpacked(0, 1), 0);
+  mask.set(1, 69, false);
+  EXPECT_FALSE(mask.get(1, 69));
+  EXPECT_THROW(mask.get(3, 0), std::out_of_range);
+  EXPECT_THROW(mask &= hhullen::BitMatrix(3, 71), std::invalid_argument);
+}
+
+TEST(test_bit_matrix, boolean_multiplication) {
+  Matrix<int> left(90, 130), right(130, 75);
+  for (int i = 0; i < 90; ++i) {
+    for (int j = 0; j < 130; ++j) {
+      left(i, j) = (i * 7 + j * 13) % 17 == 0;
+    }
+  }
+  for (int i = 0; i < 130; ++i) {
+    for (int j = 0; j < 75; ++j) {
+      right(i, j) = (i * 5 + j * 3) % 23 == 0;
+    }
+  }
+  Matrix<int> expected = left * right;
+  for (int& value : expected) {
+    value = value > 0;
+  }
+
+  hhullen::BitMatrix product = hhullen::BitMatrix::FromMatrix(left) *
+                               hhullen::BitMatrix::FromMatrix(right);
+
+  EXPECT_EQ(product.rows(), 90);
+  EXPECT_EQ(product.cols(), 75);
+  EXPECT_TRUE(product == hhullen::BitMatrix::FromMatrix(expected));
+  Matrix<double> unpacked = product.ToMatrix<double>();
+  EXPECT_DOUBLE_EQ(unpacked(0, 0), expected(0, 0));
+  EXPECT_EQ(static_cast<int>(product.Count()),
+            std::accumulate(expected.begin(), expected.end(), 0));
+}
+
+TEST(test_bit_matrix, col_counts) {
+  Matrix<int> source(150, 131);
+  for (int i = 0; i < 150; ++i) {
+    for (int j = 0; j < 131; ++j) {
+      source(i, j) = (i * 11 + j * j) % 7 < 3;
+    }
+  }
+  std::vector<int> expected(131);
+  for (int i = 0; i < 150; ++i) {
+    for (int j = 0; j < 131; ++j) {
+      expected[static_cast<size_t>(j)] += source(i, j);
+    }
+  }
+
+  EXPECT_EQ(hhullen::BitMatrix::FromMatrix(source).ColCounts(), expected);
+  EXPECT_EQ((~hhullen::BitMatrix(1, 5)).ColCounts(), std::vector<int>(5, 1));
+}
+
 int main(int argc, char* argv[]) {
+  // Kernels run with default tuning, not with tuning cache of the host
+  setenv("MATRIX_TUNING_CACHE", "matrix_tuning_cache.txt", 1);
+  std::remove("matrix_tuning_cache.txt");
   ::testing::InitGoogleTest(&argc, argv);
-  return RUN_ALL_TESTS();
+  const int status = RUN_ALL_TESTS();
+  std::remove("matrix_tuning_cache.txt");
+  return status;
 }
 
 void run_through_matrix_num(Matrix<double>& test, double value) {
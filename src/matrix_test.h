@@ -3,7 +3,19 @@
 
 #include <gtest/gtest.h>
 
+#include <execution>
+#include <numeric>
+
+#include "bit_matrix.h"
+#include "chunked_storage.cc"
+#include "decompositions.cc"
+#include "distributed.cc"
+#include "iterative.cc"
+#include "layout_matrix.cc"
 #include "matrix.cc"
+#include "pipeline.cc"
+#include "stencil.cc"
+#include "structured_matrix.cc"
 
 using hhullen::Matrix;
 using std::string;
@@ -0,0 +1,107 @@
+#ifndef SRC_NUMA_SUPPORT_H_
+#define SRC_NUMA_SUPPORT_H_
+
+#include <cstddef>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+#ifdef MATRIX_WITH_NUMA
+#include <numa.h>
+#endif
+
+namespace hhullen {
+
+/**
+ * @brief Placement of matrix pages: on nodes of threads which first write
+ * them, or interleaved across all nodes
+ *
+ */
+enum class MemoryPolicy { kFirstTouch, kInterleaved };
+
+/**
+ * @brief Returns amount of NUMA nodes, 1 if libnuma is not used or not
+ * supported by the system
+ *
+ * @return int
+ */
+inline int NumaNodes() {
+#ifdef MATRIX_WITH_NUMA
+  if (numa_available() >= 0) {
+    return numa_max_node() + 1;
+  }
+#endif
+  return 1;
+}
+
+/**
+ * @brief Allocates memory with pages interleaved across all NUMA nodes
+ *
+ * @param bytes size_t type
+ * @return void* allocated memory or nullptr if interleaving is unavailable
+ */
+inline void* AllocateInterleaved(size_t bytes) {
+#ifdef MATRIX_WITH_NUMA
+  if (numa_available() >= 0) {
+    return numa_alloc_interleaved(bytes);
+  }
+#endif
+  static_cast<void>(bytes);
+  return nullptr;
+}
+
+/**
+ * @brief Frees memory allocated by AllocateInterleaved
+ *
+ * @param memory void* type
+ * @param bytes size_t type
+ */
+inline void FreeInterleaved(void* memory, size_t bytes) {
+#ifdef MATRIX_WITH_NUMA
+  numa_free(memory, bytes);
+#else
+  static_cast<void>(memory);
+  static_cast<void>(bytes);
+#endif
+}
+
+/**
+ * @brief Pins calling thread to "index"-th CPU of its allowed CPU set (modulo
+ * set size). Does nothing on systems without affinity support
+ *
+ * @param index int type
+ * @return true if thread was pinned
+ */
+inline bool PinCurrentThread(int index) {
+#ifdef __linux__
+  cpu_set_t allowed;
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+    return false;
+  }
+  const int count = CPU_COUNT(&allowed);
+  if (count == 0) {
+    return false;
+  }
+
+  int target = index % count;
+  for (size_t cpu = 0; cpu < static_cast<size_t>(CPU_SETSIZE); ++cpu) {
+    if (CPU_ISSET(cpu, &allowed) && target-- == 0) {
+      cpu_set_t pinned;
+      CPU_ZERO(&pinned);
+      CPU_SET(cpu, &pinned);
+      return pthread_setaffinity_np(pthread_self(), sizeof(pinned),
+                                    &pinned) == 0;
+    }
+  }
+#else
+  static_cast<void>(index);
+#endif
+  return false;
+}
+
+}  // namespace hhullen
+
+#endif  // SRC_NUMA_SUPPORT_H_
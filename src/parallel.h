@@ -0,0 +1,145 @@
+#ifndef SRC_PARALLEL_H_
+#define SRC_PARALLEL_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <thread>
+#include <vector>
+
+#include "numa_support.h"
+
+namespace hhullen {
+
+/**
+ * @brief Amount of processed elements from which kernels split their work
+ * between threads
+ *
+ */
+inline constexpr size_t kParallelElements = 1 << 16;
+
+/**
+ * @brief Returns amount of hardware threads, at least 1
+ *
+ * @return int
+ */
+inline int HardwareThreads() {
+  unsigned threads = std::thread::hardware_concurrency();
+  return threads == 0 ? 1 : static_cast<int>(threads);
+}
+
+/**
+ * @brief Returns flag of pinning ParallelFor threads to CPUs. Enabled by
+ * default on machines with several NUMA nodes
+ *
+ * @return std::atomic<bool>&
+ */
+inline std::atomic<bool>& ThreadPinning() {
+  static std::atomic<bool> is_enabled(NumaNodes() > 1);
+  return is_enabled;
+}
+
+/**
+ * @brief Enables or disables pinning of ParallelFor threads to CPUs
+ *
+ * @param is_enabled bool type
+ */
+inline void SetThreadPinning(bool is_enabled) { ThreadPinning() = is_enabled; }
+
+/**
+ * @brief Splits [begin, end) range into "threads" contiguous parts and calls
+ * "body" for each part in its own thread. Calling thread processes the first
+ * part unless threads are pinned: then part N always runs on the N-th CPU, so
+ * equal partitions of one range touch memory from the same NUMA node. First
+ * exception thrown by any part is rethrown after all joined
+ *
+ * @param begin int type first index
+ * @param end int type index after last
+ * @param threads int type amount of threads, 0 means all hardware threads
+ * @param body const std::function<void(int, int)>& type part handler
+ */
+inline void ParallelFor(int begin, int end, int threads,
+                        const std::function<void(int, int)>& body) {
+  const int amount = end - begin;
+  if (amount <= 0) {
+    return;
+  }
+  if (threads <= 0) {
+    threads = HardwareThreads();
+  }
+  threads = std::min(threads, amount);
+
+  std::vector<std::exception_ptr> errors(static_cast<size_t>(threads));
+  auto run_part = [&](int part) {
+    int first = begin + static_cast<int>(static_cast<long>(amount) * part /
+                                         threads);
+    int last = begin + static_cast<int>(static_cast<long>(amount) *
+                                        (part + 1) / threads);
+    try {
+      body(first, last);
+    } catch (...) {
+      errors[static_cast<size_t>(part)] = std::current_exception();
+    }
+  };
+
+  const bool is_pinned = ThreadPinning() && threads > 1;
+  std::vector<std::thread> workers;
+  workers.reserve(static_cast<size_t>(threads));
+  for (int part = is_pinned ? 0 : 1; part < threads; ++part) {
+    workers.emplace_back([&run_part, is_pinned, part] {
+      if (is_pinned) {
+        PinCurrentThread(part);
+      }
+      run_part(part);
+    });
+  }
+  if (!is_pinned) {
+    run_part(0);
+  }
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  for (const std::exception_ptr& error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+/**
+ * @brief Calls body(first, last) for parts of [0, count), split between
+ * threads by ParallelFor when "work" reaches kParallelElements
+ *
+ * @param count int type amount of indices
+ * @param work size_t type amount of elements processed for all indices
+ * @param body const std::function<void(int, int)>& type part handler
+ */
+inline void ForEachPart(int count, size_t work,
+                        const std::function<void(int, int)>& body) {
+  if (work >= kParallelElements) {
+    ParallelFor(0, count, 0, body);
+  } else {
+    body(0, count);
+  }
+}
+
+/**
+ * @brief Calls "body" for blocks of rows, in parallel for large matrices.
+ * Partition depends only on amount of rows, so with pinned threads each
+ * block of a matrix is processed by the thread which first touched it
+ *
+ * @param rows int type amount of rows
+ * @param cols size_t type amount of columns
+ * @param body const std::function<void(int, int)>& type
+ */
+inline void ForEachRowBlock(int rows, size_t cols,
+                            const std::function<void(int, int)>& body) {
+  ForEachPart(rows, static_cast<size_t>(rows) * cols, body);
+}
+
+}  // namespace hhullen
+
+#endif  // SRC_PARALLEL_H_
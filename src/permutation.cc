@@ -0,0 +1,140 @@
+#include "permutation.h"
+
+#include <numeric>
+#include <utility>
+
+namespace hhullen {
+
+/**
+ * @brief Construct a new empty Permutation object
+ *
+ */
+Permutation::Permutation() {}
+
+/**
+ * @brief Construct a new identity Permutation object
+ *
+ * @param size int type amount of rows
+ */
+Permutation::Permutation(int size) {
+  if (size < 0) {
+    throw std::invalid_argument("Creation permutation of negative size");
+  }
+  order_.resize(static_cast<size_t>(size));
+  std::iota(order_.begin(), order_.end(), 0);
+}
+
+/**
+ * @brief Creates permutation from LAPACK-like pivots: row "i" was swapped
+ * with row "pivots[i]" on step "i"
+ *
+ * @param pivots const std::vector<int>& type 0-based pivot rows
+ * @return Permutation
+ */
+Permutation Permutation::FromPivots(const std::vector<int>& pivots) {
+  Permutation returnable(static_cast<int>(pivots.size()));
+  for (int i = 0; i < returnable.size(); ++i) {
+    returnable.Swap(i, pivots[static_cast<size_t>(i)]);
+  }
+
+  return returnable;
+}
+
+/**
+ * @brief Returns amount of rows
+ *
+ * @return int
+ */
+int Permutation::size() const {
+  return static_cast<int>(order_.size());
+}
+
+/**
+ * @brief Checks whether permutation keeps rows in place
+ *
+ * @return bool
+ */
+bool Permutation::IsIdentity() const {
+  for (size_t i = 0; i < order_.size(); ++i) {
+    if (order_[i] != static_cast<int>(i)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+/**
+ * @brief Swaps two rows in O(1)
+ *
+ * @param i int type
+ * @param j int type
+ */
+void Permutation::Swap(int i, int j) {
+  CheckIndex(i);
+  CheckIndex(j);
+  std::swap(order_[static_cast<size_t>(i)], order_[static_cast<size_t>(j)]);
+}
+
+/**
+ * @brief Returns permutation which restores original row order
+ *
+ * @return Permutation
+ */
+Permutation Permutation::Inverse() const {
+  Permutation returnable(size());
+  for (size_t i = 0; i < order_.size(); ++i) {
+    returnable.order_[static_cast<size_t>(order_[i])] = static_cast<int>(i);
+  }
+
+  return returnable;
+}
+
+/**
+ * @brief Returns source row index of row "i"
+ *
+ * @param i int type
+ * @return int
+ */
+int Permutation::operator[](int i) const {
+#ifndef NDEBUG
+  CheckIndex(i);
+#endif
+  return order_[static_cast<size_t>(i)];
+}
+
+bool Permutation::operator==(const Permutation& other) const {
+  return order_ == other.order_;
+}
+
+bool Permutation::operator!=(const Permutation& other) const {
+  return !(*this == other);
+}
+
+/**
+ * @brief Composition like product of permutation matrices: applying
+ * "this * other" equals applying "other" and then "this"
+ *
+ * @param other const Permutation& type
+ * @return Permutation
+ */
+Permutation Permutation::operator*(const Permutation& other) const {
+  if (size() != other.size()) {
+    throw std::invalid_argument(
+        "Composition of permutations of different size");
+  }
+  Permutation returnable(size());
+  for (size_t i = 0; i < order_.size(); ++i) {
+    returnable.order_[i] = other.order_[static_cast<size_t>(order_[i])];
+  }
+
+  return returnable;
+}
+
+void Permutation::CheckIndex(int i) const {
+  if (i < 0 || i >= size()) {
+    throw std::out_of_range("Permutation index that is out of range");
+  }
+}
+
+}  // namespace hhullen
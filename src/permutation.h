@@ -0,0 +1,40 @@
+#ifndef SRC_PERMUTATION_H_
+#define SRC_PERMUTATION_H_
+
+#include <stdexcept>
+#include <vector>
+
+namespace hhullen {
+
+/**
+ * @brief Row order of a matrix: row "i" of permuted matrix is row "p[i]" of
+ * source matrix. Swapping rows is O(1) bookkeeping, the order is applied to
+ * matrix data once by Matrix::Permute
+ *
+ */
+class Permutation {
+ public:
+  Permutation();
+  explicit Permutation(int size);
+
+  static Permutation FromPivots(const std::vector<int>& pivots);
+
+  int size() const;
+  bool IsIdentity() const;
+  void Swap(int i, int j);
+  Permutation Inverse() const;
+
+  int operator[](int i) const;
+  bool operator==(const Permutation& other) const;
+  bool operator!=(const Permutation& other) const;
+  Permutation operator*(const Permutation& other) const;
+
+ private:
+  std::vector<int> order_;
+
+  void CheckIndex(int i) const;
+};
+
+}  // namespace hhullen
+
+#endif  // SRC_PERMUTATION_H_
@@ -0,0 +1,329 @@
+#include "pipeline.h"
+
+namespace hhullen {
+
+namespace pipeline {
+
+inline bool IsCompressedFile(ifstream& file) {
+  char magic[2] = {0, 0};
+  file.read(magic, 2);
+  bool is_compressed = file.gcount() == 2 &&
+                       static_cast<unsigned char>(magic[0]) == 0x1f &&
+                       static_cast<unsigned char>(magic[1]) == 0x8b;
+  file.clear();
+  file.seekg(0);
+
+  return is_compressed;
+}
+
+#ifdef MATRIX_WITH_ZLIB
+/**
+ * @brief Input stream buffer decompressing gzip file by fixed-size parts
+ *
+ */
+class GzipReadBuffer : public std::streambuf {
+ public:
+  explicit GzipReadBuffer(const std::string& path)
+      : file_(gzopen(path.c_str(), "rb"), &gzclose), buffer_(kBufferBytes) {
+    if (!file_) {
+      throw invalid_argument("File could not be opened.");
+    }
+  }
+
+ protected:
+  int_type underflow() override {
+    if (gptr() < egptr()) {
+      return traits_type::to_int_type(*gptr());
+    }
+    const int read = gzread(file_.get(), buffer_.data(),
+                            static_cast<unsigned>(buffer_.size()));
+    if (read < 0) {
+      throw invalid_argument("Compressed file is corrupted");
+    }
+    if (read == 0) {
+      return traits_type::eof();
+    }
+    setg(buffer_.data(), buffer_.data(), buffer_.data() + read);
+
+    return traits_type::to_int_type(*gptr());
+  }
+
+ private:
+  static constexpr size_t kBufferBytes = 1 << 16;
+  std::unique_ptr<gzFile_s, decltype(&gzclose)> file_;
+  std::vector<char> buffer_;
+};
+#endif
+
+inline std::unique_ptr<std::streambuf> OpenCompressedInput(
+    const std::string& path) {
+#ifdef MATRIX_WITH_ZLIB
+  return std::make_unique<GzipReadBuffer>(path);
+#else
+  throw invalid_argument("Compressed loading requires MATRIX_WITH_ZLIB: " +
+                         path);
+#endif
+}
+
+}  // namespace pipeline
+
+template <arithmetic Type>
+Pipeline<Type>::Pipeline(const PipelineOptions& options) : options_(options) {
+  if (options.block_rows < 1 || options.queue_blocks < 1 ||
+      options.threads < 0) {
+    throw invalid_argument("Incorrect pipeline options");
+  }
+}
+
+/**
+ * @brief Sets input file, plain or gzip compressed text of Save format
+ *
+ */
+template <arithmetic Type>
+Pipeline<Type>& Pipeline<Type>::Load(const std::string& path) {
+  input_path_ = path;
+
+  return *this;
+}
+
+/**
+ * @brief Appends transformation of blocks. "function" is called as
+ * function(block) or function(block, first_row), where block is
+ * Matrix<Type> with rows [first_row, first_row + block.rows()) of the
+ * matrix. It may replace the block, but has to keep its rows, and all
+ * blocks have to get the same amount of columns
+ *
+ */
+template <arithmetic Type>
+template <class Function>
+Pipeline<Type>& Pipeline<Type>::Transform(Function function) {
+  if constexpr (std::is_invocable_v<Function&, Matrix<Type>&, int>) {
+    steps_.emplace_back(std::move(function));
+  } else {
+    steps_.emplace_back(
+        [function](Matrix<Type>& block, int) mutable { function(block); });
+  }
+
+  return *this;
+}
+
+/**
+ * @brief Sets output file and its options, "threads" of SaveOptions is not
+ * used: formatting is a stage of pipeline
+ *
+ */
+template <arithmetic Type>
+Pipeline<Type>& Pipeline<Type>::Save(const std::string& path,
+                                     const SaveOptions& options) {
+  if (options.precision > Matrix<Type>::kMaxPrecision) {
+    throw invalid_argument("Saving with too large precision");
+  }
+  output_path_ = path;
+  save_options_ = options;
+
+  return *this;
+}
+
+/**
+ * @brief Streams input file through transformations into output file. The
+ * first exception of a stage cancels others and is rethrown
+ *
+ * @return PipelineStats amount of blocks, peak amount of blocks in memory,
+ * written bytes before compression and elapsed time
+ */
+template <arithmetic Type>
+PipelineStats Pipeline<Type>::Run() const {
+  if (input_path_.empty() || output_path_.empty()) {
+    throw invalid_argument("Pipeline requires Load and Save");
+  }
+  const auto start = std::chrono::steady_clock::now();
+
+  ifstream file(input_path_, std::ios::binary);
+  if (!file.is_open()) {
+    throw invalid_argument("File could not be opened.");
+  }
+  std::unique_ptr<std::streambuf> compressed;
+  std::istream input(file.rdbuf());
+  input.exceptions(std::ios::badbit);
+  if (pipeline::IsCompressedFile(file)) {
+    compressed = pipeline::OpenCompressedInput(input_path_);
+    input.rdbuf(compressed.get());
+  }
+  std::string line;
+  getline(input, line, '\n');
+  int rows = 0, cols = 0;
+  std::istringstream(line) >> rows >> cols;
+  if (rows < 1 || cols < 1) {
+    throw invalid_argument("Incorrect matrix size");
+  }
+
+  Writer write;
+  ofstream output;
+#ifdef MATRIX_WITH_ZLIB
+  std::unique_ptr<gzFile_s, decltype(&gzclose)> compressed_output(nullptr,
+                                                                  &gzclose);
+#endif
+  if (save_options_.compress) {
+#ifdef MATRIX_WITH_ZLIB
+    compressed_output.reset(gzopen(output_path_.c_str(), "wb"));
+    if (!compressed_output) {
+      throw invalid_argument("File could not be opened.");
+    }
+    write = [&compressed_output](const std::string& text) {
+      if (gzwrite(compressed_output.get(), text.data(),
+                  static_cast<unsigned>(text.size())) <= 0) {
+        throw std::runtime_error("File could not be written.");
+      }
+    };
+#else
+    throw invalid_argument("Compressed saving requires MATRIX_WITH_ZLIB");
+#endif
+  } else {
+    output.open(output_path_, std::ios::binary);
+    if (!output.is_open()) {
+      throw invalid_argument("File could not be opened.");
+    }
+    write = [&output](const std::string& text) {
+      if (!output.write(text.data(),
+                        static_cast<std::streamsize>(text.size()))) {
+        throw std::runtime_error("File could not be written.");
+      }
+    };
+  }
+
+  const int threads =
+      options_.threads > 0 ? options_.threads : HardwareThreads();
+  const size_t capacity = static_cast<size_t>(options_.queue_blocks);
+  Progress progress;
+  std::latch done(static_cast<std::ptrdiff_t>(steps_.size() + 3));
+  auto pool = std::make_unique<CoroutinePool>(threads);
+  std::deque<BlockQueue> block_queues;
+  for (size_t i = 0; i <= steps_.size(); ++i) {
+    block_queues.emplace_back(pool.get(), capacity);
+  }
+  TextQueue text_queue(pool.get(), capacity);
+
+  std::vector<PipelineStage> stages;
+  stages.push_back(ReadStage(&input, rows, cols, options_.block_rows,
+                             &block_queues.front(), &progress));
+  for (size_t i = 0; i < steps_.size(); ++i) {
+    stages.push_back(TransformStage(&steps_[i], &block_queues[i],
+                                    &block_queues[i + 1]));
+  }
+  stages.push_back(FormatStage(rows, options_.block_rows,
+                               save_options_.precision, &block_queues.back(),
+                               &text_queue, &progress));
+  stages.push_back(WriteStage(&write, &text_queue, &progress));
+
+  const auto cancel = [&block_queues, &text_queue] {
+    for (BlockQueue& queue : block_queues) {
+      queue.Cancel();
+    }
+    text_queue.Cancel();
+  };
+  for (PipelineStage& stage : stages) {
+    stage.handle.promise().done = &done;
+    stage.handle.promise().cancel = cancel;
+  }
+  for (PipelineStage& stage : stages) {
+    pool->Schedule(stage.handle);
+  }
+  done.wait();
+  pool.reset();
+
+  std::exception_ptr error;
+  for (PipelineStage& stage : stages) {
+    if (!error) {
+      error = stage.handle.promise().error;
+    }
+    stage.handle.destroy();
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+
+  PipelineStats returnable;
+  returnable.blocks = progress.blocks;
+  returnable.peak_blocks = progress.peak;
+  returnable.bytes = progress.bytes;
+  returnable.seconds = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+
+  return returnable;
+}
+
+template <arithmetic Type>
+PipelineStage Pipeline<Type>::ReadStage(std::istream* input, int rows,
+                                        int cols, int block_rows,
+                                        BlockQueue* output,
+                                        Progress* progress) {
+  for (int first = 0; first < rows; first += block_rows) {
+    Block block{first, Matrix<Type>(std::min(block_rows, rows - first), cols)};
+    block.values.ReadMatrix(*input);
+    progress->Acquire();
+    if (!co_await output->Push(std::move(block))) {
+      co_return;
+    }
+  }
+  output->Close();
+}
+
+template <arithmetic Type>
+PipelineStage Pipeline<Type>::TransformStage(const Step* step,
+                                             BlockQueue* input,
+                                             BlockQueue* output) {
+  while (std::optional<Block> block = co_await input->Pop()) {
+    (*step)(block->values, block->first_row);
+    if (!co_await output->Push(std::move(*block))) {
+      co_return;
+    }
+  }
+  output->Close();
+}
+
+/**
+ * @brief Formats blocks to text preceded by header with amount of columns
+ * of the first transformed block
+ *
+ */
+template <arithmetic Type>
+PipelineStage Pipeline<Type>::FormatStage(int rows, int block_rows,
+                                          int precision, BlockQueue* input,
+                                          TextQueue* output,
+                                          Progress* progress) {
+  int cols = 0;
+  while (std::optional<Block> block = co_await input->Pop()) {
+    if (cols == 0) {
+      cols = block->values.cols();
+      if (!co_await output->Push(std::to_string(rows) + " " +
+                                 std::to_string(cols) + "\n")) {
+        co_return;
+      }
+    }
+    const int block_size = std::min(block_rows, rows - block->first_row);
+    if (block->values.rows() != block_size || block->values.cols() != cols) {
+      throw invalid_argument("Transformation changed size of block");
+    }
+    std::string text;
+    block->values.FormatRows(0, block_size, precision, &text);
+    block.reset();
+    progress->Release();
+    if (!co_await output->Push(std::move(text))) {
+      co_return;
+    }
+  }
+  output->Close();
+}
+
+template <arithmetic Type>
+PipelineStage Pipeline<Type>::WriteStage(const Writer* write,
+                                         TextQueue* input,
+                                         Progress* progress) {
+  while (std::optional<std::string> text = co_await input->Pop()) {
+    (*write)(*text);
+    progress->bytes += text->size();
+  }
+}
+
+}  // namespace hhullen
@@ -0,0 +1,352 @@
+#ifndef SRC_PIPELINE_H_
+#define SRC_PIPELINE_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <istream>
+#include <latch>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "matrix.h"
+
+namespace hhullen {
+
+/**
+ * @brief Threads resuming suspended coroutines in order of scheduling
+ *
+ */
+class CoroutinePool {
+ public:
+  explicit CoroutinePool(int threads) {
+    for (int i = 0; i < threads; ++i) {
+      threads_.emplace_back([this] { Run(); });
+    }
+  }
+  CoroutinePool(const CoroutinePool&) = delete;
+  CoroutinePool& operator=(const CoroutinePool&) = delete;
+
+  ~CoroutinePool() {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stopped_ = true;
+    }
+    has_work_.notify_all();
+    for (std::thread& thread : threads_) {
+      thread.join();
+    }
+  }
+
+  void Schedule(std::coroutine_handle<> handle) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      ready_.push_back(handle);
+    }
+    has_work_.notify_one();
+  }
+
+ private:
+  bool stopped_ = false;
+  std::deque<std::coroutine_handle<>> ready_;
+  std::mutex mutex_;
+  std::condition_variable has_work_;
+  std::vector<std::thread> threads_;
+
+  void Run() {
+    while (true) {
+      std::coroutine_handle<> handle;
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        has_work_.wait(lock, [this] { return stopped_ || !ready_.empty(); });
+        if (ready_.empty()) {
+          return;
+        }
+        handle = ready_.front();
+        ready_.pop_front();
+      }
+      handle.resume();
+    }
+  }
+};
+
+/**
+ * @brief Bounded queue between coroutines. "co_await Push(value)" suspends
+ * while the queue is full and returns false if it is cancelled,
+ * "co_await Pop()" suspends while it is empty and returns std::nullopt when
+ * it is closed and drained or cancelled. Waiting coroutines are resumed in
+ * the pool, never inside the call that woke them
+ *
+ */
+template <class Value>
+class CoroutineQueue {
+ public:
+  class PushAwaiter;
+  class PopAwaiter;
+
+  CoroutineQueue(CoroutinePool* pool, size_t capacity)
+      : pool_(pool), capacity_(capacity) {}
+  CoroutineQueue(const CoroutineQueue&) = delete;
+  CoroutineQueue& operator=(const CoroutineQueue&) = delete;
+
+  PushAwaiter Push(Value value) { return PushAwaiter(this, std::move(value)); }
+  PopAwaiter Pop() { return PopAwaiter(this); }
+
+  /**
+   * @brief Producer has finished, consumers get std::nullopt after the last
+   * value
+   *
+   */
+  void Close() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    closed_ = true;
+    WakePoppers();
+  }
+
+  /**
+   * @brief Aborts the queue: waiting and later calls fail immediately
+   *
+   */
+  void Cancel() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    cancelled_ = true;
+    values_.clear();
+    while (!pushers_.empty()) {
+      PushAwaiter* pusher = pushers_.front();
+      pushers_.pop_front();
+      pusher->is_pushed_ = false;
+      pool_->Schedule(pusher->handle_);
+    }
+    WakePoppers();
+  }
+
+  class PushAwaiter {
+   public:
+    PushAwaiter(CoroutineQueue* queue, Value value)
+        : queue_(queue), value_(std::move(value)) {}
+
+    bool await_ready() const { return false; }
+    bool await_suspend(std::coroutine_handle<> handle) {
+      std::lock_guard<std::mutex> lock(queue_->mutex_);
+      if (queue_->cancelled_) {
+        return false;
+      }
+      if (!queue_->poppers_.empty()) {
+        PopAwaiter* popper = queue_->poppers_.front();
+        queue_->poppers_.pop_front();
+        popper->value_ = std::move(value_);
+        is_pushed_ = true;
+        queue_->pool_->Schedule(popper->handle_);
+        return false;
+      }
+      if (queue_->values_.size() < queue_->capacity_) {
+        queue_->values_.push_back(std::move(value_));
+        is_pushed_ = true;
+        return false;
+      }
+      handle_ = handle;
+      queue_->pushers_.push_back(this);
+      return true;
+    }
+    bool await_resume() const { return is_pushed_; }
+
+   private:
+    friend class CoroutineQueue;
+    CoroutineQueue* queue_;
+    Value value_;
+    bool is_pushed_ = false;
+    std::coroutine_handle<> handle_;
+  };
+
+  class PopAwaiter {
+   public:
+    explicit PopAwaiter(CoroutineQueue* queue) : queue_(queue) {}
+
+    bool await_ready() const { return false; }
+    bool await_suspend(std::coroutine_handle<> handle) {
+      std::lock_guard<std::mutex> lock(queue_->mutex_);
+      if (!queue_->values_.empty()) {
+        value_ = std::move(queue_->values_.front());
+        queue_->values_.pop_front();
+        if (!queue_->pushers_.empty()) {
+          PushAwaiter* pusher = queue_->pushers_.front();
+          queue_->pushers_.pop_front();
+          queue_->values_.push_back(std::move(pusher->value_));
+          pusher->is_pushed_ = true;
+          queue_->pool_->Schedule(pusher->handle_);
+        }
+        return false;
+      }
+      if (queue_->closed_ || queue_->cancelled_) {
+        return false;
+      }
+      handle_ = handle;
+      queue_->poppers_.push_back(this);
+      return true;
+    }
+    std::optional<Value> await_resume() { return std::move(value_); }
+
+   private:
+    friend class CoroutineQueue;
+    CoroutineQueue* queue_;
+    std::optional<Value> value_;
+    std::coroutine_handle<> handle_;
+  };
+
+ private:
+  CoroutinePool* pool_;
+  size_t capacity_;
+  bool closed_ = false, cancelled_ = false;
+  std::deque<Value> values_;
+  std::deque<PushAwaiter*> pushers_;
+  std::deque<PopAwaiter*> poppers_;
+  std::mutex mutex_;
+
+  void WakePoppers() {
+    while (!poppers_.empty()) {
+      PopAwaiter* popper = poppers_.front();
+      poppers_.pop_front();
+      pool_->Schedule(popper->handle_);
+    }
+  }
+};
+
+/**
+ * @brief Coroutine of one pipeline stage. It starts suspended, is resumed
+ * in the pool and counts down "done" when finished. Exception of the stage
+ * is kept in "error" and calls "cancel", which aborts the other stages
+ *
+ */
+struct PipelineStage {
+  struct promise_type {
+    std::latch* done = nullptr;
+    std::function<void()> cancel;
+    std::exception_ptr error;
+
+    PipelineStage get_return_object() {
+      return {std::coroutine_handle<promise_type>::from_promise(*this)};
+    }
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    auto final_suspend() noexcept {
+      struct FinalAwaiter {
+        bool await_ready() noexcept { return false; }
+        void await_suspend(
+            std::coroutine_handle<promise_type> handle) noexcept {
+          handle.promise().done->count_down();
+        }
+        void await_resume() noexcept {}
+      };
+      return FinalAwaiter{};
+    }
+    void return_void() {}
+    void unhandled_exception() {
+      error = std::current_exception();
+      cancel();
+    }
+  };
+
+  std::coroutine_handle<promise_type> handle;
+};
+
+/**
+ * @brief Options of pipeline: rows of streamed blocks, capacity of queues
+ * between stages in blocks and amount of threads (0 for all hardware
+ * threads)
+ *
+ */
+struct PipelineOptions {
+  int block_rows = 256;
+  int queue_blocks = 2;
+  int threads = 0;
+};
+
+/**
+ * @brief Result of pipeline run, "peak_blocks" is the largest amount of
+ * row blocks alive at once
+ *
+ */
+struct PipelineStats {
+  int blocks = 0;
+  int peak_blocks = 0;
+  size_t bytes = 0;
+  double seconds = 0;
+};
+
+/**
+ * @brief Streams a matrix file through transformations into another file
+ * by blocks of rows. Parsing, every transformation, formatting and writing
+ * are coroutines connected by bounded queues and run in a thread pool, so
+ * they overlap and only a few blocks are in memory at once
+ *
+ */
+template <arithmetic Type>
+class Pipeline {
+ public:
+  using Step = std::function<void(Matrix<Type>&, int)>;
+  using SaveOptions = typename Matrix<Type>::SaveOptions;
+
+  explicit Pipeline(const PipelineOptions& options = PipelineOptions());
+
+  Pipeline& Load(const std::string& path);
+  template <class Function>
+  Pipeline& Transform(Function function);
+  Pipeline& Save(const std::string& path,
+                 const SaveOptions& options = SaveOptions());
+  PipelineStats Run() const;
+
+ private:
+  /**
+   * @brief Rows of matrix starting at "first_row"
+   *
+   */
+  struct Block {
+    int first_row = 0;
+    Matrix<Type> values;
+  };
+  struct Progress {
+    std::atomic<int> blocks = 0, live = 0, peak = 0;
+    std::atomic<size_t> bytes = 0;
+
+    void Acquire() {
+      const int current = ++live;
+      int highest = peak.load();
+      while (current > highest &&
+             !peak.compare_exchange_weak(highest, current)) {
+      }
+    }
+    void Release() {
+      --live;
+      ++blocks;
+    }
+  };
+  using BlockQueue = CoroutineQueue<Block>;
+  using TextQueue = CoroutineQueue<std::string>;
+  using Writer = std::function<void(const std::string&)>;
+
+  PipelineOptions options_;
+  std::string input_path_, output_path_;
+  SaveOptions save_options_;
+  std::vector<Step> steps_;
+
+  static PipelineStage ReadStage(std::istream* input, int rows, int cols,
+                                 int block_rows, BlockQueue* output,
+                                 Progress* progress);
+  static PipelineStage TransformStage(const Step* step, BlockQueue* input,
+                                      BlockQueue* output);
+  static PipelineStage FormatStage(int rows, int block_rows, int precision,
+                                   BlockQueue* input, TextQueue* output,
+                                   Progress* progress);
+  static PipelineStage WriteStage(const Writer* write, TextQueue* input,
+                                  Progress* progress);
+};
+
+}  // namespace hhullen
+
+#endif  // SRC_PIPELINE_H_
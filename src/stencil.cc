@@ -0,0 +1,307 @@
+#include "stencil.h"
+
+namespace hhullen {
+
+/**
+ * @brief 2D convolution of "input" with "kernel" centered at element
+ * (kernel.rows / 2, kernel.cols / 2), result has "input" size. Elements
+ * outside of "input" are taken by "boundary" policy
+ *
+ * @param input const Matrix& type
+ * @param kernel const Matrix& type
+ * @param boundary Boundary type
+ * @param method ConvolutionMethod type
+ * @return Matrix of "input" size
+ */
+template <arithmetic Type>
+Matrix<Type> Convolve(const Matrix<Type>& input, const Matrix<Type>& kernel,
+                      Boundary boundary, ConvolutionMethod method) {
+  return Convolve(input, std::vector<Matrix<Type>>{kernel}, boundary,
+                  method)
+      .front();
+}
+
+/**
+ * @brief Convolution of "input" with every kernel of a bank. Input is padded
+ * once, so kernels run without bounds checks over column tiles of row
+ * blocks split between threads
+ *
+ * @param input const Matrix& type
+ * @param kernels const std::vector<Matrix>& type kernels of the same size
+ * @param boundary Boundary type
+ * @param method ConvolutionMethod type: kDirect accumulates shifted rows
+ * per kernel, kIm2col unrolls patches once and multiplies them by all
+ * kernels with one Gemm. kAuto uses im2col for banks of at least
+ * stencil::kIm2colKernels kernels with BLAS backend only, as direct
+ * accumulation is faster otherwise
+ * @return std::vector<Matrix> of "input" size results in order of kernels
+ */
+template <arithmetic Type>
+std::vector<Matrix<Type>> Convolve(const Matrix<Type>& input,
+                                   const std::vector<Matrix<Type>>& kernels,
+                                   Boundary boundary,
+                                   ConvolutionMethod method) {
+  if (kernels.empty()) {
+    throw invalid_argument("Convolution without kernels");
+  }
+  const int kernel_rows = kernels.front().rows();
+  const int kernel_cols = kernels.front().cols();
+  std::vector<Matrix<Type>> flipped;
+  for (const Matrix<Type>& kernel : kernels) {
+    if (kernel.rows() != kernel_rows || kernel.cols() != kernel_cols) {
+      throw invalid_argument("Convolution with kernels of different size");
+    }
+    flipped.emplace_back(kernel_rows, kernel_cols);
+    std::reverse_copy(kernel.begin(), kernel.end(), flipped.back().begin());
+  }
+  const Matrix<Type> padded =
+      stencil::Pad(input, kernel_rows - 1 - kernel_rows / 2,
+                   kernel_cols - 1 - kernel_cols / 2, kernel_rows / 2,
+                   kernel_cols / 2, boundary);
+  std::vector<Matrix<Type>> returnable;
+  for (size_t k = 0; k < kernels.size(); ++k) {
+    returnable.emplace_back(input.rows(), input.cols());
+  }
+
+  if (method == ConvolutionMethod::kAuto) {
+    method = IsBlasBackendActive<Type>() &&
+                     kernels.size() >= stencil::kIm2colKernels
+                 ? ConvolutionMethod::kIm2col
+                 : ConvolutionMethod::kDirect;
+  }
+  if (method == ConvolutionMethod::kDirect) {
+    for (size_t k = 0; k < kernels.size(); ++k) {
+      stencil::ConvolveDirect(padded, flipped[k], &returnable[k]);
+    }
+  } else {
+    stencil::ConvolveIm2col(padded, flipped, &returnable);
+  }
+
+  return returnable;
+}
+
+/**
+ * @brief Applies "operation" to neighborhood of every element. Input is
+ * padded by "radius" once, so neighbors are read without bounds checks,
+ * column tiles of row blocks are split between threads
+ *
+ * @param input const Matrix& type
+ * @param radius int type largest shift used by "operation"
+ * @param boundary Boundary type
+ * @param operation callable type, operation(const StencilView<Type>&)
+ * returns new value of the element
+ * @return Matrix of "input" size
+ */
+template <arithmetic Type, class Operation>
+Matrix<Type> Stencil(const Matrix<Type>& input, int radius,
+                     Boundary boundary, Operation operation) {
+  if (radius < 0) {
+    throw invalid_argument("Stencil with negative radius");
+  }
+  const Matrix<Type> padded =
+      stencil::Pad(input, radius, radius, radius, radius, boundary);
+  Matrix<Type> returnable(input.rows(), input.cols());
+  const size_t cols = static_cast<size_t>(input.cols());
+  const size_t stride = static_cast<size_t>(padded.cols());
+  const size_t shift = static_cast<size_t>(radius);
+  const Type* source = padded.data();
+  Type* target = returnable.data();
+
+  ForEachRowBlock(input.rows(), cols, [&](int first, int last) {
+    for (size_t tile = 0; tile < cols; tile += stencil::kTileCols) {
+      const size_t tile_end =
+          std::min(cols, tile + static_cast<size_t>(stencil::kTileCols));
+      for (size_t i = static_cast<size_t>(first);
+           i < static_cast<size_t>(last); ++i) {
+        const Type* center = source + (i + shift) * stride + shift;
+        Type* row = target + i * cols;
+        for (size_t j = tile; j < tile_end; ++j) {
+          row[j] = static_cast<Type>(
+              operation(StencilView<Type>{center + j, stride}));
+        }
+      }
+    }
+  });
+
+  return returnable;
+}
+
+namespace stencil {
+
+/**
+ * @brief Maps index outside of [0, size) by boundary policy
+ *
+ * @return int index inside of [0, size) or -1 for zero element
+ */
+inline int BoundaryIndex(int index, int size, Boundary boundary) {
+  if (index >= 0 && index < size) {
+    return index;
+  }
+  switch (boundary) {
+    case Boundary::kZero:
+      return -1;
+    case Boundary::kClamp:
+      return index < 0 ? 0 : size - 1;
+    case Boundary::kWrap:
+      return (index % size + size) % size;
+    case Boundary::kReflect:
+      break;
+  }
+  if (size == 1) {
+    return 0;
+  }
+  const int period = 2 * (size - 1);
+  const int position = (index % period + period) % period;
+  return position < size ? position : period - position;
+}
+
+/**
+ * @brief Returns copy of "input" surrounded by given amount of rows and
+ * columns filled by boundary policy
+ *
+ */
+template <arithmetic Type>
+Matrix<Type> Pad(const Matrix<Type>& input, int top, int left, int bottom,
+                 int right, Boundary boundary) {
+  const int rows = input.rows(), cols = input.cols();
+  Matrix<Type> returnable(rows + top + bottom, cols + left + right);
+  std::vector<int> source_cols(static_cast<size_t>(left + right));
+  for (int j = 0; j < left; ++j) {
+    source_cols[static_cast<size_t>(j)] =
+        BoundaryIndex(j - left, cols, boundary);
+  }
+  for (int j = 0; j < right; ++j) {
+    source_cols[static_cast<size_t>(left + j)] =
+        BoundaryIndex(cols + j, cols, boundary);
+  }
+
+  const size_t stride = static_cast<size_t>(returnable.cols());
+  Type* values = returnable.data();
+
+  ForEachRowBlock(returnable.rows(), stride, [&](int first, int last) {
+    for (int i = first; i < last; ++i) {
+      Type* target = values + static_cast<size_t>(i) * stride;
+      const int source_row = BoundaryIndex(i - top, rows, boundary);
+      if (source_row < 0) {
+        std::fill(target, target + stride, Type(0));
+        continue;
+      }
+      std::span<const Type> source = input.row(source_row);
+      std::copy(source.begin(), source.end(), target + left);
+      for (size_t j = 0; j < source_cols.size(); ++j) {
+        const int column = source_cols[j];
+        const size_t position =
+            j < static_cast<size_t>(left) ? j : j + static_cast<size_t>(cols);
+        target[position] =
+            column < 0 ? Type(0) : source[static_cast<size_t>(column)];
+      }
+    }
+  });
+
+  return returnable;
+}
+
+/**
+ * @brief Correlation of padded input with kernel by accumulating shifted
+ * rows, inner loop is contiguous and vectorizable
+ *
+ */
+template <arithmetic Type>
+void ConvolveDirect(const Matrix<Type>& padded, const Matrix<Type>& kernel,
+                    Matrix<Type>* output) {
+  const size_t cols = static_cast<size_t>(output->cols());
+  const size_t stride = static_cast<size_t>(padded.cols());
+  const size_t kernel_rows = static_cast<size_t>(kernel.rows());
+  const size_t kernel_cols = static_cast<size_t>(kernel.cols());
+  const Type* source = padded.data();
+  const Type* weights = kernel.data();
+  Type* target = output->MutableData();
+
+  ForEachRowBlock(output->rows(), cols, [&](int first, int last) {
+    for (size_t tile = 0; tile < cols; tile += kTileCols) {
+      const size_t width =
+          std::min(cols, tile + static_cast<size_t>(kTileCols)) - tile;
+      for (size_t i = static_cast<size_t>(first);
+           i < static_cast<size_t>(last); ++i) {
+        Type* row = target + i * cols + tile;
+        std::fill(row, row + width, Type(0));
+        for (size_t p = 0; p < kernel_rows; ++p) {
+          for (size_t q = 0; q < kernel_cols; ++q) {
+            const Type weight = weights[p * kernel_cols + q];
+            const Type* shifted = source + (i + p) * stride + tile + q;
+            for (size_t j = 0; j < width; ++j) {
+              row[j] = static_cast<Type>(row[j] + weight * shifted[j]);
+            }
+          }
+        }
+      }
+    }
+  });
+}
+
+/**
+ * @brief Correlation of padded input with kernels by im2col: patches of a
+ * row block are unrolled to rows of a matrix which is multiplied by matrix
+ * of kernel columns with Gemm. Row blocks are limited by kPatchBytes of
+ * patches
+ *
+ */
+template <arithmetic Type>
+void ConvolveIm2col(const Matrix<Type>& padded,
+                    const std::vector<Matrix<Type>>& kernels,
+                    std::vector<Matrix<Type>>* outputs) {
+  const int rows = outputs->front().rows();
+  const size_t cols = static_cast<size_t>(outputs->front().cols());
+  const size_t kernel_rows = static_cast<size_t>(kernels.front().rows());
+  const size_t kernel_cols = static_cast<size_t>(kernels.front().cols());
+  const size_t patch = kernel_rows * kernel_cols;
+  const size_t amount_kernels = kernels.size();
+  const int block_rows = static_cast<int>(std::clamp<size_t>(
+      kPatchBytes / (sizeof(Type) * patch * cols), 1,
+      static_cast<size_t>(rows)));
+
+  Matrix<Type> weights(static_cast<int>(patch),
+                       static_cast<int>(amount_kernels));
+  Type* columns = weights.MutableData();
+  for (size_t k = 0; k < amount_kernels; ++k) {
+    const Type* values = kernels[k].data();
+    for (size_t p = 0; p < patch; ++p) {
+      columns[p * amount_kernels + k] = values[p];
+    }
+  }
+  for (int first_row = 0; first_row < rows; first_row += block_rows) {
+    const int amount = std::min(block_rows, rows - first_row);
+    Matrix<Type> patches(amount * static_cast<int>(cols),
+                         static_cast<int>(patch));
+    Matrix<Type> result(patches.rows(), static_cast<int>(amount_kernels));
+    Type* unrolled = patches.data();
+
+    ForEachRowBlock(amount, cols * patch, [&](int first, int last) {
+      for (size_t i = static_cast<size_t>(first);
+           i < static_cast<size_t>(last); ++i) {
+        for (size_t p = 0; p < kernel_rows; ++p) {
+          std::span<const Type> source =
+              padded.row(first_row + static_cast<int>(i + p));
+          for (size_t j = 0; j < cols; ++j) {
+            std::copy(source.begin() + static_cast<long>(j),
+                      source.begin() + static_cast<long>(j + kernel_cols),
+                      unrolled + (i * cols + j) * patch + p * kernel_cols);
+          }
+        }
+      }
+    });
+    Matrix<Type>::Gemm(1, patches, false, weights, false, 0, &result);
+    const Type* products = std::as_const(result).data();
+    for (size_t k = 0; k < amount_kernels; ++k) {
+      Type* target =
+          (*outputs)[k].MutableData() + static_cast<size_t>(first_row) * cols;
+      for (size_t index = 0; index < patches.size() / patch; ++index) {
+        target[index] = products[index * amount_kernels + k];
+      }
+    }
+  }
+}
+
+}  // namespace stencil
+
+}  // namespace hhullen
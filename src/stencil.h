@@ -0,0 +1,77 @@
+#ifndef SRC_STENCIL_H_
+#define SRC_STENCIL_H_
+
+#include <cstddef>
+#include <vector>
+
+#include "matrix.h"
+
+namespace hhullen {
+
+/**
+ * @brief Values of elements outside of matrix: zero, nearest edge element,
+ * mirrored without repeating the edge (-1 is 1) or periodic
+ *
+ */
+enum class Boundary { kZero, kClamp, kReflect, kWrap };
+
+/**
+ * @brief Convolution algorithm: direct accumulation of shifted rows per
+ * kernel or im2col with one Gemm for the whole bank of kernels
+ *
+ */
+enum class ConvolutionMethod { kAuto, kDirect, kIm2col };
+
+/**
+ * @brief Neighborhood of one element passed to stencil operation,
+ * "view(di, dj)" is element shifted by "di" rows and "dj" columns
+ *
+ */
+template <arithmetic Type>
+struct StencilView {
+  const Type* center;
+  size_t stride;
+
+  Type operator()(int di, int dj) const {
+    return center[static_cast<std::ptrdiff_t>(di) *
+                      static_cast<std::ptrdiff_t>(stride) +
+                  dj];
+  }
+};
+
+template <arithmetic Type>
+Matrix<Type> Convolve(const Matrix<Type>& input, const Matrix<Type>& kernel,
+                      Boundary boundary = Boundary::kZero,
+                      ConvolutionMethod method = ConvolutionMethod::kAuto);
+template <arithmetic Type>
+std::vector<Matrix<Type>> Convolve(
+    const Matrix<Type>& input, const std::vector<Matrix<Type>>& kernels,
+    Boundary boundary = Boundary::kZero,
+    ConvolutionMethod method = ConvolutionMethod::kAuto);
+template <arithmetic Type, class Operation>
+Matrix<Type> Stencil(const Matrix<Type>& input, int radius,
+                     Boundary boundary, Operation operation);
+
+namespace stencil {
+
+constexpr size_t kIm2colKernels = 16;
+constexpr int kTileCols = 1024;
+constexpr size_t kPatchBytes = 1 << 22;
+
+inline int BoundaryIndex(int index, int size, Boundary boundary);
+template <arithmetic Type>
+Matrix<Type> Pad(const Matrix<Type>& input, int top, int left, int bottom,
+                 int right, Boundary boundary);
+template <arithmetic Type>
+void ConvolveDirect(const Matrix<Type>& padded, const Matrix<Type>& kernel,
+                    Matrix<Type>* output);
+template <arithmetic Type>
+void ConvolveIm2col(const Matrix<Type>& padded,
+                    const std::vector<Matrix<Type>>& kernels,
+                    std::vector<Matrix<Type>>* outputs);
+
+}  // namespace stencil
+
+}  // namespace hhullen
+
+#endif  // SRC_STENCIL_H_
@@ -0,0 +1,751 @@
+#include "structured_matrix.h"
+
+namespace hhullen {
+
+namespace structured {
+
+inline size_t Triangular(size_t i) { return i * (i + 1) / 2; }
+
+template <class Type>
+void CheckSquare(const Matrix<Type>& other, const std::string& operation) {
+  if (other.rows() != other.cols()) {
+    throw invalid_argument(operation + " from not square matrix");
+  }
+}
+
+inline void CheckProduct(int size, int rows) {
+  if (size != rows) {
+    throw invalid_argument(
+        "Multiplication matrix with different cols and rows");
+  }
+}
+
+inline void CheckVectors(int size, size_t x_size, size_t y_size) {
+  if (x_size != static_cast<size_t>(size) ||
+      y_size != static_cast<size_t>(size)) {
+    throw invalid_argument("Multiplication by vector of different size");
+  }
+}
+
+}  // namespace structured
+
+/**
+ * @brief Construct a new empty SymmetricMatrix object
+ *
+ */
+template <arithmetic Type>
+SymmetricMatrix<Type>::SymmetricMatrix() {}
+
+/**
+ * @brief Construct a new SymmetricMatrix object filled with zeros
+ *
+ * @param size int type amount of rows and cols
+ */
+template <arithmetic Type>
+SymmetricMatrix<Type>::SymmetricMatrix(int size) : size_(size) {
+  if (size < 1) {
+    throw invalid_argument("Creation matrix with less than 1x1 size");
+  }
+  values_.resize(structured::Triangular(static_cast<size_t>(size)));
+}
+
+/**
+ * @brief Packs lower triangle of square matrix, upper one is not read
+ *
+ * @param other const Matrix& type
+ */
+template <arithmetic Type>
+SymmetricMatrix<Type>::SymmetricMatrix(const Matrix<Type>& other)
+    : SymmetricMatrix(other.rows()) {
+  structured::CheckSquare(other, "Creation symmetric matrix");
+  Type* target = values_.data();
+  for (int i = 0; i < size_; ++i) {
+    const Type* source = other.row(i).data();
+    target = std::copy(source, source + i + 1, target);
+  }
+}
+
+/**
+ * @brief Converts to dense matrix with both triangles filled
+ *
+ * @return Matrix
+ */
+template <arithmetic Type>
+Matrix<Type> SymmetricMatrix<Type>::ToMatrix() const {
+  Matrix<Type> returnable(size_, size_);
+  Type* target = returnable.data();
+  const size_t size = static_cast<size_t>(size_);
+  const Type* source = values_.data();
+  for (size_t i = 0; i < size; ++i) {
+    for (size_t j = 0; j <= i; ++j, ++source) {
+      target[i * size + j] = *source;
+      target[j * size + i] = *source;
+    }
+  }
+
+  return returnable;
+}
+
+template <arithmetic Type>
+int SymmetricMatrix<Type>::rows() const {
+  return size_;
+}
+
+template <arithmetic Type>
+int SymmetricMatrix<Type>::cols() const {
+  return size_;
+}
+
+/**
+ * @brief Returns amount of stored elements, n*(n+1)/2
+ *
+ * @return size_t
+ */
+template <arithmetic Type>
+size_t SymmetricMatrix<Type>::storage_size() const {
+  return values_.size();
+}
+
+template <arithmetic Type>
+Type* SymmetricMatrix<Type>::data() {
+  return values_.data();
+}
+
+template <arithmetic Type>
+const Type* SymmetricMatrix<Type>::data() const {
+  return values_.data();
+}
+
+/**
+ * @brief Symmetric by dense multiplication (SYMM). Rows of result are split
+ * between threads, each reads row of lower triangle and column of it below
+ * the diagonal, so no element is stored twice and no row is written twice
+ *
+ * @param other const Matrix& type
+ * @return Matrix
+ */
+template <arithmetic Type>
+Matrix<Type> SymmetricMatrix<Type>::operator*(const Matrix<Type>& other) const {
+  structured::CheckProduct(size_, other.rows());
+  Matrix<Type> returnable(size_, other.cols());
+  const Type* b = other.data();
+  Type* c = returnable.data();
+  const size_t cols = static_cast<size_t>(other.cols());
+
+  ForEachPart(size_, values_.size() * 2 * cols, [&](int first, int last) {
+    MultiplyRows(b, c, cols, first, last);
+  });
+
+  return returnable;
+}
+
+/**
+ * @brief Computes y = this * x (SPMV)
+ *
+ * @param x std::span<const Type> type
+ * @param y std::span<Type> type
+ */
+template <arithmetic Type>
+void SymmetricMatrix<Type>::Apply(std::span<const Type> x,
+                                  std::span<Type> y) const {
+  structured::CheckVectors(size_, x.size(), y.size());
+  ForEachPart(size_, values_.size() * 2, [&](int first, int last) {
+    MultiplyRows(x.data(), y.data(), 1, first, last);
+  });
+}
+
+template <arithmetic Type>
+void SymmetricMatrix<Type>::MultiplyRows(const Type* b, Type* c, size_t cols,
+                                         int first, int last) const {
+  const size_t size = static_cast<size_t>(size_);
+  for (size_t i = static_cast<size_t>(first); i < static_cast<size_t>(last);
+       ++i) {
+    Type* c_row = c + i * cols;
+    std::fill(c_row, c_row + cols, Type(0));
+    const Type* a_row = values_.data() + structured::Triangular(i);
+    for (size_t j = 0; j < size; ++j) {
+      const Type factor =
+          j <= i ? a_row[j] : values_[structured::Triangular(j) + i];
+      const Type* b_row = b + j * cols;
+      for (size_t col = 0; col < cols; ++col) {
+        c_row[col] += factor * b_row[col];
+      }
+    }
+  }
+}
+
+/**
+ * @brief Element access, (i, j) and (j, i) refer to one element. Index is
+ * checked in debug builds only
+ *
+ * @param i int type row index
+ * @param j int type column index
+ * @return Type&
+ */
+template <arithmetic Type>
+Type& SymmetricMatrix<Type>::operator()(int i, int j) {
+#ifndef NDEBUG
+  CheckIndex(i, j);
+#endif
+  return values_[Offset(i, j)];
+}
+
+template <arithmetic Type>
+Type SymmetricMatrix<Type>::operator()(int i, int j) const {
+#ifndef NDEBUG
+  CheckIndex(i, j);
+#endif
+  return values_[Offset(i, j)];
+}
+
+template <arithmetic Type>
+Type& SymmetricMatrix<Type>::at(int i, int j) {
+  CheckIndex(i, j);
+  return values_[Offset(i, j)];
+}
+
+template <arithmetic Type>
+Type SymmetricMatrix<Type>::at(int i, int j) const {
+  CheckIndex(i, j);
+  return values_[Offset(i, j)];
+}
+
+template <arithmetic Type>
+size_t SymmetricMatrix<Type>::Offset(int i, int j) const {
+  if (i < j) {
+    std::swap(i, j);
+  }
+  return structured::Triangular(static_cast<size_t>(i)) +
+         static_cast<size_t>(j);
+}
+
+template <arithmetic Type>
+void SymmetricMatrix<Type>::CheckIndex(int i, int j) const {
+  if (i < 0 || j < 0 || i >= size_ || j >= size_) {
+    throw out_of_range("Index that is out of matrix range");
+  }
+}
+
+/**
+ * @brief Construct a new empty TriangularMatrix object
+ *
+ */
+template <arithmetic Type>
+TriangularMatrix<Type>::TriangularMatrix() {}
+
+/**
+ * @brief Construct a new TriangularMatrix object filled with zeros
+ *
+ * @param size int type amount of rows and cols
+ * @param triangle Triangle type stored triangle
+ */
+template <arithmetic Type>
+TriangularMatrix<Type>::TriangularMatrix(int size, Triangle triangle)
+    : size_(size), triangle_(triangle) {
+  if (size < 1) {
+    throw invalid_argument("Creation matrix with less than 1x1 size");
+  }
+  values_.resize(structured::Triangular(static_cast<size_t>(size)));
+}
+
+/**
+ * @brief Packs "triangle" of square matrix, the other one is not read
+ *
+ * @param other const Matrix& type
+ * @param triangle Triangle type
+ */
+template <arithmetic Type>
+TriangularMatrix<Type>::TriangularMatrix(const Matrix<Type>& other,
+                                         Triangle triangle)
+    : TriangularMatrix(other.rows(), triangle) {
+  structured::CheckSquare(other, "Creation triangular matrix");
+  Type* target = values_.data();
+  for (int i = 0; i < size_; ++i) {
+    const Type* source = other.row(i).data();
+    target = std::copy(source + First(i), source + Last(i), target);
+  }
+}
+
+/**
+ * @brief Converts to dense matrix, the other triangle is zero
+ *
+ * @return Matrix
+ */
+template <arithmetic Type>
+Matrix<Type> TriangularMatrix<Type>::ToMatrix() const {
+  Matrix<Type> returnable(size_, size_);
+  for (int i = 0; i < size_; ++i) {
+    const Type* source = values_.data() + RowOffset(i);
+    std::copy(source, source + Last(i) - First(i),
+              returnable.data() +
+                  static_cast<size_t>(i) * static_cast<size_t>(size_) +
+                  First(i));
+  }
+
+  return returnable;
+}
+
+template <arithmetic Type>
+int TriangularMatrix<Type>::rows() const {
+  return size_;
+}
+
+template <arithmetic Type>
+int TriangularMatrix<Type>::cols() const {
+  return size_;
+}
+
+template <arithmetic Type>
+Triangle TriangularMatrix<Type>::triangle() const {
+  return triangle_;
+}
+
+/**
+ * @brief Returns amount of stored elements, n*(n+1)/2
+ *
+ * @return size_t
+ */
+template <arithmetic Type>
+size_t TriangularMatrix<Type>::storage_size() const {
+  return values_.size();
+}
+
+template <arithmetic Type>
+Type* TriangularMatrix<Type>::data() {
+  return values_.data();
+}
+
+template <arithmetic Type>
+const Type* TriangularMatrix<Type>::data() const {
+  return values_.data();
+}
+
+/**
+ * @brief Triangular by dense multiplication (TRMM), rows of result are
+ * split between threads
+ *
+ * @param other const Matrix& type
+ * @return Matrix
+ */
+template <arithmetic Type>
+Matrix<Type> TriangularMatrix<Type>::operator*(
+    const Matrix<Type>& other) const {
+  structured::CheckProduct(size_, other.rows());
+  Matrix<Type> returnable(size_, other.cols());
+  const Type* b = other.data();
+  Type* c = returnable.data();
+  const size_t cols = static_cast<size_t>(other.cols());
+
+  ForEachPart(size_, values_.size() * cols, [&](int first, int last) {
+    MultiplyRows(b, c, cols, first, last);
+  });
+
+  return returnable;
+}
+
+/**
+ * @brief Computes y = this * x (TPMV)
+ *
+ * @param x std::span<const Type> type
+ * @param y std::span<Type> type
+ */
+template <arithmetic Type>
+void TriangularMatrix<Type>::Apply(std::span<const Type> x,
+                                   std::span<Type> y) const {
+  structured::CheckVectors(size_, x.size(), y.size());
+  ForEachPart(size_, values_.size(), [&](int first, int last) {
+    MultiplyRows(x.data(), y.data(), 1, first, last);
+  });
+}
+
+/**
+ * @brief Solves this * x = b by forward (lower) or backward (upper)
+ * substitution (TRSM). Columns of "b" are independent systems, so they are
+ * split between threads
+ *
+ * @param b const Matrix& type right side, one column per system
+ * @return Matrix solution of "b" size
+ */
+template <arithmetic Type>
+Matrix<Type> TriangularMatrix<Type>::Solve(const Matrix<Type>& b) const
+  requires std::floating_point<Type>
+{
+  if (b.rows() != size_) {
+    throw invalid_argument("Solving system with different amount of rows");
+  }
+  for (int i = 0; i < size_; ++i) {
+    if (values_[RowOffset(i) + static_cast<size_t>(i - First(i))] == 0) {
+      throw invalid_argument("Solving system with singular matrix");
+    }
+  }
+  Matrix<Type> returnable(b);
+  Type* x = returnable.MutableData();
+  const size_t cols = static_cast<size_t>(b.cols());
+  const bool is_lower = triangle_ == Triangle::kLower;
+
+  auto substitute = [&](int first, int last) {
+    const size_t begin = static_cast<size_t>(first);
+    const size_t end = static_cast<size_t>(last);
+    for (int step = 0; step < size_; ++step) {
+      const int i = is_lower ? step : size_ - 1 - step;
+      const Type* a_row = values_.data() + RowOffset(i);
+      Type* x_row = x + static_cast<size_t>(i) * cols;
+      Type diagonal = 0;
+      for (int j = First(i); j < Last(i); ++j, ++a_row) {
+        if (j == i) {
+          diagonal = *a_row;
+          continue;
+        }
+        const Type* solved = x + static_cast<size_t>(j) * cols;
+        for (size_t col = begin; col < end; ++col) {
+          x_row[col] -= *a_row * solved[col];
+        }
+      }
+      for (size_t col = begin; col < end; ++col) {
+        x_row[col] /= diagonal;
+      }
+    }
+  };
+  ForEachPart(b.cols(), values_.size() * cols, substitute);
+
+  return returnable;
+}
+
+template <arithmetic Type>
+void TriangularMatrix<Type>::MultiplyRows(const Type* b, Type* c, size_t cols,
+                                          int first, int last) const {
+  for (int i = first; i < last; ++i) {
+    Type* c_row = c + static_cast<size_t>(i) * cols;
+    std::fill(c_row, c_row + cols, Type(0));
+    const Type* a_row = values_.data() + RowOffset(i);
+    for (int j = First(i); j < Last(i); ++j, ++a_row) {
+      const Type* b_row = b + static_cast<size_t>(j) * cols;
+      for (size_t col = 0; col < cols; ++col) {
+        c_row[col] += *a_row * b_row[col];
+      }
+    }
+  }
+}
+
+/**
+ * @brief Element access inside the triangle. Index is checked in debug
+ * builds only
+ *
+ * @param i int type row index
+ * @param j int type column index
+ * @return Type&
+ */
+template <arithmetic Type>
+Type& TriangularMatrix<Type>::operator()(int i, int j) {
+#ifndef NDEBUG
+  CheckIndex(i, j);
+#endif
+  return values_[RowOffset(i) + static_cast<size_t>(j - First(i))];
+}
+
+/**
+ * @brief Element access, zero outside the triangle. Index is checked in
+ * debug builds only
+ *
+ * @param i int type row index
+ * @param j int type column index
+ * @return Type
+ */
+template <arithmetic Type>
+Type TriangularMatrix<Type>::operator()(int i, int j) const {
+#ifndef NDEBUG
+  if (i < 0 || j < 0 || i >= size_ || j >= size_) {
+    throw out_of_range("Index that is out of matrix range");
+  }
+#endif
+  if (j < First(i) || j >= Last(i)) {
+    return 0;
+  }
+  return values_[RowOffset(i) + static_cast<size_t>(j - First(i))];
+}
+
+template <arithmetic Type>
+Type& TriangularMatrix<Type>::at(int i, int j) {
+  CheckIndex(i, j);
+  return values_[RowOffset(i) + static_cast<size_t>(j - First(i))];
+}
+
+template <arithmetic Type>
+Type TriangularMatrix<Type>::at(int i, int j) const {
+  if (i < 0 || j < 0 || i >= size_ || j >= size_) {
+    throw out_of_range("Index that is out of matrix range");
+  }
+  return (*this)(i, j);
+}
+
+template <arithmetic Type>
+int TriangularMatrix<Type>::First(int i) const {
+  return triangle_ == Triangle::kLower ? 0 : i;
+}
+
+template <arithmetic Type>
+int TriangularMatrix<Type>::Last(int i) const {
+  return triangle_ == Triangle::kLower ? i + 1 : size_;
+}
+
+/**
+ * @brief Returns position of the first stored element of row "i"
+ *
+ */
+template <arithmetic Type>
+size_t TriangularMatrix<Type>::RowOffset(int i) const {
+  const size_t row = static_cast<size_t>(i);
+  if (triangle_ == Triangle::kLower) {
+    return structured::Triangular(row);
+  }
+  return row * static_cast<size_t>(size_) - structured::Triangular(row) + row;
+}
+
+template <arithmetic Type>
+void TriangularMatrix<Type>::CheckIndex(int i, int j) const {
+  if (i < 0 || j < 0 || i >= size_ || j >= size_) {
+    throw out_of_range("Index that is out of matrix range");
+  }
+  if (j < First(i) || j >= Last(i)) {
+    throw out_of_range("Index that is out of matrix triangle");
+  }
+}
+
+/**
+ * @brief Construct a new empty BandMatrix object
+ *
+ */
+template <arithmetic Type>
+BandMatrix<Type>::BandMatrix() {}
+
+/**
+ * @brief Construct a new BandMatrix object filled with zeros. Bandwidths
+ * larger than size are reduced to size-1
+ *
+ * @param size int type amount of rows and cols
+ * @param lower int type amount of diagonals below the main one
+ * @param upper int type amount of diagonals above the main one
+ */
+template <arithmetic Type>
+BandMatrix<Type>::BandMatrix(int size, int lower, int upper) : size_(size) {
+  if (size < 1) {
+    throw invalid_argument("Creation matrix with less than 1x1 size");
+  }
+  if (lower < 0 || upper < 0) {
+    throw invalid_argument("Creation band matrix with negative bandwidth");
+  }
+  lower_ = std::min(lower, size - 1);
+  upper_ = std::min(upper, size - 1);
+  values_.resize(static_cast<size_t>(size) *
+                 static_cast<size_t>(lower_ + upper_ + 1));
+}
+
+/**
+ * @brief Packs band of square matrix, elements outside it are not read
+ *
+ * @param other const Matrix& type
+ * @param lower int type amount of diagonals below the main one
+ * @param upper int type amount of diagonals above the main one
+ */
+template <arithmetic Type>
+BandMatrix<Type>::BandMatrix(const Matrix<Type>& other, int lower, int upper)
+    : BandMatrix(other.rows(), lower, upper) {
+  structured::CheckSquare(other, "Creation band matrix");
+  for (int i = 0; i < size_; ++i) {
+    const Type* source = other.row(i).data();
+    std::copy(source + First(i), source + Last(i),
+              values_.data() + Offset(i, First(i)));
+  }
+}
+
+/**
+ * @brief Converts to dense matrix, elements outside the band are zero
+ *
+ * @return Matrix
+ */
+template <arithmetic Type>
+Matrix<Type> BandMatrix<Type>::ToMatrix() const {
+  Matrix<Type> returnable(size_, size_);
+  for (int i = 0; i < size_; ++i) {
+    const Type* source = values_.data() + Offset(i, First(i));
+    std::copy(source, source + Last(i) - First(i),
+              returnable.data() +
+                  static_cast<size_t>(i) * static_cast<size_t>(size_) +
+                  First(i));
+  }
+
+  return returnable;
+}
+
+template <arithmetic Type>
+int BandMatrix<Type>::rows() const {
+  return size_;
+}
+
+template <arithmetic Type>
+int BandMatrix<Type>::cols() const {
+  return size_;
+}
+
+template <arithmetic Type>
+int BandMatrix<Type>::lower() const {
+  return lower_;
+}
+
+template <arithmetic Type>
+int BandMatrix<Type>::upper() const {
+  return upper_;
+}
+
+/**
+ * @brief Returns amount of stored elements, n*(lower+upper+1) including
+ * unused corners of the band
+ *
+ * @return size_t
+ */
+template <arithmetic Type>
+size_t BandMatrix<Type>::storage_size() const {
+  return values_.size();
+}
+
+template <arithmetic Type>
+Type* BandMatrix<Type>::data() {
+  return values_.data();
+}
+
+template <arithmetic Type>
+const Type* BandMatrix<Type>::data() const {
+  return values_.data();
+}
+
+/**
+ * @brief Band by dense multiplication in O(n*bandwidth) per column, rows of
+ * result are split between threads
+ *
+ * @param other const Matrix& type
+ * @return Matrix
+ */
+template <arithmetic Type>
+Matrix<Type> BandMatrix<Type>::operator*(const Matrix<Type>& other) const {
+  structured::CheckProduct(size_, other.rows());
+  Matrix<Type> returnable(size_, other.cols());
+  const Type* b = other.data();
+  Type* c = returnable.data();
+  const size_t cols = static_cast<size_t>(other.cols());
+
+  ForEachPart(size_, values_.size() * cols, [&](int first, int last) {
+    MultiplyRows(b, c, cols, first, last);
+  });
+
+  return returnable;
+}
+
+/**
+ * @brief Computes y = this * x (banded GEMV)
+ *
+ * @param x std::span<const Type> type
+ * @param y std::span<Type> type
+ */
+template <arithmetic Type>
+void BandMatrix<Type>::Apply(std::span<const Type> x,
+                             std::span<Type> y) const {
+  structured::CheckVectors(size_, x.size(), y.size());
+  ForEachPart(size_, values_.size(), [&](int first, int last) {
+    MultiplyRows(x.data(), y.data(), 1, first, last);
+  });
+}
+
+template <arithmetic Type>
+void BandMatrix<Type>::MultiplyRows(const Type* b, Type* c, size_t cols,
+                                    int first, int last) const {
+  for (int i = first; i < last; ++i) {
+    Type* c_row = c + static_cast<size_t>(i) * cols;
+    std::fill(c_row, c_row + cols, Type(0));
+    const Type* a_row = values_.data() + Offset(i, First(i));
+    for (int j = First(i); j < Last(i); ++j, ++a_row) {
+      const Type* b_row = b + static_cast<size_t>(j) * cols;
+      for (size_t col = 0; col < cols; ++col) {
+        c_row[col] += *a_row * b_row[col];
+      }
+    }
+  }
+}
+
+/**
+ * @brief Element access inside the band. Index is checked in debug builds
+ * only
+ *
+ * @param i int type row index
+ * @param j int type column index
+ * @return Type&
+ */
+template <arithmetic Type>
+Type& BandMatrix<Type>::operator()(int i, int j) {
+#ifndef NDEBUG
+  CheckIndex(i, j);
+#endif
+  return values_[Offset(i, j)];
+}
+
+/**
+ * @brief Element access, zero outside the band. Index is checked in debug
+ * builds only
+ *
+ * @param i int type row index
+ * @param j int type column index
+ * @return Type
+ */
+template <arithmetic Type>
+Type BandMatrix<Type>::operator()(int i, int j) const {
+#ifndef NDEBUG
+  if (i < 0 || j < 0 || i >= size_ || j >= size_) {
+    throw out_of_range("Index that is out of matrix range");
+  }
+#endif
+  if (j < First(i) || j >= Last(i)) {
+    return 0;
+  }
+  return values_[Offset(i, j)];
+}
+
+template <arithmetic Type>
+Type& BandMatrix<Type>::at(int i, int j) {
+  CheckIndex(i, j);
+  return values_[Offset(i, j)];
+}
+
+template <arithmetic Type>
+Type BandMatrix<Type>::at(int i, int j) const {
+  if (i < 0 || j < 0 || i >= size_ || j >= size_) {
+    throw out_of_range("Index that is out of matrix range");
+  }
+  return (*this)(i, j);
+}
+
+template <arithmetic Type>
+int BandMatrix<Type>::First(int i) const {
+  return std::max(0, i - lower_);
+}
+
+template <arithmetic Type>
+int BandMatrix<Type>::Last(int i) const {
+  return std::min(size_, i + upper_ + 1);
+}
+
+template <arithmetic Type>
+size_t BandMatrix<Type>::Offset(int i, int j) const {
+  return static_cast<size_t>(i) * static_cast<size_t>(lower_ + upper_ + 1) +
+         static_cast<size_t>(j - i + lower_);
+}
+
+template <arithmetic Type>
+void BandMatrix<Type>::CheckIndex(int i, int j) const {
+  if (i < 0 || j < 0 || i >= size_ || j >= size_) {
+    throw out_of_range("Index that is out of matrix range");
+  }
+  if (j < First(i) || j >= Last(i)) {
+    throw out_of_range("Index that is out of matrix band");
+  }
+}
+
+}  // namespace hhullen
@@ -0,0 +1,150 @@
+#ifndef SRC_STRUCTURED_MATRIX_H_
+#define SRC_STRUCTURED_MATRIX_H_
+
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "matrix.h"
+
+namespace hhullen {
+
+enum class Triangle { kLower, kUpper };
+
+/**
+ * @brief Square symmetric matrix. Lower triangle is packed by rows, so it
+ * takes n*(n+1)/2 elements; element (i, j) and (j, i) are the same element
+ *
+ */
+template <arithmetic Type>
+class SymmetricMatrix {
+ public:
+  using value_type = Type;
+
+  SymmetricMatrix();
+  explicit SymmetricMatrix(int size);
+  explicit SymmetricMatrix(const Matrix<Type>& other);
+
+  Matrix<Type> ToMatrix() const;
+
+  int rows() const;
+  int cols() const;
+  size_t storage_size() const;
+  Type* data();
+  const Type* data() const;
+
+  Matrix<Type> operator*(const Matrix<Type>& other) const;
+  void Apply(std::span<const Type> x, std::span<Type> y) const;
+
+  Type& operator()(int i, int j);
+  Type operator()(int i, int j) const;
+  Type& at(int i, int j);
+  Type at(int i, int j) const;
+
+ private:
+  int size_ = 0;
+  std::vector<Type> values_;
+
+  size_t Offset(int i, int j) const;
+  void CheckIndex(int i, int j) const;
+  void MultiplyRows(const Type* b, Type* c, size_t cols, int first,
+                    int last) const;
+};
+
+/**
+ * @brief Square lower or upper triangular matrix packed by rows, it takes
+ * n*(n+1)/2 elements. Elements outside the triangle are zero and can not be
+ * set
+ *
+ */
+template <arithmetic Type>
+class TriangularMatrix {
+ public:
+  using value_type = Type;
+
+  TriangularMatrix();
+  TriangularMatrix(int size, Triangle triangle);
+  TriangularMatrix(const Matrix<Type>& other, Triangle triangle);
+
+  Matrix<Type> ToMatrix() const;
+
+  int rows() const;
+  int cols() const;
+  Triangle triangle() const;
+  size_t storage_size() const;
+  Type* data();
+  const Type* data() const;
+
+  Matrix<Type> operator*(const Matrix<Type>& other) const;
+  void Apply(std::span<const Type> x, std::span<Type> y) const;
+  Matrix<Type> Solve(const Matrix<Type>& b) const
+    requires std::floating_point<Type>;
+
+  Type& operator()(int i, int j);
+  Type operator()(int i, int j) const;
+  Type& at(int i, int j);
+  Type at(int i, int j) const;
+
+ private:
+  int size_ = 0;
+  Triangle triangle_ = Triangle::kLower;
+  std::vector<Type> values_;
+
+  int First(int i) const;
+  int Last(int i) const;
+  size_t RowOffset(int i) const;
+  void CheckIndex(int i, int j) const;
+  void MultiplyRows(const Type* b, Type* c, size_t cols, int first,
+                    int last) const;
+};
+
+/**
+ * @brief Square band matrix with "lower" diagonals below and "upper"
+ * diagonals above the main one. Each row stores lower+upper+1 elements, so
+ * products take O(n*bandwidth) instead of O(n^2) per column. Elements
+ * outside the band are zero and can not be set
+ *
+ */
+template <arithmetic Type>
+class BandMatrix {
+ public:
+  using value_type = Type;
+
+  BandMatrix();
+  BandMatrix(int size, int lower, int upper);
+  BandMatrix(const Matrix<Type>& other, int lower, int upper);
+
+  Matrix<Type> ToMatrix() const;
+
+  int rows() const;
+  int cols() const;
+  int lower() const;
+  int upper() const;
+  size_t storage_size() const;
+  Type* data();
+  const Type* data() const;
+
+  Matrix<Type> operator*(const Matrix<Type>& other) const;
+  void Apply(std::span<const Type> x, std::span<Type> y) const;
+
+  Type& operator()(int i, int j);
+  Type operator()(int i, int j) const;
+  Type& at(int i, int j);
+  Type at(int i, int j) const;
+
+ private:
+  int size_ = 0, lower_ = 0, upper_ = 0;
+  std::vector<Type> values_;
+
+  int First(int i) const;
+  int Last(int i) const;
+  size_t Offset(int i, int j) const;
+  void CheckIndex(int i, int j) const;
+  void MultiplyRows(const Type* b, Type* c, size_t cols, int first,
+                    int last) const;
+};
+
+}  // namespace hhullen
+
+#endif  // SRC_STRUCTURED_MATRIX_H_
@@ -0,0 +1,270 @@
+#ifndef SRC_TUNING_H_
+#define SRC_TUNING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#ifdef __APPLE__
+#include <sys/sysctl.h>
+#endif
+
+namespace hhullen {
+
+/**
+ * @brief Shape classes of m*n Gemm result tuned separately: tall if m is at
+ * least TuningParameters::kShapeRatio times n, wide if n is at least that
+ * times m, square otherwise
+ *
+ */
+enum class GemmShape { kSquare, kTall, kWide };
+
+/**
+ * @brief Parameters of native kernels: cache block of Gemm over k and n,
+ * square tile of Transpose, amount of threads (0 for all hardware threads)
+ * and the smallest m*n*k of Gemm split between threads. Gemm block and
+ * threshold are kept for each GemmShape, gemm_block and parallel_elements
+ * are the square ones
+ *
+ */
+struct TuningParameters {
+  static constexpr size_t kShapeRatio = 4;
+
+  int gemm_block = 256;
+  int transpose_tile = 32;
+  int threads = 0;
+  size_t parallel_elements = 1 << 16;
+  int tall_gemm_block = 256;
+  size_t tall_parallel_elements = 1 << 16;
+  int wide_gemm_block = 256;
+  size_t wide_parallel_elements = 1 << 16;
+
+  static GemmShape Shape(size_t m, size_t n) {
+    if (m >= kShapeRatio * n) {
+      return GemmShape::kTall;
+    }
+    return n >= kShapeRatio * m ? GemmShape::kWide : GemmShape::kSquare;
+  }
+  int& GemmBlock(GemmShape shape) {
+    return shape == GemmShape::kTall   ? tall_gemm_block
+           : shape == GemmShape::kWide ? wide_gemm_block
+                                       : gemm_block;
+  }
+  int GemmBlock(GemmShape shape) const {
+    return shape == GemmShape::kTall   ? tall_gemm_block
+           : shape == GemmShape::kWide ? wide_gemm_block
+                                       : gemm_block;
+  }
+  size_t& ParallelElements(GemmShape shape) {
+    return shape == GemmShape::kTall   ? tall_parallel_elements
+           : shape == GemmShape::kWide ? wide_parallel_elements
+                                       : parallel_elements;
+  }
+  size_t ParallelElements(GemmShape shape) const {
+    return shape == GemmShape::kTall   ? tall_parallel_elements
+           : shape == GemmShape::kWide ? wide_parallel_elements
+                                       : parallel_elements;
+  }
+
+  bool operator==(const TuningParameters& other) const = default;
+};
+
+/**
+ * @brief Tuning parameters shared by all threads. Fields are atomic, so
+ * parameters may be replaced while kernels run, each kernel call reads them
+ * once
+ *
+ */
+class TuningState {
+ public:
+  explicit TuningState(const TuningParameters& parameters) {
+    Store(parameters);
+  }
+
+  TuningParameters Load() const {
+    return {gemm_block_.load(std::memory_order_relaxed),
+            transpose_tile_.load(std::memory_order_relaxed),
+            threads_.load(std::memory_order_relaxed),
+            parallel_elements_.load(std::memory_order_relaxed),
+            tall_gemm_block_.load(std::memory_order_relaxed),
+            tall_parallel_elements_.load(std::memory_order_relaxed),
+            wide_gemm_block_.load(std::memory_order_relaxed),
+            wide_parallel_elements_.load(std::memory_order_relaxed)};
+  }
+  void Store(const TuningParameters& parameters) {
+    gemm_block_.store(parameters.gemm_block, std::memory_order_relaxed);
+    transpose_tile_.store(parameters.transpose_tile,
+                          std::memory_order_relaxed);
+    threads_.store(parameters.threads, std::memory_order_relaxed);
+    parallel_elements_.store(parameters.parallel_elements,
+                             std::memory_order_relaxed);
+    tall_gemm_block_.store(parameters.tall_gemm_block,
+                           std::memory_order_relaxed);
+    tall_parallel_elements_.store(parameters.tall_parallel_elements,
+                                  std::memory_order_relaxed);
+    wide_gemm_block_.store(parameters.wide_gemm_block,
+                           std::memory_order_relaxed);
+    wide_parallel_elements_.store(parameters.wide_parallel_elements,
+                                  std::memory_order_relaxed);
+  }
+
+ private:
+  std::atomic<int> gemm_block_, transpose_tile_, threads_, tall_gemm_block_,
+      wide_gemm_block_;
+  std::atomic<size_t> parallel_elements_, tall_parallel_elements_,
+      wide_parallel_elements_;
+};
+
+/**
+ * @brief Returns processor model name, "unknown" if it is not available
+ *
+ * @return std::string
+ */
+inline std::string CpuModel() {
+#ifdef __APPLE__
+  char name[256] = {0};
+  size_t size = sizeof(name);
+  if (sysctlbyname("machdep.cpu.brand_string", name, &size, nullptr, 0) == 0) {
+    return name;
+  }
+#else
+  std::ifstream cpuinfo("/proc/cpuinfo");
+  std::string line;
+  while (getline(cpuinfo, line)) {
+    if (line.rfind("model name", 0) == 0 && line.find(':') != line.npos) {
+      return line.substr(line.find_first_not_of(" \t", line.find(':') + 1));
+    }
+  }
+#endif
+  return "unknown";
+}
+
+/**
+ * @brief Returns key of tuning cache entry: processor model and element
+ * type, e.g. "Intel(R) Xeon(R) ...|float64"
+ *
+ */
+template <class Type>
+std::string TuningKey() {
+  std::string type = std::is_floating_point_v<Type> ? "float"
+                     : std::is_signed_v<Type>       ? "int"
+                                                    : "uint";
+  return CpuModel() + "|" + type + std::to_string(sizeof(Type) * 8);
+}
+
+/**
+ * @brief Returns path of tuning cache: MATRIX_TUNING_CACHE environment
+ * variable (empty value disables the cache), otherwise matrix_tuning.txt in
+ * XDG_CACHE_HOME or ~/.cache
+ *
+ * @return std::string empty if cache is disabled or home is unknown
+ */
+inline std::string TuningCachePath() {
+  if (const char* path = std::getenv("MATRIX_TUNING_CACHE")) {
+    return path;
+  }
+  if (const char* cache = std::getenv("XDG_CACHE_HOME")) {
+    return std::string(cache) + "/matrix_tuning.txt";
+  }
+  if (const char* home = std::getenv("HOME")) {
+    return std::string(home) + "/.cache/matrix_tuning.txt";
+  }
+  return std::string();
+}
+
+/**
+ * @brief Reads entry of tuning cache. Lines are "key<TAB>gemm_block
+ * transpose_tile threads parallel_elements tall_gemm_block
+ * tall_parallel_elements wide_gemm_block wide_parallel_elements", entries
+ * without tall and wide values use the square ones for them
+ *
+ * @return true if entry for "key" exists and is valid
+ */
+inline bool LoadTuning(const std::string& path, const std::string& key,
+                       TuningParameters* parameters) {
+  std::ifstream file(path);
+  std::string line;
+  while (getline(file, line)) {
+    const size_t tab = line.rfind('\t');
+    if (tab == line.npos || line.compare(0, tab, key) != 0 ||
+        tab != key.size()) {
+      continue;
+    }
+    TuningParameters read;
+    std::istringstream values(line.substr(tab + 1));
+    if (!(values >> read.gemm_block >> read.transpose_tile >> read.threads >>
+          read.parallel_elements)) {
+      continue;
+    }
+    if (!(values >> read.tall_gemm_block >> read.tall_parallel_elements >>
+          read.wide_gemm_block >> read.wide_parallel_elements)) {
+      read.tall_gemm_block = read.wide_gemm_block = read.gemm_block;
+      read.tall_parallel_elements = read.wide_parallel_elements =
+          read.parallel_elements;
+    }
+    if (read.gemm_block > 0 && read.tall_gemm_block > 0 &&
+        read.wide_gemm_block > 0 && read.transpose_tile > 0 &&
+        read.threads >= 0) {
+      *parameters = read;
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * @brief Adds or replaces entry of tuning cache. File is written aside and
+ * renamed, so concurrent readers see either old or new cache
+ *
+ * @return true if cache is written
+ */
+inline bool StoreTuning(const std::string& path, const std::string& key,
+                        const TuningParameters& parameters) {
+  if (path.empty()) {
+    return false;
+  }
+  std::vector<std::string> lines;
+  {
+    std::ifstream file(path);
+    std::string line;
+    while (getline(file, line)) {
+      if (line.rfind(key + "\t", 0) != 0 && !line.empty()) {
+        lines.push_back(line);
+      }
+    }
+  }
+  lines.push_back(key + "\t" + std::to_string(parameters.gemm_block) + " " +
+                  std::to_string(parameters.transpose_tile) + " " +
+                  std::to_string(parameters.threads) + " " +
+                  std::to_string(parameters.parallel_elements) + " " +
+                  std::to_string(parameters.tall_gemm_block) + " " +
+                  std::to_string(parameters.tall_parallel_elements) + " " +
+                  std::to_string(parameters.wide_gemm_block) + " " +
+                  std::to_string(parameters.wide_parallel_elements));
+
+  std::error_code error;
+  std::filesystem::create_directories(
+      std::filesystem::path(path).parent_path(), error);
+  const std::string temporary = path + ".tmp";
+  {
+    std::ofstream file(temporary, std::ios::trunc);
+    for (const std::string& line : lines) {
+      file << line << '\n';
+    }
+    if (!file) {
+      return false;
+    }
+  }
+  return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+}  // namespace hhullen
+
+#endif  // SRC_TUNING_H_